@@ -0,0 +1,191 @@
+/**
+* @file  AABB.h
+* @brief sE{bNX(AABB)
+*/
+
+#pragma once
+
+#include "Ray.h"
+
+/** sE{bNXNX */
+class AABB {
+public:
+    /**
+    * @brief ̋E{bNX
+    */
+    AABB() : pmin(inf, inf, inf), pmax(-inf, -inf, -inf) {};
+
+    /**
+    * @brief 2_܂ދE{bNX
+    * @param[in] p0 :_1
+    * @param[in] p1 :_2
+    */
+    AABB(const Vec3& p0, const Vec3& p1) : pmin(min(p0, p1)), pmax(max(p0, p1)) {};
+
+    Vec3 get_min() const { return pmin; }
+    Vec3 get_max() const { return pmax; }
+
+    /**
+    * @brief E{bNX󂩔
+    * @return bool :Ȃtrue
+    */
+    bool is_empty() const {
+        return pmin[0] > pmax[0] || pmin[1] > pmax[1] || pmin[2] > pmax[2];
+    }
+
+    /**
+    * @brief E{bNX̒SWvZ֐
+    * @return Vec3 :SW
+    */
+    Vec3 get_centroid() const { return 0.5f * (pmin + pmax); }
+
+    /**
+    * @brief E{bNX̑ΊpxNgvZ֐
+    * @return Vec3 :ΊpxNg
+    */
+    Vec3 get_diagonal() const { return is_empty() ? Vec3::zero : pmax - pmin; }
+
+    /**
+    * @brief E{bNX̕\ʐςvZ֐
+    * @return float :\ʐ
+    */
+    float surface_area() const {
+        auto d = get_diagonal();
+        return 2 * (d[0] * d[1] + d[1] * d[2] + d[2] * d[0]);
+    }
+
+    /**
+    * @brief E{bNX̍ł擾֐
+    * @return int :̃CfbNX(x:0, y:1, z:2)
+    */
+    int max_extent() const {
+        auto d = get_diagonal();
+        if (d[0] > d[1] && d[0] > d[2]) return 0;
+        return d[1] > d[2] ? 1 : 2;
+    }
+
+    /**
+    * @brief E{bNX̓_̑΍WvZ֐
+    * @param[in] p :_
+    * @return Vec3 :΍W(pmin0, pmax1)
+    */
+    Vec3 offset(const Vec3& p) const {
+        auto o = p - pmin;
+        for (int i = 0; i < 3; i++) {
+            if (pmax[i] > pmin[i]) o[i] /= pmax[i] - pmin[i];
+        }
+        return o;
+    }
+
+    /**
+    * @brief _܂ނ悤ɋE{bNXg֐
+    * @param[in] p :_
+    */
+    void expand(const Vec3& p) {
+        pmin = min(pmin, p);
+        pmax = max(pmax, p);
+    }
+
+    /**
+    * @brief E{bNX܂ނ悤ɋE{bNXg֐
+    * @param[in] b :E{bNX
+    */
+    void expand(const AABB& b) {
+        pmin = min(pmin, b.pmin);
+        pmax = max(pmax, b.pmax);
+    }
+
+    /**
+    * @brief CƋE{bNX̌s֐(Xu@)
+    * @param[in] o       :Č_
+    * @param[in] inv_dir :C̕xNg̋t
+    * @param[in] t_min   :C̃p[^
+    * @param[in] t_max   :C̃p[^
+    * @return bool       :̌
+    * @note t̓go[T̑OɈxvZ
+    */
+    bool is_intersect(const Vec3& o, const Vec3& inv_dir, float t_min, float t_max) const {
+        for (int i = 0; i < 3; i++) {
+            float t0 = (pmin[i] - o[i]) * inv_dir[i];
+            float t1 = (pmax[i] - o[i]) * inv_dir[i];
+            if (inv_dir[i] < 0) std::swap(t0, t1);
+            t1 *= 1.0f + 4 * epsilon; // ۂߌ덷ɂ肱ڂh
+            // NaN(0 * inf)̏ꍇ͔rUɂȂԂ͍XVȂ
+            t_min = t0 > t_min ? t0 : t_min;
+            t_max = t1 < t_max ? t1 : t_max;
+            if (t_min > t_max) return false;
+        }
+        return true;
+    }
+
+private:
+    Vec3 pmin; /**< ŏW */
+    Vec3 pmax; /**< őW */
+};
+
+/**
+* @brief 2̋E{bNX܂ދE{bNXvZ֐
+* @param[in] a :E{bNX1
+* @param[in] b :E{bNX2
+* @return AABB :2܂ދE{bNX
+*/
+inline AABB merge(const AABB& a, const AABB& b) {
+    AABB ret = a;
+    ret.expand(b);
+    return ret;
+}
+
+
+/** ̏W͂މ~ */
+struct DirectionCone {
+    Vec3 w;               /**< ~̎(PʃxNg)          */
+    float cos_theta=inf;  /**< p̗](infȂ̉~)  */
+
+    /**
+    * @brief ̉~
+    */
+    DirectionCone() {};
+
+    /**
+    * @brief Ɣp̗]~
+    * @param[in] _w         :~̎
+    * @param[in] _cos_theta :p̗](1Ȃ玲̂)
+    */
+    DirectionCone(const Vec3& _w, float _cos_theta=1.0f) : w(unit_vector(_w)), cos_theta(_cos_theta) {};
+
+    bool is_empty() const { return cos_theta == inf; }
+
+    /**
+    * @brief S܂މ~擾
+    * @return DirectionCone :S܂މ~
+    */
+    static DirectionCone entire_sphere() { return DirectionCone(Vec3(0.f, 0.f, 1.0f), -1.0f); }
+};
+
+/**
+* @brief 2̉~܂މ~vZ֐
+* @param[in] a :~1
+* @param[in] b :~2
+* @return DirectionCone :2܂މ~
+* @note Ql: https://pbr-book.org/4ed/Geometry_and_Transformations/Spherical_Geometry
+*/
+inline DirectionCone merge(const DirectionCone& a, const DirectionCone& b) {
+    if (a.is_empty()) return b;
+    if (b.is_empty()) return a;
+    // ܂ޏꍇ
+    float theta_a = std::acos(std::clamp(a.cos_theta, -1.0f, 1.0f));
+    float theta_b = std::acos(std::clamp(b.cos_theta, -1.0f, 1.0f));
+    float theta_d = std::acos(std::clamp(dot(a.w, b.w), -1.0f, 1.0f));
+    if (std::min(theta_d + theta_b, pi) <= theta_a) return a;
+    if (std::min(theta_d + theta_a, pi) <= theta_b) return b;
+    // ܂މ~̔pƎvZ
+    float theta_o = 0.5f * (theta_a + theta_d + theta_b);
+    if (theta_o >= pi) return DirectionCone::entire_sphere();
+    Vec3 axis = cross(a.w, b.w);
+    if (axis.length2() == 0) return DirectionCone::entire_sphere();
+    // a̎a,b܂ޕʓtheta_o-theta_ab։](hQX̉])
+    axis = unit_vector(axis);
+    float theta_r = theta_o - theta_a;
+    Vec3 w = a.w * std::cos(theta_r) + cross(axis, a.w) * std::sin(theta_r);
+    return DirectionCone(w, std::cos(theta_o));
+}
@@ -0,0 +1,191 @@
+#include "BVH.h"
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+
+// go[T̃X^bN(64)𒴂Ȃ悤ɁC̐[ȍ~͌œ
+constexpr int MAX_UNBALANCED_DEPTH = 32;
+// SAH̃r
+constexpr int SAH_BINS = 16;
+// SAH̐߂̃go[TRXg(v~eBuƂ̌RXg1Ƃ)
+constexpr float SAH_TRAVERSAL_COST = 0.125f;
+
+
+std::ostream& operator<<(std::ostream& s, const BVHStats& stats) {
+    float avg_leaf_prims = stats.num_leaves > 0 ? (float)stats.num_prims / stats.num_leaves : 0.f;
+    return s << "BVH: " << stats.num_prims << " prims, "
+             << stats.num_nodes << " nodes, "
+             << stats.num_leaves << " leaves "
+             << "(avg " << avg_leaf_prims << " / max " << stats.max_leaf_prims << " prims), "
+             << "depth " << stats.max_depth << ", "
+             << "SAH cost " << stats.sah_cost << ", "
+             << stats.build_time_ms << "ms";
+}
+
+
+BVH::BVH(const std::vector<AABB>& prim_bounds, int _max_leaf_size, BVHSplit _split)
+    : max_leaf_size(std::clamp(_max_leaf_size, 1, 255)), split(_split)
+{
+    auto start_time = std::chrono::system_clock::now(); // vJn
+    int n = (int)prim_bounds.size();
+    if (n == 0) {
+        return;
+    }
+    // v~eBu̒SWvZ
+    std::vector<Vec3> centroids(n);
+    for (int i = 0; i < n; i++) {
+        centroids[i] = prim_bounds[i].get_centroid();
+    }
+    prim_indices.resize(n);
+    std::iota(prim_indices.begin(), prim_indices.end(), 0);
+    nodes.reserve(2 * n);
+    build(prim_bounds, centroids, 0, n, 0);
+
+    // \zv
+    stats.num_prims = n;
+    stats.num_nodes = (int)nodes.size();
+    float root_area = nodes[0].bounds.surface_area();
+    for (const auto& node : nodes) {
+        float area_ratio = root_area > 0 ? node.bounds.surface_area() / root_area : 1.0f;
+        if (node.nprims > 0) {
+            stats.sah_cost += area_ratio * node.nprims;
+        }
+        else {
+            stats.sah_cost += area_ratio * SAH_TRAVERSAL_COST;
+        }
+    }
+    auto end_time = std::chrono::system_clock::now(); // vI
+    stats.build_time_ms = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+}
+
+int BVH::build(const std::vector<AABB>& prim_bounds, const std::vector<Vec3>& centroids,
+    int begin, int end, int depth) {
+    int node_index = (int)nodes.size();
+    nodes.push_back(BVHNode());
+    stats.max_depth = std::max(stats.max_depth, depth);
+    // m[h̋E{bNXƒSW̋E{bNXvZ
+    AABB bounds, centroid_bounds;
+    for (int i = begin; i < end; i++) {
+        bounds.expand(prim_bounds[prim_indices[i]]);
+        centroid_bounds.expand(centroids[prim_indices[i]]);
+    }
+    nodes[node_index].bounds = bounds;
+    int n = end - begin;
+    int axis = centroid_bounds.max_extent();
+    float extent = centroid_bounds.get_max()[axis] - centroid_bounds.get_min()[axis];
+    // t𐶐郉_
+    auto make_leaf = [&]() {
+        nodes[node_index].offset = begin;
+        nodes[node_index].nprims = (uint16_t)n;
+        stats.num_leaves++;
+        stats.max_leaf_prims = std::max(stats.max_leaf_prims, n);
+        return node_index;
+    };
+    // v~eBuȂSWvꍇ͗t𐶐
+    if (n == 1 || (n <= 255 && extent <= 0.f)) {
+        return make_leaf();
+    }
+    int mid = begin;
+    if (extent > 0.f && depth < MAX_UNBALANCED_DEPTH) {
+        // \ʐσq[XeBbNŕ
+        if (split == BVHSplit::SAH) {
+            if (!split_sah(prim_bounds, centroids, begin, end, bounds, centroid_bounds, mid, axis)) {
+                return make_leaf();
+            }
+        }
+        // Œ̒_ŕ
+        else {
+            if (n <= max_leaf_size) {
+                return make_leaf();
+            }
+            float pmid = centroid_bounds.get_centroid()[axis];
+            auto iter = std::partition(prim_indices.begin() + begin, prim_indices.begin() + end,
+                [&](int i) { return centroids[i][axis] < pmid; });
+            mid = (int)std::distance(prim_indices.begin(), iter);
+        }
+    }
+    else if (n <= max_leaf_size) {
+        return make_leaf();
+    }
+    // ΂ꍇ͌œ
+    if (mid == begin || mid == end) {
+        mid = (begin + end) / 2;
+        std::nth_element(prim_indices.begin() + begin, prim_indices.begin() + mid,
+            prim_indices.begin() + end,
+            [&](int a, int b) { return centroids[a][axis] < centroids[b][axis]; });
+    }
+    // qm[h[D揇ō\z(1Ԗڂ̎q͒ɔzu)
+    build(prim_bounds, centroids, begin, mid, depth + 1);
+    int second = build(prim_bounds, centroids, mid, end, depth + 1);
+    nodes[node_index].offset = second;
+    nodes[node_index].axis = (uint8_t)axis;
+    return node_index;
+}
+
+bool BVH::split_sah(const std::vector<AABB>& prim_bounds, const std::vector<Vec3>& centroids,
+    int begin, int end, const AABB& bounds, const AABB& centroid_bounds, int& mid, int& axis) {
+    // eɂăv~eBurɐU蕪Cr̋Eł̃RXg]
+    int n = end - begin;
+    float min_cost = inf;
+    int min_axis = -1, min_bin = -1;
+    for (int a = 0; a < 3; a++) {
+        float cmin = centroid_bounds.get_min()[a];
+        float cmax = centroid_bounds.get_max()[a];
+        if (cmax <= cmin) continue;
+        float scale = SAH_BINS / (cmax - cmin);
+        int counts[SAH_BINS] = { 0 };
+        AABB bin_bounds[SAH_BINS];
+        for (int i = begin; i < end; i++) {
+            int p = prim_indices[i];
+            int b = std::min((int)((centroids[p][a] - cmin) * scale), SAH_BINS - 1);
+            counts[b]++;
+            bin_bounds[b].expand(prim_bounds[p]);
+        }
+        // E̗ݐςŊẽRXgvZ
+        float area_right[SAH_BINS];
+        int count_right[SAH_BINS];
+        AABB acc;
+        int count = 0;
+        for (int b = SAH_BINS - 1; b > 0; b--) {
+            acc.expand(bin_bounds[b]);
+            count += counts[b];
+            area_right[b] = acc.surface_area();
+            count_right[b] = count;
+        }
+        acc = AABB();
+        count = 0;
+        for (int b = 0; b < SAH_BINS - 1; b++) {
+            acc.expand(bin_bounds[b]);
+            count += counts[b];
+            if (count == 0 || count_right[b + 1] == 0) continue;
+            float cost = count * acc.surface_area() + count_right[b + 1] * area_right[b + 1];
+            if (cost < min_cost) {
+                min_cost = cost;
+                min_axis = a;
+                min_bin = b;
+            }
+        }
+    }
+    if (min_axis < 0) {
+        // SĂ̎ŕłȂꍇ͌œ
+        mid = begin;
+        return n > max_leaf_size || n > 255;
+    }
+    // tɂꍇ̃RXgƔr
+    float area = bounds.surface_area();
+    float split_cost = SAH_TRAVERSAL_COST + (area > 0 ? min_cost / area : 0.f);
+    if (n <= max_leaf_size && (float)n <= split_cost) {
+        return false;
+    }
+    // ŏRXg̃rEŃv~eBu𕪊
+    axis = min_axis;
+    float cmin = centroid_bounds.get_min()[axis];
+    float scale = SAH_BINS / (centroid_bounds.get_max()[axis] - cmin);
+    auto iter = std::partition(prim_indices.begin() + begin, prim_indices.begin() + end,
+        [&](int i) {
+            int b = std::min((int)((centroids[i][axis] - cmin) * scale), SAH_BINS - 1);
+            return b <= min_bin;
+        });
+    mid = (int)std::distance(prim_indices.begin(), iter);
+    return true;
+}
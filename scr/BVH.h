@@ -0,0 +1,246 @@
+/**
+* @file  BVH.h
+* @brief E{[Kw(BVH)
+* @note  v~eBűE{bNX݂̂\zC͌Ăяo̊֐Ɉς˂
+* @note  Ql: https://pbr-book.org/3ed-2018/Primitives_and_Intersection_Acceleration/Bounding_Volume_Hierarchies
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "AABB.h"
+
+/** BVH̃m[h([D揇ŔzɊi[) */
+struct BVHNode {
+    AABB bounds;       /**< m[h̋E{bNX                             */
+    int offset=0;      /**< t: ŏ̃v~eBüʒuC: 2Ԗڂ̎q̈ʒu */
+    uint16_t nprims=0; /**< t̃v~eBu(߂Ȃ0)                      */
+    uint8_t axis=0;    /**< ߂̕                                       */
+};
+
+
+/** BVH̕@ */
+enum class BVHSplit {
+    Middle = 1 << 0,  /**< Œ̒_ŕ               */
+    SAH    = 1 << 1   /**< \ʐσq[XeBbN(r) */
+};
+
+
+/** BVH̍\zv */
+struct BVHStats {
+    double build_time_ms=0.0; /**< \z(~b)           */
+    int num_prims=0;          /**< v~eBu             */
+    int num_nodes=0;          /**< m[h                   */
+    int num_leaves=0;         /**< t̐                     */
+    int max_depth=0;          /**< ő[                   */
+    int max_leaf_prims=0;     /**< t̍őv~eBu     */
+    float sah_cost=0.f;       /**< ؑŜSAHRXg         */
+};
+
+/**
+* @brief BVH̍\zvo͂֐
+* @param[in] s     :o̓Xg[
+* @param[in] stats :\zv
+*/
+std::ostream& operator<<(std::ostream& s, const BVHStats& stats);
+
+
+/** E{[KwNX */
+class BVH {
+public:
+    /**
+    * @brief BVH
+    */
+    BVH() {};
+
+    /**
+    * @brief v~eBűE{bNXBVH\z
+    * @param[in] prim_bounds   :v~eBűE{bNX̔z
+    * @param[in] max_leaf_size :tɊi[v~eBu̍ő吔
+    * @param[in] split         :@
+    */
+    BVH(const std::vector<AABB>& prim_bounds, int max_leaf_size=4, BVHSplit split=BVHSplit::SAH);
+
+    /**
+    * @brief \zς݂̃m[hzƃv~eBuԍBVH𕜌
+    * @param[in] _nodes        :m[hz
+    * @param[in] _prim_indices :t̏ɕׂv~eBuԍ
+    * @param[in] _stats        :\zv
+    * @note LbVt@CǂݍޏꍇɎgCe͌؂Ȃ
+    */
+    BVH(std::vector<BVHNode>&& _nodes, std::vector<int>&& _prim_indices, const BVHStats& _stats)
+        : nodes(std::move(_nodes)), prim_indices(std::move(_prim_indices)), stats(_stats) {};
+
+    /**
+    * @brief BVH󂩔
+    * @return bool :Ȃtrue
+    */
+    bool is_empty() const { return nodes.empty(); }
+
+    /**
+    * @brief BVHŜ̋E{bNX擾
+    * @return AABB :E{bNX
+    */
+    AABB get_bounds() const { return nodes.empty() ? AABB() : nodes[0].bounds; }
+
+    int get_num_nodes() const { return (int)nodes.size(); }
+
+    const BVHStats& get_stats() const { return stats; }
+
+    const std::vector<BVHNode>& get_nodes() const { return nodes; }
+
+    /**
+    * @brief t̏ɕׂiԖڂ̃v~eBuԍ擾
+    * @param[in] i :toffseẗʒu
+    * @return int  :v~eBuԍ
+    */
+    int get_prim_index(int i) const { return prim_indices[i]; }
+
+    const std::vector<int>& get_prim_indices() const { return prim_indices; }
+
+    /**
+    * @brief Cʉ߂t̃v~eBuO珇ɗ񋓂Čs֐
+    * @param[in] r              :˃C
+    * @param[in] t_min          :˃C̃p[^
+    * @param[in] t_max          :˃C̃p[^
+    * @param[in] intersect_prim :v~eBǔ֐ bool(int index, float t_min, float& t_max)
+    * @return bool              :̌
+    * @note intersect_prim͌ꍇt_max_̃p[^ɍXVtrueԂ
+    */
+    template <typename F>
+    bool intersect(const Ray& r, float t_min, float t_max, F intersect_prim) const;
+
+    /**
+    * @brief Cԓłꂩ̃v~eBuƌ邩肷֐
+    * @param[in] r             :˃C
+    * @param[in] t_min         :˃C̃p[^
+    * @param[in] t_max         :˃C̃p[^
+    * @param[in] occluded_prim :v~eBu̎Օ֐ bool(int index)
+    * @return bool             :ՕĂtrue
+    * @note ŏɌŒTł؂̂Ŏq̖K⏇͍lȂ
+    */
+    template <typename F>
+    bool occluded(const Ray& r, float t_min, float t_max, F occluded_prim) const;
+
+private:
+    /**
+    * @brief ؂ċAIɍ\z֐
+    * @param[in] prim_bounds :v~eBűE{bNX̔z
+    * @param[in] centroids   :v~eBu̒SW̔z
+    * @param[in] begin       :Sv~eBu̐擪
+    * @param[in] end         :Sv~eBu̖
+    * @param[in] depth       :m[h̐[
+    * @return int            :\zm[ḧʒu
+    */
+    int build(const std::vector<AABB>& prim_bounds, const std::vector<Vec3>& centroids,
+              int begin, int end, int depth);
+
+    /**
+    * @brief rɂ\ʐσq[XeBbNŕʒu߂֐
+    * @param[in]  prim_bounds     :v~eBűE{bNX̔z
+    * @param[in]  centroids       :v~eBu̒SW̔z
+    * @param[in]  begin           :Sv~eBu̐擪
+    * @param[in]  end             :Sv~eBu̖
+    * @param[in]  bounds          :m[h̋E{bNX
+    * @param[in]  centroid_bounds :SW̋E{bNX
+    * @param[out] mid             :ʒu
+    * @param[out] axis            :
+    * @return bool                :Ȃtrue(falseȂtɂ)
+    */
+    bool split_sah(const std::vector<AABB>& prim_bounds, const std::vector<Vec3>& centroids,
+                   int begin, int end, const AABB& bounds, const AABB& centroid_bounds,
+                   int& mid, int& axis);
+
+    int max_leaf_size = 4;             /**< t̍őv~eBu          */
+    BVHSplit split = BVHSplit::SAH;    /**< @                        */
+    std::vector<BVHNode> nodes;        /**< m[hz                      */
+    std::vector<int> prim_indices;     /**< t̏ɕׂv~eBuԍ */
+    BVHStats stats;                    /**< \zv                        */
+};
+
+
+template <typename F>
+bool BVH::intersect(const Ray& r, float t_min, float t_max, F intersect_prim) const {
+    if (nodes.empty()) {
+        return false;
+    }
+    const auto o = r.get_origin();
+    const auto d = r.get_dir();
+    const auto inv_dir = Vec3(1.0f / d[0], 1.0f / d[1], 1.0f / d[2]);
+    const bool is_neg[3] = { inv_dir[0] < 0, inv_dir[1] < 0, inv_dir[2] < 0 };
+    bool is_isect = false;
+    int stack[64]; // K\̃m[h
+    int stack_size = 0;
+    int current = 0;
+    while (true) {
+        const auto& node = nodes[current];
+        if (node.bounds.is_intersect(o, inv_dir, t_min, t_max)) {
+            // tȂv~eBuƌ
+            if (node.nprims > 0) {
+                for (int i = 0; i < node.nprims; i++) {
+                    if (intersect_prim(prim_indices[node.offset + i], t_min, t_max)) {
+                        is_isect = true;
+                    }
+                }
+                if (stack_size == 0) break;
+                current = stack[--stack_size];
+            }
+            // ߂Ȃ烌C̕ɉĎO̎qK
+            else {
+                if (is_neg[node.axis]) {
+                    stack[stack_size++] = current + 1;
+                    current = node.offset;
+                }
+                else {
+                    stack[stack_size++] = node.offset;
+                    current = current + 1;
+                }
+            }
+        }
+        else {
+            if (stack_size == 0) break;
+            current = stack[--stack_size];
+        }
+    }
+    return is_isect;
+}
+
+
+template <typename F>
+bool BVH::occluded(const Ray& r, float t_min, float t_max, F occluded_prim) const {
+    if (nodes.empty()) {
+        return false;
+    }
+    const auto o = r.get_origin();
+    const auto d = r.get_dir();
+    const auto inv_dir = Vec3(1.0f / d[0], 1.0f / d[1], 1.0f / d[2]);
+    int stack[64]; // K\̃m[h
+    int stack_size = 0;
+    int current = 0;
+    while (true) {
+        const auto& node = nodes[current];
+        if (node.bounds.is_intersect(o, inv_dir, t_min, t_max)) {
+            // tȂv~eBuƎՕ
+            if (node.nprims > 0) {
+                for (int i = 0; i < node.nprims; i++) {
+                    if (occluded_prim(prim_indices[node.offset + i])) {
+                        return true;
+                    }
+                }
+                if (stack_size == 0) break;
+                current = stack[--stack_size];
+            }
+            else {
+                stack[stack_size++] = node.offset;
+                current = current + 1;
+            }
+        }
+        else {
+            if (stack_size == 0) break;
+            current = stack[--stack_size];
+        }
+    }
+    return false;
+}
@@ -0,0 +1,265 @@
+#include "Benchmark.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include "Light.h"
+#include "Random.h"
+#include "Ray.h"
+#include "Shape.h"
+
+
+/**
+* @brief ܓxoxŕPʋ̎Op`bV𐶐֐
+* @param[in]  nu       :ox̕
+* @param[in]  nv       :ܓx̕
+* @param[out] vertices :_z
+* @param[out] indices  :CfbNXz
+* @note אڂOp`͒_L̂ŁCbVɌԂ͂Ȃ
+*/
+static void make_sphere_mesh(int nu, int nv, std::vector<Vec3>& vertices, std::vector<Vec3>& indices) {
+    // ɂ_
+    for (int j = 1; j < nv; j++) {
+        float theta = pi * j / nv;
+        for (int i = 0; i < nu; i++) {
+            float phi = 2 * pi * i / nu;
+            vertices.push_back(Vec3(std::sin(theta) * std::cos(phi), std::cos(theta),
+                                    std::sin(theta) * std::sin(phi)));
+        }
+    }
+    int north = (int)vertices.size();
+    vertices.push_back(Vec3(0, 1, 0));
+    int south = (int)vertices.size();
+    vertices.push_back(Vec3(0, -1, 0));
+    auto index = [nu](int i, int j) { return (float)((j - 1) * nu + (i % nu)); };
+    for (int i = 0; i < nu; i++) {
+        indices.push_back(Vec3((float)north, index(i + 1, 1), index(i, 1)));
+        indices.push_back(Vec3((float)south, index(i, nv - 1), index(i + 1, nv - 1)));
+        for (int j = 1; j < nv - 1; j++) {
+            indices.push_back(Vec3(index(i, j), index(i + 1, j), index(i, j + 1)));
+            indices.push_back(Vec3(index(i + 1, j), index(i + 1, j + 1), index(i, j + 1)));
+        }
+    }
+}
+
+
+/**
+* @brief C̔z肵đxƎ肱ڂo͂֐
+* @param[in] mesh :Op`bV
+* @param[in] rays :C̔z
+* @param[in] name :̎@̖O
+*/
+static void measure(const TriangleMesh& mesh, const std::vector<Ray>& rays, const char* name) {
+    auto start_time = std::chrono::system_clock::now(); // vJn
+    int num_miss = 0;
+    for (const auto& r : rays) {
+        HitRecord hit;
+        if (!mesh.intersect_hit(r, 0.f, inf, hit)) {
+            num_miss++;
+        }
+    }
+    auto end_time = std::chrono::system_clock::now(); // vI
+    double time_ms = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+    std::cout << "  " << name << ": " << rays.size() / (time_ms * 1000) << " Mrays/s, "
+              << num_miss << " leaks (" << 100.0 * num_miss / rays.size() << "%)\n";
+}
+
+
+void benchmark_triangle_intersection(int num_rays) {
+    std::vector<Vec3> vertices, indices;
+    make_sphere_mesh(256, 128, vertices, indices);
+    TriangleMesh mesh(vertices, indices, nullptr);
+    std::cout << "triangle intersection benchmark (" << mesh.get_num_triangles() << " triangles)\n";
+    PCG32 rng(0);
+    // ̓lȕ֔˂郌C
+    std::vector<Ray> random_rays;
+    for (int i = 0; i < num_rays; i++) {
+        auto o = 0.5f * Vec3(rng.next_float() - 0.5f, rng.next_float() - 0.5f, rng.next_float() - 0.5f);
+        auto d = Random::uniform_sphere_sample(Vec2(rng.next_float(), rng.next_float()));
+        random_rays.push_back(Ray(o, d));
+    }
+    // _ƕӂ̒__C(ӂ̎肱ڂN₷)
+    std::vector<Ray> edge_rays;
+    for (const auto& idx : indices) {
+        const Vec3 V[3] = { vertices[(int)idx[0]], vertices[(int)idx[1]], vertices[(int)idx[2]] };
+        for (int k = 0; k < 3; k++) {
+            auto o = 0.1f * Vec3(rng.next_float() - 0.5f, rng.next_float() - 0.5f, rng.next_float() - 0.5f);
+            edge_rays.push_back(Ray(o, unit_vector(V[k] - o)));
+            edge_rays.push_back(Ray(o, unit_vector(0.5f * (V[k] + V[(k + 1) % 3]) - o)));
+        }
+    }
+    const std::pair<TriangleIntersector, const char*> methods[] = {
+        { TriangleIntersector::MollerTrumbore, "Moller-Trumbore" },
+        { TriangleIntersector::BaldwinWeber,   "Baldwin-Weber  " },
+        { TriangleIntersector::Watertight,     "Watertight     " }
+    };
+    for (bool is_wide : { false, true }) {
+        mesh.set_wide_bvh(is_wide);
+        for (const auto& [type, name] : methods) {
+            mesh.set_intersector(type);
+            std::cout << name << (is_wide ? " (4-wide BVH)" : " (binary BVH)") << '\n';
+            measure(mesh, random_rays, "random rays");
+            measure(mesh, edge_rays, "edge rays  ");
+        }
+    }
+}
+
+
+/**
+* @brief 2D敪֐̃TvOxƐxo͂֐
+* @param[in] dist    :2D敪֐(Piecewise2D܂AliasPiecewise2D)
+* @param[in] f       :֐̔z
+* @param[in] samples :lȃTv̔z
+* @param[in] name    :TvO@̖O
+* @note px64x64vf̃ubNƂɏWvĊҒlƂ̑Ό덷̍őlo͂
+* @note Ԃ̋EɊۂ߂ꂽTvׂ͗̋ԂŊmx]̂ŁCsv̊o͂
+*/
+template <typename Dist>
+static void measure_sampling(const Dist& dist, const std::vector<float>& f,
+                             const std::vector<Vec2>& samples, const char* name) {
+    const int nu = dist.get_nu();
+    const int nv = dist.get_nv();
+    auto start_time = std::chrono::system_clock::now(); // vJn
+    Vec2 sum;
+    for (const auto& u : samples) {
+        float pdf;
+        sum += dist.sample(u, pdf);
+    }
+    auto end_time = std::chrono::system_clock::now(); // vI
+    double time_ms = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+    // Tv̊mxeval_pdf̈vCubNƂ̕pxƊҒl̈v
+    const int block = 64;
+    const int bu = (nu + block - 1) / block, bv = (nv + block - 1) / block;
+    std::vector<double> count(bu * bv, 0.0), expected(bu * bv, 0.0);
+    double total = 0.0;
+    for (int v = 0; v < nv; v++) {
+        for (int u = 0; u < nu; u++) {
+            expected[(v / block) * bu + u / block] += f[v * nu + u];
+            total += f[v * nu + u];
+        }
+    }
+    int num_pdf_mismatch = 0;
+    for (const auto& u : samples) {
+        float pdf;
+        auto uv = dist.sample(u, pdf);
+        float ref = dist.eval_pdf(uv);
+        if (std::abs(pdf - ref) > 1e-3f * ref) {
+            num_pdf_mismatch++;
+        }
+        int iu = std::min((int)(uv[0] * nu), nu - 1);
+        int iv = std::min((int)(uv[1] * nv), nv - 1);
+        count[(iv / block) * bu + iu / block] += 1.0;
+    }
+    double max_freq_error = 0.0;
+    for (int i = 0; i < bu * bv; i++) {
+        double e = expected[i] / total * samples.size();
+        if (e >= 10000) { // v덷1%x̃ubN̂
+            max_freq_error = std::max(max_freq_error, std::abs(count[i] - e) / e);
+        }
+    }
+    std::cout << "  " << name << ": " << samples.size() / (time_ms * 1000) << " Msamples/s, pdf mismatch "
+              << 100.0 * num_pdf_mismatch / samples.size() << "%, block frequency error " << 100.0 * max_freq_error << "% (checksum "
+              << sum[0] + sum[1] << ")\n";
+}
+
+
+void benchmark_piecewise_sampling(int nu, int nv, int num_samples) {
+    std::cout << "piecewise sampling benchmark (" << nu << "x" << nv << ")\n";
+    // ̃Of[VƏ邢z(sinƂ|}bv̋Pxz)
+    PCG32 rng(0);
+    std::vector<float> f(nu * nv);
+    for (int v = 0; v < nv; v++) {
+        float theta = pi * (v + 0.5f) / nv;
+        for (int u = 0; u < nu; u++) {
+            float phi = 2 * pi * (u + 0.5f) / nu;
+            float sky = 0.2f + std::max(std::cos(theta), 0.f) + 0.05f * rng.next_float();
+            float d2 = (phi - 1.0f) * (phi - 1.0f) + (theta - 0.8f) * (theta - 0.8f);
+            float sun = d2 < 0.0004f ? 5000.f : 0.f;
+            f[v * nu + u] = (sky + sun) * std::sin(theta);
+        }
+    }
+    std::vector<Vec2> samples(num_samples);
+    for (auto& u : samples) {
+        u = Vec2(rng.next_float(), rng.next_float());
+    }
+    auto start_time = std::chrono::system_clock::now();
+    Piecewise2D cdf_dist(f.data(), nu, nv);
+    auto mid_time = std::chrono::system_clock::now();
+    AliasPiecewise2D alias_dist(f.data(), nu, nv);
+    auto end_time = std::chrono::system_clock::now();
+    std::cout << "  build: CDF " << std::chrono::duration<double, std::milli>(mid_time - start_time).count()
+              << " ms, alias " << std::chrono::duration<double, std::milli>(end_time - mid_time).count() << " ms\n";
+    measure_sampling(cdf_dist, f, samples, "CDF inversion");
+    measure_sampling(alias_dist, f, samples, "alias table  ");
+}
+
+
+/**
+* @brief ֐z̑SvfɓKpԂv֐
+* @param[in]  in   :͂̔z
+* @param[out] out  :o͂̔z
+* @param[in]  func :ϊ֐
+* @return double   :1vf̎(imb)
+*/
+template <typename In, typename Out, typename F>
+static double measure_mapping(const std::vector<In>& in, std::vector<Out>& out, F func) {
+    auto start_time = std::chrono::system_clock::now();
+    for (size_t i = 0; i < in.size(); i++) {
+        out[i] = func(in[i]);
+    }
+    auto end_time = std::chrono::system_clock::now();
+    return std::chrono::duration<double, std::nano>(end_time - start_time).count() / in.size();
+}
+
+
+void benchmark_environment_mapping(int num_dirs) {
+    std::cout << "environment mapping benchmark (" << num_dirs << " directions)\n";
+    PCG32 rng(0);
+    std::vector<Vec3> dirs(num_dirs);
+    std::vector<Vec2> uvs(num_dirs);
+    for (int i = 0; i < num_dirs; i++) {
+        dirs[i] = Random::uniform_sphere_sample(Vec2(rng.next_float(), rng.next_float()));
+        uvs[i] = Vec2(rng.next_float(), rng.next_float());
+    }
+    // ɂƌox̌p
+    dirs[0] = Vec3(0.f, 1.0f, 0.f);
+    dirs[1] = Vec3(0.f, -1.0f, 0.f);
+    dirs[2] = Vec3(-1.0f, 0.f, 0.f);
+    dirs[3] = Vec3(-1.0f, 0.f, -0.f);
+    uvs[0] = Vec2(0.f, 0.f);
+    uvs[1] = Vec2(one_minus_epsilon, one_minus_epsilon);
+    // uvW
+    std::vector<Vec2> uv_exact(num_dirs), uv_fast(num_dirs);
+    double t_exact = measure_mapping(dirs, uv_exact, direction_to_equirect_exact);
+    double t_fast = measure_mapping(dirs, uv_fast, direction_to_equirect);
+    const int nw = 2048, nh = 1024;
+    double max_du = 0.0, max_dv = 0.0;
+    int num_texel_mismatch = 0;
+    for (int i = 0; i < num_dirs; i++) {
+        double du = std::abs(uv_fast[i][0] - uv_exact[i][0]);
+        max_du = std::max(max_du, std::min(du, 1.0 - du)); // pڂ܂덷
+        max_dv = std::max(max_dv, (double)std::abs(uv_fast[i][1] - uv_exact[i][1]));
+        int x0 = std::min((int)(uv_exact[i][0] * nw), nw - 1), x1 = std::min((int)(uv_fast[i][0] * nw), nw - 1);
+        int y0 = std::min((int)(uv_exact[i][1] * nh), nh - 1), y1 = std::min((int)(uv_fast[i][1] * nh), nh - 1);
+        if (x0 != x1 || y0 != y1) {
+            num_texel_mismatch++;
+        }
+    }
+    std::cout << "  direction to uv: exact " << t_exact << " ns, fast " << t_fast << " ns, max error u "
+              << max_du << " v " << max_dv << ", texel mismatch " << 100.0 * num_texel_mismatch / num_dirs << "%\n";
+    // uvW
+    std::vector<Vec3> dir_exact(num_dirs), dir_fast(num_dirs);
+    float sin_theta;
+    t_exact = measure_mapping(uvs, dir_exact, [&](const Vec2& uv) { return equirect_to_direction_exact(uv, sin_theta); });
+    t_fast = measure_mapping(uvs, dir_fast, [&](const Vec2& uv) { return equirect_to_direction(uv, sin_theta); });
+    double max_dir_error = 0.0, max_sin_error = 0.0;
+    for (int i = 0; i < num_dirs; i++) {
+        max_dir_error = std::max(max_dir_error, (double)(dir_fast[i] - dir_exact[i]).length());
+        float s_exact, s_fast;
+        equirect_to_direction_exact(uvs[i], s_exact);
+        equirect_to_direction(uvs[i], s_fast);
+        max_sin_error = std::max(max_sin_error, (double)std::abs(s_fast - s_exact));
+    }
+    std::cout << "  uv to direction: exact " << t_exact << " ns, fast " << t_fast << " ns, max error direction "
+              << max_dir_error << " sin_theta " << max_sin_error << "\n";
+}
\ No newline at end of file
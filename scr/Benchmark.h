@@ -0,0 +1,30 @@
+/**
+* @file  Benchmark.h
+* @brief Ȃǂ̐\Ɛxvx`}[N
+*/
+
+#pragma once
+
+/**
+* @brief Op`bV̌̎@Ƃ̑xƎ肱ڂv֐
+* @param[in] num_rays :vɎgC̐
+* @note bV̓甭˂C͕K̂ŁCȂC肱ڂƂĐ
+* @note lȕ̃CɉāC_ƕӂ̒__CŐmF
+*/
+void benchmark_triangle_intersection(int num_rays=1000000);
+
+/**
+* @brief 2D敪֐̃TvO(CDF̋t֐@ƃGCAX@)̑xƐxv֐
+* @param[in] nu          :u̗vf
+* @param[in] nv          :v̗vf
+* @param[in] num_samples :vɎgTv
+* @note }bv͂zƋ̋PxzgCTv̕pxƊmẍvmF
+*/
+void benchmark_piecewise_sampling(int nu=2048, int nv=1024, int num_samples=10000000);
+
+/**
+* @brief }bv̕uvW̕ϊ(ߎƕWCu)̑xƌ덷v֐
+* @param[in] num_dirs :vɎg̐
+* @note 2048x1024̊}bvŎQƂeNZς銄o͂
+*/
+void benchmark_environment_mapping(int num_dirs=10000000);
\ No newline at end of file
@@ -1,12 +1,10 @@
 #include "BxDF.h"
 #include "Fresnel.h"
 #include "Microfacet.h"
+#include "MicrofacetAlbedo.h"
 #include "Shape.h"
 #include "Random.h"
 
-#include "external/stb_image_write.h"
-#include "external/stb_image.h"
-
 
 // *** Lambert ***
 
@@ -26,8 +24,8 @@ Vec3 LambertianReflection::eval_f(const Vec3& wo, const Vec3& wi,
 }
 
 Vec3 LambertianReflection::sample_f(const Vec3& wo, const intersection& p,
-    Vec3& wi, float& pdf) const {
-    wi = Random::cosine_hemisphere_sample();
+    Vec3& wi, float& pdf, const Vec2& u) const {
+    wi = Random::cosine_hemisphere_sample(u);
     pdf = eval_pdf(wo, wi, p);
     return eval_f(wo, wi, p);
 }
@@ -59,7 +57,7 @@ Vec3 SpecularReflection::eval_f(const Vec3& wo, const Vec3& wi,
 }
 
 Vec3 SpecularReflection::sample_f(const Vec3& wo, const intersection& p,
-    Vec3& wi, float& pdf) const {
+    Vec3& wi, float& pdf, const Vec2& u) const {
     // ˕𖾎Iɏd_ITvÔeval\bh͎gȂ
     wi = Vec3(-wo.get_x(), -wo.get_y(), wo.get_z()); // ˕
     pdf = 1.0f;
@@ -96,7 +94,7 @@ Vec3 SpecularTransmission::eval_f(const Vec3& wo, const Vec3& wi,
 }
 
 Vec3 SpecularTransmission::sample_f(const Vec3& wo, const intersection& p,
-    Vec3& wi, float& pdf) const {
+    Vec3& wi, float& pdf, const Vec2& u) const {
     // ߕ𖾎Iɏd_ITvO
     // note: wo˕ƂBTDFvZwi˕ɂȂ悤ɕϊ
     auto eta = p.is_front ? n_outside / n_inside : n_inside / n_outside; // ΋
@@ -145,15 +143,15 @@ Vec3 PhongReflection::eval_f(const Vec3& wo, const Vec3& wi,
 }
 
 Vec3 PhongReflection::sample_f(const Vec3& wo, const intersection& p,
-    Vec3& wi, float& pdf) const {
-    wi = phong_sample(shine);
+    Vec3& wi, float& pdf, const Vec2& u) const {
+    wi = phong_sample(shine, u);
     pdf = eval_pdf(wo, wi, p);
     return eval_f(wo, wi, p);
 }
 
-Vec3 PhongReflection::phong_sample(float shine) const {
-    auto u = Random::uniform_float();
-    auto v = Random::uniform_float();
+Vec3 PhongReflection::phong_sample(float shine, const Vec2& uv) const {
+    auto u = uv[0];
+    auto v = uv[1];
     auto z = std::pow(u, 1 / (shine + 1.0f));
     auto r = std::sqrt(std::max(1.0f - z * z, 0.f));
     auto phi = 2 * pi * v;
@@ -224,16 +222,9 @@ Vec3 MicrofacetReflection::eval_f(const Vec3& wo, const Vec3& wi,
     auto brdf = (D * G * F) / (4 * cos_wo * cos_wi);
     // dUlꍇ̓GlM[U[Kulla and Conty 2017]
     if (is_multiple_scattering) {
-        int index_wo = int(cos_wo * table_size - 1.f); // cos = (index + 1) / table_size
-        int index_wi = int(cos_wi * table_size - 1.f);
-        // Note: CfbNXtable_size-1ɂȂ邱Ƃ͋H(cos=1̏ꍇ̂)
-        index_wo = std::clamp(index_wo, 0, table_size - 2);
-        index_wi = std::clamp(index_wi, 0, table_size - 2);
         // Axh̎擾
-        auto t_wo = cos_wo * table_size - 1.f - index_wo;
-        auto t_wi = cos_wi * table_size - 1.f - index_wi;
-        auto E_wo = t_wo * E[index_wo] + (1.f - t_wo) * E[index_wo + 1];
-        auto E_wi = t_wi * E[index_wi] + (1.f - t_wi) * E[index_wi + 1];
+        auto E_wo = eval_directional_albedo(dist->get_type(), dist->get_alpha(), cos_wo);
+        auto E_wi = eval_directional_albedo(dist->get_type(), dist->get_alpha(), cos_wi);
         // F_mšvZ(Ql: https://blog.selfshadow.com/2018/06/04/multi-faceted-part-2/)
         Vec3 F_ms = Vec3::one;
         for (int i = 0; i < 3; i++) {
@@ -246,97 +237,29 @@ Vec3 MicrofacetReflection::eval_f(const Vec3& wo, const Vec3& wi,
 }
 
 Vec3 MicrofacetReflection::sample_f(const Vec3& wo, const intersection& p,
-    Vec3& wi, float& pdf) const {
+    Vec3& wi, float& pdf, const Vec2& u) const {
     // n[uxNgTvOē˕ɕϊ
-    Vec3 h = dist->sample_halfvector(wo);
+    Vec3 h = dist->sample_halfvector(wo, u);
     wi = unit_vector(reflect(wo, h)); // reflect()ł͐KȂ̂ŖIɐK
     pdf = eval_pdf(wo, wi, p);
     return eval_f(wo, wi, p);
 }
 
-float MicrofacetReflection::weight(float cos_theta, float phi, 
-    const std::shared_ptr<NDF>& dist_alpha) const {
-    auto sin_theta = std::sqrt(1.0f - cos_theta * cos_theta);
-    Vec3 wo(sin_theta * std::cos(phi), sin_theta * std::sin(phi), cos_theta);
-    // ˊpTvO
-    Vec3 h = dist_alpha->sample_halfvector(wo);
-    auto wi = unit_vector(reflect(wo, h));
-    // ˕Əo˕ɂȂꍇ͖
-    if (!is_same_hemisphere(wo, wi)) {
-        return 0.f;
-    }
-    // 댯ȃP[XO
-    if (std::abs(get_cos(wo)) == 0 || std::abs(get_cos(wi)) == 0) {
-        return 0.f;
-    }
-    float weight = 0.f;
-    // VNDF̏d݌vZ
-    if (dist_alpha->get_is_visible_sampling()) {
-        weight = dist_alpha->G(wo, wi) / dist_alpha->G1(wo);
-    }
-    // NDF̏d݌vZ
-    else {
-        weight = dist_alpha->G(wo, wi) * std::abs(dot(wo, h)) / std::abs(get_cos(wo)) / std::abs(get_cos(h));
-    }
-    if (!isfinite(weight)) weight = 0.f; // ȒlO
-    return weight;
-}
-
 void MicrofacetReflection::create_multiple_scattering_table() {
-    int nsamples = 10000;
-    // DirectionalAxhƕσAxhvZ
-    for (int i = 0; i < table_size; i++) {
-        auto cos_theta = (i+1.0f) / table_size; // ˊp]
-        E[i] = 0.f;
-        for (int j= 0; j < nsamples; j++) {
-            auto phi = Random::uniform_float(0.f, 2*pi);
-            E[i] += weight(cos_theta, phi, dist);
-        }
-        E[i] /= nsamples;
-        E_ave += E[i] * cos_theta;
-    }
-    E_ave = 2 * E_ave / table_size;
+    E_ave = eval_average_albedo(dist->get_type(), dist->get_alpha());
 
     // σtlvZ
-    for (int i = 0; i < table_size; i++) {
-        auto cos_theta = (i + 1.0f) / table_size; // ˊp]
+    const int nsamples = 1000;
+    for (int i = 0; i < nsamples; i++) {
+        auto cos_theta = (i + 1.0f) / nsamples; // ˊp]
         intersection p;
         F_ave += fres->eval(cos_theta, p) * cos_theta;
     }
-    F_ave = 2.f * F_ave / (float)table_size;
+    F_ave = 2.f * F_ave / (float)nsamples;
     // 덷ɂGlM[߂h~
     for (int i = 0; i < 3; i++) {
         F_ave[i] = std::clamp(F_ave[i], 0.f, 1.f);
     }
-
-    // dUe[ȕo
-    bool is_write_table = false;
-    if (is_write_table) {
-        std::vector<uint8_t> img(table_size * table_size * 3, 0);  // 摜f[^
-        for (int h = 0; h < table_size; h++) {
-            auto alpha = (h + 1.0f) / table_size; // \ʑe
-            alpha = alpha * alpha;
-            auto dist_alpha = std::make_shared<GGX>(alpha, true);
-            for (int w = 0; w < table_size; w++) {
-                auto cos_theta = (w + 1.0f) / table_size; // ˊp]
-                // ^vZ
-                float e = 0.f;
-                for (int k = 0; k < nsamples; k++) {
-                    auto phi = Random::uniform_float(0.f, 2 * pi);
-                    e += weight(cos_theta, phi, dist_alpha);
-                }
-                e = e / nsamples;
-                int e_int = static_cast<int>((1.0f - e) * 255);
-                int index = h * table_size * 3 + w * 3;
-                img[index]     = std::clamp(e_int, 0, 255);
-                img[index + 1] = std::clamp(e_int, 0, 255);
-                img[index + 2] = std::clamp(e_int, 0, 255);
-            }
-        }
-        // 摜̏o
-        stbi_write_png("table.png", table_size, table_size, 3, img.data(),
-            table_size * 3 * sizeof(uint8_t));
-    }
 }
 
 
@@ -408,8 +331,8 @@ Vec3 MicrofacetTransmission::eval_f(const Vec3& wo, const Vec3& wi,
 }
 
 Vec3 MicrofacetTransmission::sample_f(const Vec3& wo, const intersection& p,
-    Vec3& wi, float& pdf) const {
-    Vec3 h = dist->sample_halfvector(wo);
+    Vec3& wi, float& pdf, const Vec2& u) const {
+    Vec3 h = dist->sample_halfvector(wo, u);
     auto eta = p.is_front ? n_outside / n_inside : n_inside / n_outside; // ΋
     wi = unit_vector(refract(wo, h, eta)); // refract()ł͐KȂ̂ŖIɐK
     // S˂̏ꍇ
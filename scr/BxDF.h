@@ -113,9 +113,11 @@ public:
     * @param[in]  p    :̕\ʂ̌_
     * @param[out] wi   :o˕xNg([JW)
     * @param[out] pdf  :˕TvOmx(̊px)
+    * @param[in]  u    :[0, 1)^2̈lȃTv
     * @return Vec3     :BxDF̕]l
     */
-    virtual Vec3 sample_f(const Vec3& wo, const intersection& p, Vec3& wi, float& pdf) const = 0;
+    virtual Vec3 sample_f(const Vec3& wo, const intersection& p, Vec3& wi, float& pdf,
+                          const Vec2& u) const = 0;
 
     /**
     * @brief BxDF]֐
@@ -192,7 +194,8 @@ public:
 
     float eval_pdf(const Vec3& wo, const Vec3& wi, const intersection& p) const override;
 
-    Vec3 sample_f(const Vec3& wo, const intersection& p, Vec3& wi, float& pdf) const override;
+    Vec3 sample_f(const Vec3& wo, const intersection& p, Vec3& wi, float& pdf,
+                  const Vec2& u) const override;
 
     Vec3 eval_f(const Vec3& wo, const Vec3& wi, const intersection& p) const override;
 
@@ -223,7 +226,8 @@ public:
 
     Vec3 eval_f(const Vec3& wo, const Vec3& wi, const intersection& p) const override;
 
-    Vec3 sample_f(const Vec3& wo, const intersection& p, Vec3& wi, float& pdf) const override;
+    Vec3 sample_f(const Vec3& wo, const intersection& p, Vec3& wi, float& pdf,
+                  const Vec2& u) const override;
 
 private:
     Vec3 scale; /**> XP[t@N^[ */
@@ -248,7 +252,8 @@ public:
 
     Vec3 eval_f(const Vec3& wo, const Vec3& wi, const intersection& p) const override;
 
-    Vec3 sample_f(const Vec3& wo, const intersection& p, Vec3& wi, float& pdf) const override;
+    Vec3 sample_f(const Vec3& wo, const intersection& p, Vec3& wi, float& pdf,
+                  const Vec2& u) const override;
 
 private:
     Vec3 scale; /**> XP[t@N^[ */
@@ -272,16 +277,18 @@ public:
 
     Vec3 eval_f(const Vec3& wo, const Vec3& wi, const intersection& p) const override;
 
-    Vec3 sample_f(const Vec3& wo, const intersection& p, Vec3& wi, float& pdf) const override;
+    Vec3 sample_f(const Vec3& wo, const intersection& p, Vec3& wi, float& pdf,
+                  const Vec2& u) const override;
 
 private:
     /**
     * @brief KPhongz烌C̕TvO
     * @param[in] alpha :z̃p[^
+    * @param[in] u     :[0, 1)^2̈lȃTv
     * @return Vec3     :C̕
     * @note: [E.Lafortune and Y.Willems 1994]Ɏ
     */
-    Vec3 phong_sample(float shine) const;
+    Vec3 phong_sample(float shine, const Vec2& u) const;
 
     Vec3 scale;  /**> ˌW */
     float shine; /**> x */
@@ -314,21 +321,15 @@ public:
 
     Vec3 eval_f(const Vec3& wo, const Vec3& wi, const intersection& p) const override;
 
-    Vec3 sample_f(const Vec3& wo, const intersection& p, Vec3& wi, float& pdf) const override;
+    Vec3 sample_f(const Vec3& wo, const intersection& p, Vec3& wi, float& pdf,
+                  const Vec2& u) const override;
 
 private:
     /**
-    * @brief dUe[uvZ֐
+    * @brief dU̕UɎgσAxhƕσtlvZ֐
+    * @note AxhƕσAxh͑S}eAŋL鎖OvZe[u(MicrofacetAlbedo.h)Ԃ
     */
     void create_multiple_scattering_table();
-    /**
-    * @brief eJ̏d݂vZ֐(dUe[ǔvZɗp)
-    * @param[in] theta      :p̗]
-    * @param[in] phi        :ʊp
-    * @param[in] dist_alpha :}CNt@ZbgNDF
-    * @note: VNDFTvOɊÂd݂vZĂ̂Œ(TODO: C)
-    */
-    float weight(float cos_theta, float phi, const std::shared_ptr<NDF>& dist_alpha) const;
 
     Vec3 scale; /**> XP[t@N^[ */
     std::shared_ptr<Fresnel> fres; /**> tl */
@@ -336,8 +337,6 @@ private:
     bool is_multiple_scattering; /**> dU̍lȂtrue */
     float E_ave; /**> σAxh */
     Vec3 F_ave;  /**> σtl*/
-    float E[1000] = { 0.f }; /**> DirectionalAxh */
-    int table_size = sizeof(E) / sizeof(float);
 };
 
 
@@ -360,7 +359,8 @@ public:
 
     Vec3 eval_f(const Vec3& wo, const Vec3& wi, const intersection& p) const override;
 
-    Vec3 sample_f(const Vec3& wo, const intersection& p, Vec3& wi, float& pdf) const override;
+    Vec3 sample_f(const Vec3& wo, const intersection& p, Vec3& wi, float& pdf,
+                  const Vec2& u) const override;
 
 private:
     Vec3 scale; /**> XP[t@N^[ */
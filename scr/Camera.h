@@ -31,6 +31,7 @@ public:
     int get_w() const;
     int get_c() const;
     const char* get_filename() const;
+    std::shared_ptr<Film> get_film() const { return film; }
     Vec3 get_forward() const;
 
     /**
@@ -1,8 +1,241 @@
 #include "Film.h"
+#include "external/stb_image_write.h"
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+
+// *** U_O̕摜 ***
+
+// 摜̌`̔
+constexpr uint32_t PARTIAL_FILM_VERSION = 1;
+
+/** 摜̃wb_(RGB̕ˋPxƃsNZƂ̏d݂) */
+struct PartialFilmHeader {
+	char magic[4] = { 'T', 'P', 'P', 'F' }; /**< t@C̎ʎq */
+	uint32_t version = PARTIAL_FILM_VERSION; /**< `̔         */
+	int32_t w = 0;                          /**< 摜̕         */
+	int32_t h = 0;                          /**< 摜̍       */
+};
 
 
 Film::Film(int _w, int _h, int _c, const std::string& _filename)
-	: w(_w), h(_h), c(_c), filename(_filename)
+	: w(_w), h(_h), c(_c), filename(_filename),
+	  pixels((size_t)_w * _h * 3, 0.f), weights((size_t)_w * _h, 0.f)
 {
 	aspect = (float)w / h;
-}
\ No newline at end of file
+}
+
+void Film::set_pixel(int x, int y, const Vec3& L, float weight) {
+	float* p = &pixels[((size_t)y * w + x) * 3];
+	p[0] = L.get_x();
+	p[1] = L.get_y();
+	p[2] = L.get_z();
+	weights[(size_t)y * w + x] = weight;
+}
+
+Vec3 Film::get_pixel(int x, int y) const {
+	const float* p = &pixels[((size_t)y * w + x) * 3];
+	return Vec3(p[0], p[1], p[2]);
+}
+
+void Film::tonemap(std::vector<uint8_t>& img) const {
+	const float scale = std::exp2(exposure);
+	img.resize((size_t)w * h * 3);
+	for (size_t i = 0; i < (size_t)w * h; i++) {
+		Vec3 I(pixels[3 * i], pixels[3 * i + 1], pixels[3 * i + 2]);
+		if (exposure != 0) I *= scale;
+		I = clamp(I); // [0, 1]ŃNv(TODO: g[}bsO̎)
+		if (is_gamma_correction) I = gamma_correction(I);
+		img[3 * i]     = static_cast<uint8_t>(I.get_x() * 255);
+		img[3 * i + 1] = static_cast<uint8_t>(I.get_y() * 255);
+		img[3 * i + 2] = static_cast<uint8_t>(I.get_z() * 255);
+	}
+}
+
+bool Film::write(const std::string& _filename) const {
+	auto dot_pos = _filename.find_last_of('.');
+	std::string ext = dot_pos == std::string::npos ? "" : _filename.substr(dot_pos + 1);
+	for (auto& ch : ext) ch = (char)std::tolower((unsigned char)ch);
+	if (ext == "exr") return write_exr(_filename);
+	if (ext == "pfm") return write_pfm(_filename);
+	if (ext == "hdr") return write_hdr(_filename);
+	return write_png(_filename);
+}
+
+bool Film::write_png(const std::string& _filename) const {
+	std::vector<uint8_t> img;
+	tonemap(img);
+	return stbi_write_png(_filename.c_str(), w, h, 3, img.data(), w * 3 * sizeof(uint8_t)) != 0;
+}
+
+bool Film::write_pfm(const std::string& _filename) const {
+	std::ofstream ofs(_filename, std::ios::binary);
+	if (!ofs) {
+		return false;
+	}
+	// ̃XP[̓gGfBA\
+	ofs << "PF\n" << w << ' ' << h << "\n-1.0\n";
+	// PFM͉̍s珇Ɋi[
+	for (int y = h - 1; y >= 0; y--) {
+		ofs.write((const char*)&pixels[(size_t)y * w * 3], (size_t)w * 3 * sizeof(float));
+	}
+	return (bool)ofs;
+}
+
+bool Film::write_exr(const std::string& _filename) const {
+	// wb_gݗĂ(l̓gGfBA)
+	std::vector<char> header;
+	auto put = [&](const void* data, size_t size) {
+		header.insert(header.end(), (const char*)data, (const char*)data + size);
+	};
+	auto put_i32 = [&](int32_t v) { put(&v, sizeof(v)); };
+	auto put_str = [&](const char* s) { put(s, std::strlen(s) + 1); };
+	auto put_attr = [&](const char* name, const char* type, int32_t size) {
+		put_str(name);
+		put_str(type);
+		put_i32(size);
+	};
+	const uint8_t magic[4] = { 0x76, 0x2f, 0x31, 0x01 };
+	put(magic, sizeof(magic));
+	put_i32(2); // (Pp[g̃XLC`)
+	// `l͖Ȍ(B, G, R)ɕׂ
+	put_attr("channels", "chlist", 3 * 18 + 1);
+	for (const char* name : { "B", "G", "R" }) {
+		put_str(name);
+		put_i32(2); // FLOAT
+		const uint8_t linear_and_reserved[4] = { 0, 0, 0, 0 };
+		put(linear_and_reserved, sizeof(linear_and_reserved));
+		put_i32(1); // x̃TvOԊu
+		put_i32(1); // ỹTvOԊu
+	}
+	header.push_back(0);
+	put_attr("compression", "compression", 1);
+	header.push_back(0); // k
+	for (const char* name : { "dataWindow", "displayWindow" }) {
+		put_attr(name, "box2i", 16);
+		put_i32(0);
+		put_i32(0);
+		put_i32(w - 1);
+		put_i32(h - 1);
+	}
+	put_attr("lineOrder", "lineOrder", 1);
+	header.push_back(0); // ̍s珇
+	const float one = 1.0f, zero[2] = { 0.f, 0.f };
+	put_attr("pixelAspectRatio", "float", 4);
+	put(&one, sizeof(one));
+	put_attr("screenWindowCenter", "v2f", 8);
+	put(zero, sizeof(zero));
+	put_attr("screenWindowWidth", "float", 4);
+	put(&one, sizeof(one));
+	header.push_back(0);
+
+	std::ofstream ofs(_filename, std::ios::binary);
+	if (!ofs) {
+		return false;
+	}
+	ofs.write(header.data(), header.size());
+	// XLCƂ̃t@C擪̈ʒu
+	const int32_t line_bytes = w * 3 * (int32_t)sizeof(float);
+	const uint64_t line_size = 2 * sizeof(int32_t) + line_bytes;
+	for (int y = 0; y < h; y++) {
+		uint64_t offset = header.size() + (uint64_t)h * sizeof(uint64_t) + y * line_size;
+		ofs.write((const char*)&offset, sizeof(offset));
+	}
+	// XLC̓`lƂ1s̒lׂ
+	std::vector<float> line((size_t)w * 3);
+	for (int32_t y = 0; y < h; y++) {
+		const float* row = &pixels[(size_t)y * w * 3];
+		for (int x = 0; x < w; x++) {
+			line[x] = row[3 * x + 2];
+			line[w + x] = row[3 * x + 1];
+			line[2 * w + x] = row[3 * x];
+		}
+		ofs.write((const char*)&y, sizeof(y));
+		ofs.write((const char*)&line_bytes, sizeof(line_bytes));
+		ofs.write((const char*)line.data(), line_bytes);
+	}
+	return (bool)ofs;
+}
+
+bool Film::write_hdr(const std::string& _filename) const {
+	return stbi_write_hdr(_filename.c_str(), w, h, 3, pixels.data()) != 0;
+}
+
+bool Film::write_partial(const std::string& _filename) const {
+	std::ofstream ofs(_filename, std::ios::binary);
+	if (!ofs) {
+		return false;
+	}
+	PartialFilmHeader header;
+	header.w = w;
+	header.h = h;
+	ofs.write((const char*)&header, sizeof(header));
+	ofs.write((const char*)pixels.data(), pixels.size() * sizeof(float));
+	ofs.write((const char*)weights.data(), weights.size() * sizeof(float));
+	return (bool)ofs;
+}
+
+
+std::shared_ptr<Film> merge_partial_films(const std::vector<std::string>& part_filenames,
+	const std::string& filename) {
+	std::shared_ptr<Film> film;
+	std::vector<double> sum;         // dݕt̕ˋPx̍v
+	std::vector<double> sum_weights; // d݂̍v
+	std::vector<float> pixels, weights;
+	for (const auto& part_filename : part_filenames) {
+		std::ifstream ifs(part_filename, std::ios::binary);
+		PartialFilmHeader header, file_header;
+		ifs.read((char*)&file_header, sizeof(file_header));
+		if (!ifs || std::memcmp(file_header.magic, header.magic, sizeof(header.magic)) != 0 ||
+			file_header.version != header.version || file_header.w <= 0 || file_header.h <= 0) {
+			std::cerr << part_filename << ": not a partial image\n";
+			return nullptr;
+		}
+		if (!film) {
+			film = std::make_shared<Film>(file_header.w, file_header.h, 3, filename);
+			sum.assign((size_t)file_header.w * file_header.h * 3, 0.0);
+			sum_weights.assign((size_t)file_header.w * file_header.h, 0.0);
+		}
+		else if (file_header.w != film->get_w() || file_header.h != film->get_h()) {
+			std::cerr << part_filename << ": image size does not match\n";
+			return nullptr;
+		}
+		pixels.resize(sum.size());
+		weights.resize(sum_weights.size());
+		ifs.read((char*)pixels.data(), pixels.size() * sizeof(float));
+		ifs.read((char*)weights.data(), weights.size() * sizeof(float));
+		if (!ifs) {
+			std::cerr << part_filename << ": partial image is truncated\n";
+			return nullptr;
+		}
+		// {xōv̂ŁC1̕摜݂̂SsNZ͌̒lɖ߂
+		for (size_t i = 0; i < weights.size(); i++) {
+			if (weights[i] <= 0) continue;
+			for (int k = 0; k < 3; k++) {
+				sum[3 * i + k] += (double)weights[i] * pixels[3 * i + k];
+			}
+			sum_weights[i] += weights[i];
+		}
+	}
+	if (!film) {
+		return nullptr;
+	}
+	const int w = film->get_w();
+	size_t num_missing = 0; // ǂ̕摜SĂȂsNZ
+	for (size_t i = 0; i < sum_weights.size(); i++) {
+		if (sum_weights[i] <= 0) {
+			num_missing++;
+			continue;
+		}
+		Vec3 L((float)(sum[3 * i] / sum_weights[i]), (float)(sum[3 * i + 1] / sum_weights[i]),
+			(float)(sum[3 * i + 2] / sum_weights[i]));
+		film->set_pixel((int)(i % w), (int)(i / w), L, (float)sum_weights[i]);
+	}
+	if (num_missing > 0) {
+		std::cerr << "warning: " << num_missing << " pixels are not covered by the partial images\n";
+	}
+	return film;
+}
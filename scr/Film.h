@@ -1,11 +1,16 @@
 /**
 * @file  Film.h
 * @brief J̃tB
+* @note  ˋPxjAfloat̂܂ܕێCg[}bsOƗʎq͉摜̏o͎ɍs
 */
 
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
+#include "Math.h"
 
 /** tBNX */
 class Film {
@@ -15,7 +20,7 @@ public:
 	* @param[in] _w        :tB
 	* @param[in] _h        :tB̍
 	* @param[in] _c        :tB̃`Fl
-	* @param[in] _filename :o͉摜̃t@C
+	* @param[in] _filename :o͉摜̃t@C(gq.exr/.pfm/.hdrȂHDR摜o)
 	*/
 	Film(int _w, int _h, int _c, const std::string& _filename);
 
@@ -24,6 +29,89 @@ public:
 	int get_c() const { return c; }
 	float get_aspect() const { return aspect; }
 	const char* get_filename() const { return filename.c_str(); }
+	void set_filename(const std::string& _filename) { filename = _filename; }
+
+	/**
+	* @brief sNZ̕ˋPxݒ肷֐
+	* @param[in] x      :sNZxW([0)
+	* @param[in] y      :sNZyW([0)
+	* @param[in] L      :jAȕˋPx
+	* @param[in] weight :摜Ƃ̏d(Tv)
+	*/
+	void set_pixel(int x, int y, const Vec3& L, float weight=1.0f);
+
+	/**
+	* @brief sNZ̕ˋPx擾֐
+	* @param[in] x :sNZxW([0)
+	* @param[in] y :sNZyW([0)
+	* @return Vec3 :jAȕˋPx
+	*/
+	Vec3 get_pixel(int x, int y) const;
+
+	float get_weight(int x, int y) const { return weights[(size_t)y * w + x]; }
+
+	/**
+	* @brief g[}bsO̘Ioݒ肷֐
+	* @param[in] _exposure :Io␳l[EV](ˋPx2^exposure{)
+	*/
+	void set_exposure(float _exposure) { exposure = _exposure; }
+
+	float get_exposure() const { return exposure; }
+
+	/**
+	* @brief Io␳CNvCK}␳{8bitɗʎq֐
+	* @param[out] img :RGB̉摜f[^(̍s珇Ɋi[)
+	*/
+	void tonemap(std::vector<uint8_t>& img) const;
+
+	/**
+	* @brief o̓t@C̊gqɉ`ŉ摜o֐
+	* @return bool :otrue
+	*/
+	bool write() const { return write(filename); }
+
+	/**
+	* @brief gqɉ`ŉ摜o֐
+	* @param[in] _filename :o̓t@C(.exr/.pfm/.hdr̓jAHDR摜CȊO̓g[}bsOPNG摜)
+	* @return bool         :otrue
+	*/
+	bool write(const std::string& _filename) const;
+
+	/**
+	* @brief g[}bsOPNG摜o֐
+	* @param[in] _filename :o̓t@C
+	* @return bool         :otrue
+	*/
+	bool write_png(const std::string& _filename) const;
+
+	/**
+	* @brief jAPFM(Portable Float Map)摜o֐
+	* @param[in] _filename :o̓t@C
+	* @return bool         :otrue
+	*/
+	bool write_pfm(const std::string& _filename) const;
+
+	/**
+	* @brief jAOpenEXR摜(32bit floatRGBCk)o֐
+	* @param[in] _filename :o̓t@C
+	* @return bool         :otrue
+	*/
+	bool write_exr(const std::string& _filename) const;
+
+	/**
+	* @brief jARadiance HDR(RGBE)摜o֐
+	* @param[in] _filename :o̓t@C
+	* @return bool         :otrue
+	*/
+	bool write_hdr(const std::string& _filename) const;
+
+	/**
+	* @brief U_O̕摜(ˋPxƃsNZƂ̏d)o֐
+	* @param[in] _filename :o̓t@C
+	* @return bool         :otrue
+	* @note d݂0̃sNZ͂̃vZXSĂȂƂ\
+	*/
+	bool write_partial(const std::string& _filename) const;
 
 private:
 	int w;         /**<            */
@@ -31,4 +119,19 @@ private:
 	int c;         /**< `l */
 	float aspect;  /**< AXyNg */
 	std::string filename; /**< o̓t@C */
+	std::vector<float> pixels;           /**< jARGB̕ˋPx(̍s珇Ɋi[) */
+	std::vector<float> weights;          /**< sNZƂ̏d(Tv)            */
+	float exposure = 0.f;                /**< Io␳l[EV]                            */
+	bool is_gamma_correction = true;     /**< o͎sRGB̃K}␳s          */
 };
+
+
+/**
+* @brief U_O̕摜dݕtςŌ֐
+* @param[in] part_filenames :摜̃t@C
+* @param[in] filename       :摜̏o̓t@C
+* @return std::shared_ptr<Film> :tB(ǂݍ߂ȂE傫قȂꍇnullptr)
+* @note sNZƂɕˋPxd(Tv)ŉdςCd݂͍v
+*/
+std::shared_ptr<Film> merge_partial_films(const std::vector<std::string>& part_filenames,
+	const std::string& filename);
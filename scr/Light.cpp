@@ -32,11 +32,16 @@ Vec3 ParallelLight::evel_light(const Vec3& w) const {
 }
 
 Vec3 ParallelLight::power() const {
-    float radius = 100; // V[a()
-    return pi * radius * radius * intensity;
+    return pi * scene_radius * scene_radius * intensity;
 }
 
-Vec3 ParallelLight::sample_light(const intersection& ref, Vec3& wi, float& pdf) const {
+void ParallelLight::preprocess(const AABB& scene_bounds) {
+    if (!scene_bounds.is_empty()) {
+        scene_radius = 0.5f * scene_bounds.get_diagonal().length();
+    }
+}
+
+Vec3 ParallelLight::sample_light(const intersection& ref, Vec3& wi, float& pdf, const Vec2& u) const {
     wi = wi_light; // ̕\ʂ痣(Ɍ)
     pdf = 1.0f; // f^֐̃TvOȂ̂PDF1
     return intensity;
@@ -81,8 +86,8 @@ Vec3 AreaLight::power() const {
     return intensity * area * 4 * pi;
 }
 
-Vec3 AreaLight::sample_light(const intersection& ref, Vec3& wi, float& pdf) const {
-    auto isect = shape->sample(ref); // ̃TvO_
+Vec3 AreaLight::sample_light(const intersection& ref, Vec3& wi, float& pdf, const Vec2& u) const {
+    auto isect = shape->sample(ref, u); // ̃TvO_
     wi = unit_vector(isect.pos - ref.pos); // Ɍ
     pdf = shape->eval_pdf(ref, wi);
     return evel_light(wi);
@@ -96,6 +101,25 @@ bool AreaLight::intersect(const Ray& r, float t_min, float t_max, intersection&
     return shape->intersect(r, t_min, t_max, p);
 }
 
+bool AreaLight::intersect_hit(const Ray& r, float t_min, float t_max, HitRecord& hit) const {
+    return shape->intersect_hit(r, t_min, t_max, hit);
+}
+
+AABB AreaLight::get_bounds() const {
+    return shape->get_bounds();
+}
+
+bool AreaLight::get_light_bounds(LightBounds& bounds) const {
+    bounds.bounds = shape->get_bounds();
+    bounds.phi = luminance(power());
+    // \ʂ̖@̉~\̔֕˂
+    auto cone = shape->get_normal_cone();
+    bounds.w = cone.w;
+    bounds.cos_theta_o = cone.cos_theta;
+    bounds.cos_theta_e = 0.f; // cos(pi/2)
+    return true;
+}
+
 
 // *** (IBL) ***
 
@@ -131,7 +155,7 @@ EnvironmentLight::EnvironmentLight(const std::string& filename, float rotation)
             }
         }
         luminance /= (nw * nh);
-        dist = std::make_unique<Piecewise2D>(luminance_map.get(), nw, nh);
+        dist = std::make_unique<AliasPiecewise2D>(luminance_map.get(), nw, nh);
     }
     else {
         std::cerr << "Failed to load" << filename << '\n';
@@ -144,7 +168,7 @@ EnvironmentLight::EnvironmentLight(const std::string& filename, float rotation)
         int nsample = 1e6;
         for (int i = 0; i < nsample; i++) {
             float pdf;
-            Vec2 uv = dist->sample(pdf);
+            Vec2 uv = dist->sample(Vec2(Random::uniform_float(), Random::uniform_float()), pdf);
             int w = std::clamp(int(uv[0] * nw), 0, nw - 1);
             int h = std::clamp(int(uv[1] * nh), 0, nh - 1);
             int index = h * nw * 3 + w * 3;
@@ -186,7 +210,7 @@ EnvironmentLight::EnvironmentLight(const Vec3& intensity)
             }
         }
         luminance /= (nw * nh);
-        dist = std::make_unique<Piecewise2D>(luminance_map.get(), nw, nh);
+        dist = std::make_unique<AliasPiecewise2D>(luminance_map.get(), nw, nh);
     }
 }
 
@@ -194,37 +218,36 @@ Vec3 EnvironmentLight::evel_light(const Vec3& w) const {
     if (envmap == nullptr) {
         return Vec3(0.f, 0.f, 0.f);
     }
-    // uvWvZ
-    Vec3 dir = unit_vector(w);
-    float u = std::atan2(dir.get_z(), dir.get_x()) + pi; // pỉZ͉EWnl
-    u *= invpi * 0.5;
-    float v = std::acos(std::clamp(dir.get_y(), -1.0f, 1.0f)) * invpi;
-    // }bvˋPxTvO
-    return evel_light_uv(Vec2(u, v));
+    // uvWvZĊ}bvˋPxTvO
+    return evel_light_uv(direction_to_equirect(w));
 }
 
 Vec3 EnvironmentLight::power() const {
-    float radius = 100;
-    return pi * radius * radius * luminance;
+    // NOTE: luminance̓XJ[Ȃ̂őS`lɓlݒ
+    return Vec3::one * (pi * scene_radius * scene_radius * luminance);
 }
 
-Vec3 EnvironmentLight::sample_light(const intersection& ref, Vec3& wi, float& pdf) const {
+void EnvironmentLight::preprocess(const AABB& scene_bounds) {
+    if (!scene_bounds.is_empty()) {
+        scene_radius = 0.5f * scene_bounds.get_diagonal().length();
+    }
+}
+
+Vec3 EnvironmentLight::sample_light(const intersection& ref, Vec3& wi, float& pdf, const Vec2& u) const {
     if (envmap == nullptr) {
         return Vec3(0.f, 0.f, 0.f);
     }
     // uvWTvO
     float sample_pdf;
-    Vec2 uv = dist->sample(sample_pdf);
+    Vec2 uv = dist->sample(u, sample_pdf);
     if (sample_pdf == 0) return Vec3::zero;
     // uvWvZ
-    float phi = 2 * pi * uv[0] + pi; // pỉZ͉EWnl
-    float theta = pi * uv[1];
-    float sin_theta = std::sin(theta);
-    if (sin_theta == 0) {
+    float sin_theta;
+    wi = equirect_to_direction_exact(uv, sin_theta);
+    if (sin_theta <= 0) {
         pdf = 0.f;
         return Vec3::zero;
     }
-    wi = Vec3(sin_theta * std::cos(phi), std::cos(theta), sin_theta * std::sin(phi));
     // TvOmxƕˋPx]
     pdf = sample_pdf / (2 * pi * pi * sin_theta);
     return evel_light_uv(uv);
@@ -234,12 +257,10 @@ float EnvironmentLight::eval_pdf(const intersection& ref, const Vec3& w) const {
     if (envmap == nullptr) {
         return 0.f;
     }
-    float theta = std::acos(w.get_y());
-    float phi = std::atan2f(w.get_z(), w.get_x()) + pi; // pỉZ͉EWnl
-    if (phi < 0) phi += 2 * pi;
-    float sin_theta = std::sin(theta);
+    // sin(acos(y)) = sqrt(1 - y^2)
+    float sin_theta = std::sqrt(std::max(0.f, 1.0f - w.get_y() * w.get_y() / w.length2()));
     if (sin_theta == 0) return 0;
-    return dist->eval_pdf(Vec2(0.5f * phi * invpi, theta * invpi)) / (2 * pi * pi * sin_theta);
+    return dist->eval_pdf(direction_to_equirect(w)) / (2 * pi * pi * sin_theta);
 }
 
 bool EnvironmentLight::intersect(const Ray& r, float t_min, float t_max, intersection& p) const {
@@ -304,4 +325,44 @@ void EnvironmentLight::rotate_envmap(float deg) {
         }
     }
     delete[] envmap_copy;
+}
+
+
+std::vector<std::shared_ptr<Light>> create_area_lights(const Vec3& intensity,
+    const TriangleMesh& mesh) {
+    std::vector<std::shared_ptr<Light>> lights;
+    for (int i = 0; i < mesh.get_num_triangles(); i++) {
+        lights.push_back(std::make_shared<AreaLight>(intensity, std::make_shared<Triangle>(mesh.get_triangle(i))));
+    }
+    return lights;
+}
+
+
+// *** }bv̍Wϊ ***
+
+Vec2 direction_to_equirect(const Vec3& w) {
+    float u = (fast_atan2(w.get_z(), w.get_x()) + pi) * (0.5f * invpi); // pỉZ͉EWnl
+    float v = fast_acos(w.get_y() / w.length()) * invpi;
+    return Vec2(u, v);
+}
+
+Vec2 direction_to_equirect_exact(const Vec3& w) {
+    float u = (std::atan2(w.get_z(), w.get_x()) + pi) * (0.5f * invpi);
+    float v = std::acos(std::clamp(w.get_y() / w.length(), -1.0f, 1.0f)) * invpi;
+    return Vec2(u, v);
+}
+
+Vec3 equirect_to_direction(const Vec2& uv, float& sin_theta) {
+    // phi = 2pi*u + piȂ̂ŐƗ]2pi*û̂̕𔽓]
+    float sin_phi, cos_phi, cos_theta;
+    fast_sincos(2 * pi * uv[0], sin_phi, cos_phi);
+    fast_sincos(pi * uv[1], sin_theta, cos_theta);
+    return Vec3(-sin_theta * cos_phi, cos_theta, -sin_theta * sin_phi);
+}
+
+Vec3 equirect_to_direction_exact(const Vec2& uv, float& sin_theta) {
+    float phi = 2 * pi * uv[0] + pi;
+    float theta = pi * uv[1];
+    sin_theta = std::sin(theta);
+    return Vec3(sin_theta * std::cos(phi), std::cos(theta), sin_theta * std::sin(phi));
 }
\ No newline at end of file
@@ -7,10 +7,13 @@
 
 #pragma once
 
+#include "AABB.h"
 #include "Ray.h"
 
 struct intersection;
-class Piecewise2D;
+struct HitRecord;
+struct LightBounds;
+class AliasPiecewise2D;
 class Scene;
 class Shape;
 
@@ -50,9 +53,11 @@ public:
     * @param[in]  ref :TvǑ_
     * @param[out] wi  :[hWnł̌ւ̓˕(֌)
     * @param[out] pdf :TvOmx(̊px)
+    * @param[in]  u   :[0, 1)^2̈lȃTv
     * @return Vec3    :ˋPx̕]l
     */
-    virtual Vec3 sample_light(const intersection& ref, Vec3& wi, float& pdf) const = 0;
+    virtual Vec3 sample_light(const intersection& ref, Vec3& wi, float& pdf,
+                              const Vec2& u) const = 0;
 
     /**
     * @brief ˕TvO̊mx]֐
@@ -73,6 +78,37 @@ public:
     */
     virtual bool intersect(const Ray& r, float t_min, float t_max, intersection& p) const = 0;
 
+    /**
+    * @brief E̃VFCvƃČs֐
+    * @param[in]  r     :˃C
+    * @param[in]  t_min :˃C̃p[^
+    * @param[in]  t_max :˃C̃p[^
+    * @param[out] hit   :̋L^(Ȃꍇ͕ύXȂ)
+    * @return bool      :̌(Ȃtrue)
+    * @note ̓V[̌ŕʂɈ̂ŏfalse
+    */
+    virtual bool intersect_hit(const Ray& r, float t_min, float t_max, HitRecord& hit) const { return false; }
+
+    /**
+    * @brief ̃[hWnł̋E{bNX擾֐
+    * @return AABB :E{bNX(̏ꍇ͋)
+    */
+    virtual AABB get_bounds() const { return AABB(); }
+
+    /**
+    * @brief V[̍\zɌO֐
+    * @param[in] scene_bounds :V[Ŝ̋E{bNX
+    * @note ̓V[̑傫˃GlM[ς
+    */
+    virtual void preprocess(const AABB& scene_bounds) {}
+
+    /**
+    * @brief IBVHɎg̋E擾֐
+    * @param[out] bounds :ʒuE˕E˃GlM[̋E
+    * @return bool       :EȂtrue(false)
+    */
+    virtual bool get_light_bounds(LightBounds& bounds) const { return false; }
+
     /**
     * @brief ̌_̉s֐
     * @param[in]  p1    :_1
@@ -110,7 +146,9 @@ public:
 
     Vec3 power() const override;
 
-    Vec3 sample_light(const intersection& ref, Vec3& wi, float& pdf) const override;
+    void preprocess(const AABB& scene_bounds) override;
+
+    Vec3 sample_light(const intersection& ref, Vec3& wi, float& pdf, const Vec2& u) const override;
 
     float eval_pdf(const intersection& ref, const Vec3& wi) const override;
 
@@ -119,6 +157,7 @@ public:
 private:
     Vec3 intensity; /**< ̕ˋPx  */
     Vec3 wi_light;  /**< ̓˕([hWn) */
+    float scene_radius=100.f; /**< V[̋E̔a */
 };
 
 
@@ -136,12 +175,18 @@ public:
 
     Vec3 power() const override;
 
-    Vec3 sample_light(const intersection& ref, Vec3& wi, float& pdf) const override;
+    Vec3 sample_light(const intersection& ref, Vec3& wi, float& pdf, const Vec2& u) const override;
 
     float eval_pdf(const intersection& ref, const Vec3& wi) const override;
 
     bool intersect(const Ray& r, float t_min, float t_max, intersection& p) const override;
 
+    bool intersect_hit(const Ray& r, float t_min, float t_max, HitRecord& hit) const override;
+
+    AABB get_bounds() const override;
+
+    bool get_light_bounds(LightBounds& bounds) const override;
+
 private:
     Vec3 intensity;               /**< ̕ˋPx   */
     std::shared_ptr<Shape> shape; /**< ʌ̃VFCv */
@@ -169,7 +214,9 @@ public:
 
     Vec3 power() const override;
 
-    Vec3 sample_light(const intersection& ref, Vec3& wi, float& pdf) const override;
+    void preprocess(const AABB& scene_bounds) override;
+
+    Vec3 sample_light(const intersection& ref, Vec3& wi, float& pdf, const Vec2& u) const override;
 
     float eval_pdf(const intersection& ref, const Vec3& wi) const override;
 
@@ -201,6 +248,53 @@ private:
     int nh;           /**<          */
     int nc;           /**< `l */
     float luminance;  /**< 邳       */
-    std::unique_ptr<float[]> envmap;   /**< }bv */
-    std::unique_ptr<Piecewise2D> dist; /**< Pxz   */
-};
\ No newline at end of file
+    float scene_radius=100.f; /**< V[̋E̔a */
+    std::unique_ptr<float[]> envmap;        /**< }bv */
+    std::unique_ptr<AliasPiecewise2D> dist; /**< Pxz   */
+};
+
+
+/**
+* @brief Op`bV̊eOp`ʌƂ֐
+* @param[in] intensity :̕ˋPx
+* @param[in] mesh      :Op`bV
+* @return std::vector<std::shared_ptr<Light>> :Op`Ƃ̖ʌ
+* @note ʂ̎Op`ȂꍇCIBVHŎOp`Pʂɏd_ITvOł
+*/
+std::vector<std::shared_ptr<Light>> create_area_lights(const Vec3& intensity,
+    const class TriangleMesh& mesh);
+
+
+/**
+* @brief }bv(~}@)uvWɕϊ֐
+* @param[in] w :(KȂĂ悢)
+* @return Vec2 :uvW
+* @note ߎ̋tOp֐g(uv̌덷1e-6xŁC2K̃eNZ1/500ȉ)
+*/
+Vec2 direction_to_equirect(const Vec3& w);
+
+/**
+* @brief }bvuvWɕWCűtOp֐ŕϊ֐
+* @param[in] w :(KȂĂ悢)
+* @return Vec2 :uvW
+* @note direction_to_equirect̐x̌ؗp
+*/
+Vec2 direction_to_equirect_exact(const Vec3& w);
+
+/**
+* @brief }bvuvWɕϊ֐
+* @param[in]  uv        :uvW
+* @param[out] sin_theta :Ɋp̐(TvOmx̕ϊɎg)
+* @return Vec3          :PʕxNg
+* @note ߎ̎Op֐g(WCusin/cos葬ȂȂ̂Ńx`}[Nł̔rp)
+*/
+Vec3 equirect_to_direction(const Vec2& uv, float& sin_theta);
+
+/**
+* @brief }bvuvWWCu̎Op֐ŕɕϊ֐
+* @param[in]  uv        :uvW
+* @param[out] sin_theta :Ɋp̐(TvOmx̕ϊɎg)
+* @return Vec3          :PʕxNg
+* @note EnvironmentLight::sample_lightŎg
+*/
+Vec3 equirect_to_direction_exact(const Vec2& uv, float& sin_theta);
\ No newline at end of file
@@ -0,0 +1,325 @@
+#include "LightSampler.h"
+#include <algorithm>
+#include "Light.h"
+#include "Shape.h"
+
+
+// *** lȌI ***
+
+UniformLightSampler::UniformLightSampler(const std::vector<std::shared_ptr<Light>>& _lights) {
+    for (const auto& light : _lights) {
+        lights.push_back(light.get());
+    }
+}
+
+const Light* UniformLightSampler::sample(const intersection& ref, float u, float& pmf) const {
+    int n = (int)lights.size();
+    if (n == 0) {
+        pmf = 0.f;
+        return nullptr;
+    }
+    int index = std::min((int)(u * n), n - 1);
+    pmf = 1.0f / n;
+    return lights[index];
+}
+
+float UniformLightSampler::eval_pmf(const intersection& ref, const Light* light) const {
+    return lights.empty() ? 0.f : 1.0f / lights.size();
+}
+
+
+// *** ˃GlM[ɔႵI ***
+
+PowerLightSampler::PowerLightSampler(const std::vector<std::shared_ptr<Light>>& _lights) {
+    std::vector<float> weights;
+    for (const auto& light : _lights) {
+        light_index[light.get()] = (int)lights.size();
+        lights.push_back(light.get());
+        weights.push_back(std::max(luminance(light->power()), 0.f));
+    }
+    table = AliasTable(weights);
+}
+
+const Light* PowerLightSampler::sample(const intersection& ref, float u, float& pmf) const {
+    if (table.is_empty()) {
+        pmf = 0.f;
+        return nullptr;
+    }
+    return lights[table.sample(u, pmf)];
+}
+
+float PowerLightSampler::eval_pmf(const intersection& ref, const Light* light) const {
+    auto iter = light_index.find(light);
+    if (iter == light_index.end()) {
+        return 0.f;
+    }
+    return table.get_pmf(iter->second);
+}
+
+
+// *** ̋E ***
+
+/**
+* @brief px̗̍]vZ֐
+* @param[in] sin_a :pxa̐
+* @param[in] cos_a :pxa̗]
+* @param[in] sin_b :pxb̐
+* @param[in] cos_b :pxb̗]
+* @return float    :max(a - b, 0)̗]
+*/
+static float cos_sub_clamped(float sin_a, float cos_a, float sin_b, float cos_b) {
+    if (cos_a > cos_b) return 1.0f;
+    return cos_a * cos_b + sin_a * sin_b;
+}
+
+/**
+* @brief px̍̐vZ֐
+* @param[in] sin_a :pxa̐
+* @param[in] cos_a :pxa̗]
+* @param[in] sin_b :pxb̐
+* @param[in] cos_b :pxb̗]
+* @return float    :max(a - b, 0)̐
+*/
+static float sin_sub_clamped(float sin_a, float cos_a, float sin_b, float cos_b) {
+    if (cos_a > cos_b) return 0.f;
+    return sin_a * cos_b - cos_a * sin_b;
+}
+
+/**
+* @brief ]琳vZ֐
+* @param[in] cos_theta :]
+* @return float        :
+*/
+static float sin_from_cos(float cos_theta) {
+    return std::sqrt(std::max(0.f, 1.0f - cos_theta * cos_theta));
+}
+
+float LightBounds::importance(const Vec3& p, const Vec3& n) const {
+    // _狫E܂ł̋(Ȇ傫ŉ݂)
+    auto pc = bounds.get_centroid();
+    float d2 = (p - pc).length2();
+    d2 = std::max(d2, bounds.get_diagonal().length() / 2);
+    auto wi = unit_vector(p - pc);
+    float cos_theta_w = dot(w, wi);
+    if (is_two_sided) cos_theta_w = std::abs(cos_theta_w);
+    float sin_theta_w = sin_from_cos(cos_theta_w);
+    // _猩E̔p
+    float cos_theta_b = -1.0f;
+    auto pmin = bounds.get_min();
+    auto pmax = bounds.get_max();
+    bool is_inside = true;
+    for (int i = 0; i < 3; i++) {
+        is_inside &= (p[i] >= pmin[i] && p[i] <= pmax[i]);
+    }
+    float dist2 = (p - pc).length2();
+    float radius2 = (pmax - pc).length2();
+    if (!is_inside && dist2 > radius2) {
+        cos_theta_b = std::sqrt(std::max(0.f, 1.0f - radius2 / dist2));
+    }
+    float sin_theta_b = sin_from_cos(cos_theta_b);
+    // ˕̉~ƌ_̍̕ŏ̊px
+    float cos_theta_x = cos_sub_clamped(sin_theta_w, cos_theta_w, sin_from_cos(cos_theta_o), cos_theta_o);
+    float sin_theta_x = sin_sub_clamped(sin_theta_w, cos_theta_w, sin_from_cos(cos_theta_o), cos_theta_o);
+    float cos_theta_p = cos_sub_clamped(sin_theta_x, cos_theta_x, sin_theta_b, cos_theta_b);
+    if (cos_theta_p <= cos_theta_e) {
+        return 0.f;
+    }
+    float importance = phi * cos_theta_p / d2;
+    // _̖@ƌ̍̕ŏ̊px
+    if (n.length2() > 0) {
+        float cos_theta_i = std::abs(dot(wi, n));
+        float sin_theta_i = sin_from_cos(cos_theta_i);
+        importance *= cos_sub_clamped(sin_theta_i, cos_theta_i, sin_theta_b, cos_theta_b);
+    }
+    return std::max(importance, 0.f);
+}
+
+LightBounds merge(const LightBounds& a, const LightBounds& b) {
+    if (a.phi == 0) return b;
+    if (b.phi == 0) return a;
+    auto cone = merge(DirectionCone(a.w, a.cos_theta_o), DirectionCone(b.w, b.cos_theta_o));
+    LightBounds lb;
+    lb.bounds = merge(a.bounds, b.bounds);
+    lb.w = cone.w;
+    lb.phi = a.phi + b.phi;
+    lb.cos_theta_o = cone.cos_theta;
+    lb.cos_theta_e = std::min(a.cos_theta_e, b.cos_theta_e);
+    lb.is_two_sided = a.is_two_sided || b.is_two_sided;
+    return lb;
+}
+
+
+// *** BVHɂI ***
+
+BVHLightSampler::BVHLightSampler(const std::vector<std::shared_ptr<Light>>& _lights) {
+    std::vector<AABB> prim_bounds;
+    for (const auto& light : _lights) {
+        LightBounds lb;
+        if (!light->get_light_bounds(lb)) {
+            light_index[light.get()] = -1;
+            infinite_lights.push_back(light.get());
+        }
+        else if (lb.phi > 0) {
+            light_index[light.get()] = (int)lights.size();
+            lights.push_back(light.get());
+            light_bounds.push_back(lb);
+            prim_bounds.push_back(lb.bounds);
+        }
+    }
+    if (lights.empty()) {
+        return;
+    }
+    // tƂɌi[Ċem[ȟ̋EvZ
+    bvh = BVH(prim_bounds, 1, BVHSplit::SAH);
+    node_bounds.resize(bvh.get_num_nodes());
+    light_trail.resize(lights.size());
+    light_depth.resize(lights.size());
+    build_bounds(0, 0, 0);
+}
+
+LightBounds BVHLightSampler::build_bounds(int node_index, uint64_t trail, int depth) {
+    const auto& node = bvh.get_nodes()[node_index];
+    LightBounds lb;
+    if (node.nprims > 0) {
+        for (int i = 0; i < node.nprims; i++) {
+            int index = bvh.get_prim_index(node.offset + i);
+            light_trail[index] = trail;
+            light_depth[index] = depth;
+            lb = merge(lb, light_bounds[index]);
+        }
+    }
+    else {
+        // 1Ԗڂ̎q0C2Ԗڂ̎q1ƂČoHL^
+        auto lb0 = build_bounds(node_index + 1, trail, depth + 1);
+        auto lb1 = build_bounds(node.offset, trail | (1ULL << depth), depth + 1);
+        lb = merge(lb0, lb1);
+    }
+    node_bounds[node_index] = lb;
+    return lb;
+}
+
+int BVHLightSampler::sample_bvh(const Vec3& p, const Vec3& n, float u, float& pmf) const {
+    const auto& nodes = bvh.get_nodes();
+    int current = 0;
+    pmf = 1.0f;
+    while (true) {
+        const auto& node = nodes[current];
+        // tȂdvxɔႵđI
+        if (node.nprims > 0) {
+            float total = 0.f;
+            for (int i = 0; i < node.nprims; i++) {
+                total += light_bounds[bvh.get_prim_index(node.offset + i)].importance(p, n);
+            }
+            if (total == 0) {
+                break;
+            }
+            float target = u * total;
+            for (int i = 0; i < node.nprims; i++) {
+                int index = bvh.get_prim_index(node.offset + i);
+                float imp = light_bounds[index].importance(p, n);
+                if (target < imp || i == node.nprims - 1) {
+                    pmf *= imp / total;
+                    return imp > 0 ? index : -1;
+                }
+                target -= imp;
+            }
+        }
+        // ߂ȂqdvxɔႵđI
+        float c0 = node_bounds[current + 1].importance(p, n);
+        float c1 = node_bounds[node.offset].importance(p, n);
+        if (c0 == 0 && c1 == 0) {
+            break;
+        }
+        float p0 = c0 / (c0 + c1);
+        if (u < p0) {
+            current = current + 1;
+            u = std::min(u / p0, one_minus_epsilon);
+            pmf *= p0;
+        }
+        else {
+            current = node.offset;
+            u = std::min((u - p0) / (1 - p0), one_minus_epsilon);
+            pmf *= 1 - p0;
+        }
+    }
+    pmf = 0.f;
+    return -1;
+}
+
+const Light* BVHLightSampler::sample(const intersection& ref, float u, float& pmf) const {
+    // EȂBVHŜ𓙊mň
+    int num_inf = (int)infinite_lights.size();
+    float p_inf = (float)num_inf / (num_inf + (lights.empty() ? 0 : 1));
+    if (u < p_inf) {
+        int index = std::min((int)(u / p_inf * num_inf), num_inf - 1);
+        pmf = p_inf / num_inf;
+        return infinite_lights[index];
+    }
+    if (lights.empty()) {
+        pmf = 0.f;
+        return nullptr;
+    }
+    u = std::min((u - p_inf) / (1 - p_inf), one_minus_epsilon);
+    int index = sample_bvh(ref.pos, ref.normal, u, pmf);
+    if (index < 0) {
+        pmf = 0.f;
+        return nullptr;
+    }
+    pmf *= 1 - p_inf;
+    return lights[index];
+}
+
+float BVHLightSampler::eval_pmf(const intersection& ref, const Light* light) const {
+    auto iter = light_index.find(light);
+    if (iter == light_index.end()) {
+        return 0.f;
+    }
+    int num_inf = (int)infinite_lights.size();
+    float p_inf = (float)num_inf / (num_inf + (lights.empty() ? 0 : 1));
+    if (iter->second < 0) {
+        return p_inf / num_inf;
+    }
+    // ̗t܂ł̌oHHđIm|킹
+    const auto& p = ref.pos;
+    const auto& n = ref.normal;
+    const auto& nodes = bvh.get_nodes();
+    int index = iter->second;
+    uint64_t trail = light_trail[index];
+    float pmf = 1 - p_inf;
+    int current = 0;
+    for (int depth = 0; depth < light_depth[index]; depth++) {
+        const auto& node = nodes[current];
+        float c0 = node_bounds[current + 1].importance(p, n);
+        float c1 = node_bounds[node.offset].importance(p, n);
+        if (c0 == 0 && c1 == 0) {
+            return 0.f;
+        }
+        bool is_second = (trail >> depth) & 1;
+        pmf *= (is_second ? c1 : c0) / (c0 + c1);
+        current = is_second ? node.offset : current + 1;
+    }
+    // t̒ł̑Im
+    const auto& node = nodes[current];
+    float total = 0.f;
+    for (int i = 0; i < node.nprims; i++) {
+        total += light_bounds[bvh.get_prim_index(node.offset + i)].importance(p, n);
+    }
+    if (total == 0) {
+        return 0.f;
+    }
+    return pmf * light_bounds[index].importance(p, n) / total;
+}
+
+
+std::shared_ptr<LightSampler> create_light_sampler(LightSamplerType type,
+    const std::vector<std::shared_ptr<Light>>& lights) {
+    switch (type) {
+    case LightSamplerType::Uniform:
+        return std::make_shared<UniformLightSampler>(lights);
+    case LightSamplerType::Power:
+        return std::make_shared<PowerLightSampler>(lights);
+    case LightSamplerType::BVH:
+    default:
+        return std::make_shared<BVHLightSampler>(lights);
+    }
+}
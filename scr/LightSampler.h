@@ -0,0 +1,172 @@
+/**
+* @file  LightSampler.h
+* @brief ڌ̃TvOŌIԐ헪
+* @note  Im(PMF)͑dd_ITvȌd݂ɂĝŁCsampleeval_pmf͈v
+*/
+
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "AABB.h"
+#include "BVH.h"
+#include "Random.h"
+
+struct intersection;
+class Light;
+
+/** ̑I헪̎ */
+enum class LightSamplerType {
+    Uniform = 1 << 0,  /**< lɑI                 */
+    Power   = 1 << 1,  /**< ˃GlM[ɔႵđI */
+    BVH     = 1 << 2,  /**< BVHŌ_ƂɑI  */
+};
+
+
+/**
+* @brief ̋ԓIEIȍL̋E
+* @note Ql: https://pbr-book.org/4ed/Light_Sources/Light_Sampling
+*/
+struct LightBounds {
+    AABB bounds;             /**< ̋E{bNX                 */
+    Vec3 w;                  /**< ˕̉~̎                 */
+    float phi=0.f;           /**< ˃GlM[(Px)               */
+    float cos_theta_o=1.0f;  /**< \ʂ̖@̉~̔p̗]     */
+    float cos_theta_e=0.f;   /**< @̕˂̍L̗]       */
+    bool is_two_sided=false; /**< ʂ˂邩                 */
+
+    /**
+    * @brief _猩Q̏dvxvZ֐
+    * @param[in] p  :_̍W
+    * @param[in] n  :_̖@([xNgȂ@̍𖳎)
+    * @return float :dvx(^̏E̋ߎ)
+    */
+    float importance(const Vec3& p, const Vec3& n) const;
+};
+
+/**
+* @brief 2̌̋E܂ދEvZ֐
+* @param[in] a :̋E1
+* @param[in] b :̋E2
+* @return LightBounds :2܂ދE
+*/
+LightBounds merge(const LightBounds& a, const LightBounds& b);
+
+
+/** I̒ۃNX */
+class LightSampler {
+public:
+    virtual ~LightSampler() {};
+
+    /**
+    * @brief _猩ČIԊ֐
+    * @param[in]  ref :TvǑ_
+    * @param[in]  u   :[0, 1)̈lȃTv
+    * @param[out] pmf :I񂾌̊m
+    * @return const Light* :I񂾌(Ȃnullptr)
+    */
+    virtual const Light* sample(const intersection& ref, float u, float& pmf) const = 0;
+
+    /**
+    * @brief _猩ČI΂mʂ]֐
+    * @param[in] ref   :TvǑ_
+    * @param[in] light :
+    * @return float    :m
+    */
+    virtual float eval_pmf(const intersection& ref, const Light* light) const = 0;
+};
+
+
+/** lɑIԃNX */
+class UniformLightSampler : public LightSampler {
+public:
+    /**
+    * @brief RXgN^
+    * @param[in] _lights :V[̌
+    */
+    UniformLightSampler(const std::vector<std::shared_ptr<Light>>& _lights);
+
+    const Light* sample(const intersection& ref, float u, float& pmf) const override;
+    float eval_pmf(const intersection& ref, const Light* light) const override;
+
+private:
+    std::vector<const Light*> lights; /**< V[̌ */
+};
+
+
+/** ˃GlM[ɔႵđIԃNX */
+class PowerLightSampler : public LightSampler {
+public:
+    /**
+    * @brief RXgN^
+    * @param[in] _lights :V[̌
+    * @note ˃GlM[̋PxGCAXe[u\z
+    */
+    PowerLightSampler(const std::vector<std::shared_ptr<Light>>& _lights);
+
+    const Light* sample(const intersection& ref, float u, float& pmf) const override;
+    float eval_pmf(const intersection& ref, const Light* light) const override;
+
+private:
+    std::vector<const Light*> lights;                  /**< V[̌       */
+    AliasTable table;                                  /**< Im̃e[u   */
+    std::unordered_map<const Light*, int> light_index; /**< z̈ʒu */
+};
+
+
+/**
+* @brief BVH_猩dvxɏ]ĒHIԃNX
+* @note EȂ(s)BVHƂ͕ʂɈlɑI
+* @note Ql: [Conty Estevez and Kulla 2018] "Importance Sampling of Many Lights with Adaptive Tree Splitting"
+*/
+class BVHLightSampler : public LightSampler {
+public:
+    /**
+    * @brief RXgN^
+    * @param[in] _lights :V[̌
+    */
+    BVHLightSampler(const std::vector<std::shared_ptr<Light>>& _lights);
+
+    const Light* sample(const intersection& ref, float u, float& pmf) const override;
+    float eval_pmf(const intersection& ref, const Light* light) const override;
+
+private:
+    /**
+    * @brief ؂̌̋EtċAIɌvZ֐
+    * @param[in] node_index :m[ḧʒu
+    * @param[in] trail      :m[hւ̌oH(rbg)
+    * @param[in] depth      :m[h̐[
+    * @return LightBounds   :؂̌̋E
+    */
+    LightBounds build_bounds(int node_index, uint64_t trail, int depth);
+
+    /**
+    * @brief BVHIԊ֐
+    * @param[in]  p   :_̍W
+    * @param[in]  n   :_̖@
+    * @param[in]  u   :[0, 1)̈lȃTv
+    * @param[out] pmf :I񂾌̊m
+    * @return int     :I񂾌̔ԍ(IׂȂ-1)
+    */
+    int sample_bvh(const Vec3& p, const Vec3& n, float u, float& pmf) const;
+
+    std::vector<const Light*> lights;                  /**< E             */
+    std::vector<LightBounds> light_bounds;             /**< Ƃ̋E             */
+    std::vector<const Light*> infinite_lights;         /**< EȂ         */
+    BVH bvh;                                           /**< ̋E{bNXBVH    */
+    std::vector<LightBounds> node_bounds;              /**< m[hƂ̌̋E     */
+    std::unordered_map<const Light*, int> light_index; /**< z̈ʒu       */
+    std::vector<uint64_t> light_trail;                 /**< ̗tւ̌oH     */
+    std::vector<int> light_depth;                      /**< ̗t̐[             */
+};
+
+
+/**
+* @brief w肵ނ̌I𐶐֐
+* @param[in] type   :I̎
+* @param[in] lights :V[̌
+* @return std::shared_ptr<LightSampler> :I
+*/
+std::shared_ptr<LightSampler> create_light_sampler(LightSamplerType type,
+    const std::vector<std::shared_ptr<Light>>& lights);
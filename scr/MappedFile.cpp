@@ -0,0 +1,59 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+bool MappedFile::open(const std::string& filename) {
+    close();
+#ifdef _WIN32
+    HANDLE h = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                           OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (h == INVALID_HANDLE_VALUE) return false;
+    file = h;
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(h, &file_size)) return false;
+    size = (size_t)file_size.QuadPart;
+    if (size == 0) return true;
+    mapping = CreateFileMappingA(h, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) return false;
+    data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    return data != nullptr;
+#else
+    fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) return false;
+    size = (size_t)st.st_size;
+    if (size == 0) return true;
+    void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) return false;
+    madvise(p, size, MADV_SEQUENTIAL);
+    data = (const char*)p;
+    return true;
+#endif
+}
+
+void MappedFile::close() {
+#ifdef _WIN32
+    if (data) UnmapViewOfFile(data);
+    if (mapping) CloseHandle(mapping);
+    if (file) CloseHandle(file);
+#else
+    if (data) munmap((void*)data, size);
+    if (fd >= 0) ::close(fd);
+#endif
+    data = nullptr;
+    size = 0;
+    file = nullptr;
+    mapping = nullptr;
+    fd = -1;
+}
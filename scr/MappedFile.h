@@ -0,0 +1,41 @@
+/**
+* @file  MappedFile.h
+* @brief ǂݍݐp̃}bvt@C
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/** ǂݍݐpŃ}bvt@CNX */
+class MappedFile {
+public:
+    MappedFile() {};
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+    * @brief t@C}bv֐
+    * @param[in] filename :t@C̃pX
+    * @return bool        :}bvłtrue(̃t@CƂ)
+    */
+    bool open(const std::string& filename);
+
+    /**
+    * @brief }bvăt@C֐
+    */
+    void close();
+
+    const char* get_data() const { return data; }
+    size_t get_size() const { return size; }
+
+private:
+    const char* data = nullptr;  /**< t@C̓e                          */
+    size_t size = 0;             /**< oCg                                */
+    void* file = nullptr;        /**< t@C̃nh(Windowŝ)         */
+    void* mapping = nullptr;     /**< }bṽnh(Windowŝ)           */
+    int fd = -1;                 /**< t@CLqq(WindowsȊO)            */
+};
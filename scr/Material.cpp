@@ -8,7 +8,8 @@
 // *** }eA ***
 
 Vec3 Material::sample_f(const Vec3& wo, const intersection& p, Vec3& wi, float& pdf,
-                        BxDFType& sampled_type, BxDFType acceptable_type) const {
+                        BxDFType& sampled_type, float u_bxdf, const Vec2& u,
+                        BxDFType acceptable_type) const {
     // e\BxDF̗vfJEg
     int num_acceptable_bxdfs = 0;
     for (const auto& bxdf : bxdf_list) {
@@ -20,7 +21,7 @@ Vec3 Material::sample_f(const Vec3& wo, const intersection& p, Vec3& wi, float&
     }
     // e\BxDF烉_ɃTvO
     // NOTE: bxdf_listɋes\BxDF܂܂Ăꍇ̂for[vŊmF
-    auto bxdf_count = Random::uniform_int(0, num_acceptable_bxdfs - 1); // e\BxDF̏
+    auto bxdf_count = std::min((int)(u_bxdf * num_acceptable_bxdfs), num_acceptable_bxdfs - 1); // e\BxDF̏
     auto bxdf_list_index = 0; // bxdf_listł̃TvOBxDF̃CfbNX
     for (const auto& bxdf : bxdf_list) {
         if (bxdf->is_same_type(acceptable_type)) {
@@ -31,7 +32,7 @@ Vec3 Material::sample_f(const Vec3& wo, const intersection& p, Vec3& wi, float&
     }
     const auto& sampled_bxdf = bxdf_list[bxdf_list_index];
     float sampled_pdf;
-    auto sampled_f = sampled_bxdf->sample_f(wo, p, wi, sampled_pdf);
+    auto sampled_f = sampled_bxdf->sample_f(wo, p, wi, sampled_pdf, u);
     sampled_type = sampled_bxdf->get_type();
     // ׂĂ̋e\BxDFlBSDFpdfvZ
     auto f = eval_f(wo, wi, p, acceptable_type);
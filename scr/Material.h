@@ -25,11 +25,14 @@ public:
     * @param[out] wi              :˕xNg([JW)
     * @param[out] pdf             :˕̃TvOmx(̊px)
     * @oaram[out] sampled_type    :TvOBxDF̎
+    * @param[in]  u_bxdf          :BxDF̑IɎg[0, 1)̈lȃTv
+    * @param[in]  u               :˕̃TvOɎg[0, 1)^2̈lȃTv
     * @oaram[in]  acceptable_type :TvO\BxDF̎
     * @return Vec3                :BRDF̕]l
     */
     Vec3 sample_f(const Vec3& wo, const intersection& p, Vec3& wi, float& pdf,
-                  BxDFType& sampled_type, BxDFType acceptable_type=BxDFType::All) const;
+                  BxDFType& sampled_type, float u_bxdf, const Vec2& u,
+                  BxDFType acceptable_type=BxDFType::All) const;
 
     /**
     * @brief BSDF]֐
@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include "utility.h"
@@ -14,6 +15,66 @@ inline float to_degree(float radian) { return 180.f * radian / pi; }
 inline float to_radian(float degree) { return pi * degree / 180.f; }
 inline float lerp(float a, float b, float t) { return (1 - t) * a + t * b; }
 
+/**
+* @brief atan2𑽍ŋߎ֐
+* @param[in] y  :yW
+* @param[in] x  :xW
+* @return float :Ίp[-pi, pi](ő덷͖2e-6rad)
+* @note ͑I𖽗߂ɂȂ̂Ń[vł̓xNgł
+*/
+inline float fast_atan2(float y, float x) {
+    float ax = std::abs(x);
+    float ay = std::abs(y);
+    float mx = std::max(ax, ay);
+    float a = mx > 0 ? std::min(ax, ay) / mx : 0.f;
+    // [0, 1]łatan̊֐̑ߎ
+    float s = a * a;
+    float r = (((((-0.01172120f * s + 0.05265332f) * s - 0.11643287f) * s + 0.19354346f) * s
+               - 0.33262347f) * s + 0.99997726f) * a;
+    r = ay > ax ? pi_half - r : r;
+    r = x < 0 ? pi - r : r;
+    return std::copysign(r, y);
+}
+
+/**
+* @brief acos𑽍ŋߎ֐
+* @param[in] x  :](͈͊O[-1, 1]ɐ)
+* @return float :px[0, pi](ő덷͖5e-7rad)
+* @note Ql: Abramowitz and Stegun. "Handbook of Mathematical Functions". 4.4.46
+*/
+inline float fast_acos(float x) {
+    float ax = std::min(std::abs(x), 1.0f);
+    float r = ((((((-0.0012624911f * ax + 0.0066700901f) * ax - 0.0170881256f) * ax + 0.0308918810f) * ax
+               - 0.0501743046f) * ax + 0.0889789874f) * ax - 0.2145988016f) * ax + 1.5707963050f;
+    r *= std::sqrt(1.0f - ax);
+    return x < 0 ? pi - r : r;
+}
+
+/**
+* @brief Ɨ]𑽍œɋߎ֐
+* @param[in]  x :px[rad]
+* @param[out] s :(|x|Sx܂ł͌덷͖1e-7)
+* @param[out] c :]
+* @note x = k*pi/2 + r (|r| <= pi/4)ɕȓŌvZ
+*/
+inline void fast_sincos(float x, float& s, float& c) {
+    // ł߂Ɋۂ߂(floor͊֐ĂяoɂȂꍇ̂ŐϊŐ؂̂Ă)
+    int q = (int)(x * (2 * invpi) + (x < 0 ? -0.5f : 0.5f));
+    float k = (float)q;
+    // pi/23ɕĈ(Cody-Waite@)
+    float r = ((x - k * 1.5703125f) - k * 4.837512969970703125e-4f) - k * 7.54978995489188216e-8f;
+    float r2 = r * r;
+    float sr = r + r * r2 * ((-1.9515295891e-4f * r2 + 8.3321608736e-3f) * r2 - 1.6666654611e-1f);
+    float cr = 1.0f - 0.5f * r2 + r2 * r2 * ((2.443315711809948e-5f * r2 - 1.388731625493765e-3f) * r2
+                                             + 4.166664568298827e-2f);
+    // یɉēւƕ]
+    q &= 3;
+    float ss = (q & 1) ? cr : sr;
+    float cc = (q & 1) ? sr : cr;
+    s = (q & 2) ? -ss : ss;
+    c = ((q + 1) & 2) ? -cc : cc;
+}
+
 
 /** OxNgNX */
 class Vec3 {
@@ -203,6 +264,26 @@ inline Vec3 clamp(const Vec3& a, float min=0.f, float max=1.0f) {
     return Vec3(x, y, z); 
 }
 
+/**
+* @brief e̍ŏlxNgvZ֐
+* @param[in]  a :xNg1
+* @param[in]  b :xNg2
+* @return Vec3  :e̍ŏl
+*/
+inline Vec3 min(const Vec3& a, const Vec3& b) {
+    return Vec3(std::min(a[0], b[0]), std::min(a[1], b[1]), std::min(a[2], b[2]));
+}
+
+/**
+* @brief e̍őlxNgvZ֐
+* @param[in]  a :xNg1
+* @param[in]  b :xNg2
+* @return Vec3  :e̍ől
+*/
+inline Vec3 max(const Vec3& a, const Vec3& b) {
+    return Vec3(std::max(a[0], b[0]), std::max(a[1], b[1]), std::max(a[2], b[2]));
+}
+
 /**
 * @brief ˃xNg̐˕xNgvZ֐
 * @param[in]  w :˃xNg
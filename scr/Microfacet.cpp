@@ -24,17 +24,17 @@ float Beckmann::lambda(const Vec3& w) const {
     return (1.0f - 1.259f * a + 0.396f * a * a) / (3.535f * a + 2.181f * a * a);
 }
 
-Vec3 Beckmann::sample_halfvector(const Vec3& wo) const {
-    return beckmann_sample(alpha);
+Vec3 Beckmann::sample_halfvector(const Vec3& wo, const Vec2& u) const {
+    return beckmann_sample(alpha, u);
 }
 
 float Beckmann::eval_pdf(const Vec3& h, const Vec3 & wo) const {
     return D(h) * std::abs(get_cos(h));
 }
 
-Vec3 Beckmann::beckmann_sample(float alpha) const {
-    auto u = Random::uniform_float();
-    auto v = Random::uniform_float();
+Vec3 Beckmann::beckmann_sample(float alpha, const Vec2& uv) const {
+    auto u = uv[0];
+    auto v = uv[1];
     auto logs = std::log(1.0f - u);
     if (std::isinf(logs)) logs = 0.f;
     auto tan2_theta = -alpha * alpha * logs;
@@ -68,11 +68,11 @@ float GGX::lambda(const Vec3& w) const {
     return 0.5f * (-1.0f + std::sqrt(1.0f + alpha * alpha * tan_theta * tan_theta));
 }
 
-Vec3 GGX::sample_halfvector(const Vec3& wo) const {
+Vec3 GGX::sample_halfvector(const Vec3& wo, const Vec2& u) const {
     if (is_visible_sampling) {
-        return visible_ggx_sample(wo, alpha);
+        return visible_ggx_sample(wo, alpha, u);
     }
-    return ggx_sample(alpha);
+    return ggx_sample(alpha, u);
 }
 
 float GGX::eval_pdf(const Vec3& h, const Vec3& wo) const {
@@ -82,9 +82,9 @@ float GGX::eval_pdf(const Vec3& h, const Vec3& wo) const {
     return D(h) * std::abs(get_cos(h));
 }
 
-Vec3 GGX::ggx_sample(float alpha) const {
-    auto u = Random::uniform_float();
-    auto v = Random::uniform_float();
+Vec3 GGX::ggx_sample(float alpha, const Vec2& uv) const {
+    auto u = uv[0];
+    auto v = uv[1];
     auto tan2_theta = alpha * alpha * u / (1.0f - u); // NOTE: atan2͒x̂Ŗgp
     auto cos2_theta = 1 / (1 + tan2_theta);
     auto sin2_theta = 1 - cos2_theta;
@@ -96,7 +96,7 @@ Vec3 GGX::ggx_sample(float alpha) const {
     return Vec3(x, y, z);
 }
 
-Vec3 GGX::visible_ggx_sample(const Vec3& wo, float alpha) const {
+Vec3 GGX::visible_ggx_sample(const Vec3& wo, float alpha, const Vec2& u) const {
     // ȉ~̂ł̏o˕𔼋ɕϊ
     Vec3 wo_hemi = unit_vector(Vec3(alpha * wo[0], alpha * wo[1], wo[2]));
     // K\z
@@ -107,7 +107,7 @@ Vec3 GGX::visible_ggx_sample(const Vec3& wo, float alpha) const {
     }
     Vec3 T2 = cross(wo_hemi, T1);
     // ł̖@TvO
-    Vec2 uv = Random::uniform_disk_sample();
+    Vec2 uv = Random::uniform_disk_sample(u);
     float s = 0.5f * (1.0f + wo_hemi[2]);
     float t1 = uv[0];
     float t2 = (1.0f - s) * std::sqrt(1.0f - t1 * t1) + s * uv[1];
@@ -8,6 +8,13 @@
 
 #include "Math.h"
 
+/** }CNt@Zbgz̎ */
+enum class NDFType {
+    Beckmann = 1 << 0,  /**< Beckmannz                */
+    GGX      = 1 << 1,  /**< Trowbridge-Reitz(GGX)z */
+};
+
+
 /** }CNt@ZbgzNX(Smithfp) */
 class NDF {
 public:
@@ -53,9 +60,10 @@ public:
     /**
     * @brief n[t̃TvOs֐
     * @param[in] wo :o˕xNg
+    * @param[in] u  :[0, 1)^2̈lȃTv
     * @return float :n[txNg
     */
-    virtual Vec3 sample_halfvector(const Vec3& wo) const = 0;
+    virtual Vec3 sample_halfvector(const Vec3& wo, const Vec2& u) const = 0;
 
     /**
     * @brief n[t̃TvOPDF(mx)]֐
@@ -65,7 +73,11 @@ public:
     */
     virtual float eval_pdf(const Vec3& h, const Vec3& wo) const = 0;
 
-    bool get_is_visible_sampling() { return is_visible_sampling; }
+    bool get_is_visible_sampling() const { return is_visible_sampling; }
+
+    virtual NDFType get_type() const = 0;
+
+    virtual float get_alpha() const = 0;
 
 protected:
     // note: _łTrowbridge-Reitz(GGX)zł̂ݗL
@@ -79,17 +91,20 @@ public:
     Beckmann(float alpha);
     float D(const Vec3& h) const override;
     float lambda(const Vec3& w) const override;
-    Vec3 sample_halfvector(const Vec3& wo) const override;
+    Vec3 sample_halfvector(const Vec3& wo, const Vec2& u) const override;
     float eval_pdf(const Vec3& h, const Vec3& wo) const override;
+    NDFType get_type() const override { return NDFType::Beckmann; }
+    float get_alpha() const override { return alpha; }
 
 private: 
     /**
     * @brief Beckmannzn[txNgTvO
     * @param[in] alpha :z̃p[^
+    * @param[in] u     :[0, 1)^2̈lȃTv
     * @return Vec3     :TvOl
     * @note: Ql: https://www.pbr-book.org/3ed-2018/Reflection_Models/Microfacet_Models
     */
-    Vec3 beckmann_sample(float alpha) const;
+    Vec3 beckmann_sample(float alpha, const Vec2& u) const;
 
     float alpha; /**< z̃X[vp[^(\ʑe) */
 };
@@ -101,26 +116,30 @@ public:
     GGX(float alpha, bool is_vsible_sampling=true);
     float D(const Vec3& h) const override;
     float lambda(const Vec3& w) const override;
-    Vec3 sample_halfvector(const Vec3& wo) const override;
+    Vec3 sample_halfvector(const Vec3& wo, const Vec2& u) const override;
     float eval_pdf(const Vec3& h, const Vec3& wo) const override;
+    NDFType get_type() const override { return NDFType::GGX; }
+    float get_alpha() const override { return alpha; }
 
 private:
     /**
     * @brief Trowbridge-Reitz(GGX)zn[txNgTvO
     * @param[in] alpha :z̃p[^
+    * @param[in] u     :[0, 1)^2̈lȃTv
     * @return Vec3     :TvOl
     * @note: Ql: https://www.pbr-book.org/3ed-2018/Reflection_Models/Microfacet_Models
     */
-    Vec3 ggx_sample(float alpha) const;
+    Vec3 ggx_sample(float alpha, const Vec2& u) const;
 
     /**
     * @brief Trowbridge-Reitz(GGX)z̉@zn[txNgTvO
     * @param[in] wo    :o˕
     * @param[in] alpha :z̃p[^
+    * @param[in] u     :[0, 1)^2̈lȃTv
     * @return Vec3     :TvOl
     * @note: Ql: [Heitz 2018](https://jcgt.org/published/0007/04/01/)
     */
-    Vec3 visible_ggx_sample(const Vec3& wo, float alpha) const;
+    Vec3 visible_ggx_sample(const Vec3& wo, float alpha, const Vec2& u) const;
 
     float alpha; /**< z̃X[vp[^(\ʑe) */
 };
\ No newline at end of file
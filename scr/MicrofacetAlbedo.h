@@ -0,0 +1,44 @@
+/**
+* @file  MicrofacetAlbedo.h
+* @brief }CNt@ZbgBRDF̃Axhe[u(dŨGlM[Up)
+* @note  AxhE(, )ƕσAxhE_avg()NDF̎ނƂɎOvZă\[Xɖߍ݁C
+*        SẴ}eAŋL
+* @note  Ql: [Kulla and Conty 2017] "Revisiting Physically Based Shading at Imageworks"
+*/
+
+#pragma once
+
+#include <iosfwd>
+#include "Microfacet.h"
+
+// Axhe[u̓ˊp]̕( = i / (SIZE - 1))
+constexpr int ALBEDO_TABLE_SIZE_MU = 32;
+
+// Axhe[u̕\ʑe̕(ヿ = j / (SIZE - 1))
+constexpr int ALBEDO_TABLE_SIZE_ALPHA = 32;
+
+
+/**
+* @brief tl1ƂPU̕Axhe[uԂ֐
+* @param[in] type      :}CNt@Zbgz̎
+* @param[in] alpha     :\ʑe([0, 1]ŃNv)
+* @param[in] cos_theta :o˕̗]
+* @return float        :AxhE(, )
+*/
+float eval_directional_albedo(NDFType type, float alpha, float cos_theta);
+
+/**
+* @brief tl1ƂPU̕σAxhe[uԂ֐
+* @param[in] type  :}CNt@Zbgz̎
+* @param[in] alpha :\ʑe([0, 1]ŃNv)
+* @return float    :σAxhE_avg() = 2E(, )d
+*/
+float eval_average_albedo(NDFType type, float alpha);
+
+/**
+* @brief Axhe[ueJϕŌvZC++̔zƂďo͂֐
+* @param[in] os       :o̓Xg[
+* @param[in] nsamples :e[u1vf̃Tv
+* @note MicrofacetAlbedo.cppɖߍ񂾃e[u̍ĐɎg(NDFύXꍇȂ)
+*/
+void write_albedo_tables(std::ostream& os, int nsamples=65536);
@@ -0,0 +1,293 @@
+#include "ObjLoader.h"
+#include <algorithm>
+#include <charconv>
+#include <string_view>
+#include <iostream>
+#include <utility>
+#include "MappedFile.h"
+#include "Parallel.h"
+
+// 1`N̍ŏoCg
+constexpr size_t OBJ_MIN_CHUNK_SIZE = 1 << 20;
+// sԍo͂sȍs̍ő吔
+constexpr int OBJ_MAX_REPORTED_LINES = 10;
+
+
+// ***  ***
+
+/** ʂ̒_̗vf(_WCeNX`WC@) */
+enum ObjAttribute { OBJ_POSITION = 0, OBJ_UV = 1, OBJ_NORMAL = 2, OBJ_NUM_ATTRIBUTES = 3 };
+
+/** `N̉͌ */
+struct ObjChunk {
+    std::vector<Vec3> positions;                      /**< _W                                */
+    std::vector<Vec3> normals;                        /**< @                                    */
+    std::vector<Vec2> uvs;                            /**< eNX`W                          */
+    std::vector<int64_t> indices[OBJ_NUM_ATTRIBUTES]; /**< Op`̒_Ƃ̗vf̔ԍ           */
+    std::vector<size_t> relatives[OBJ_NUM_ATTRIBUTES]; /**< `N̐擪̑Δԍʒu */
+    bool has_uv = true;                               /**< SĂ̖ʂeNX`W       */
+    bool has_normal = true;                           /**< SĂ̖ʂ@                 */
+    int num_lines = 0;                                /**< `N̍s                         */
+    std::vector<std::pair<int, std::string_view>> invalid_lines; /**< ͂łȂs(sԍƃL[[h) */
+    std::vector<int64_t> face_corners;                /**< ̖͒ʂ̒_Ƃ̗vf̔ԍ(sƂɍėp) */
+};
+
+/**
+* @brief (Xy[Xƃ^u)ǂݔ΂֐
+* @param[in] p   :݈ʒu
+* @param[in] end :s
+* @return const char* :󔒂łȂʒu
+*/
+static const char* skip_space(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    return p;
+}
+
+/**
+* @brief ǂݍފ֐
+* @param[in,out] p   :݈ʒu(ǂݍ񂾐l̒ɐi)
+* @param[in]     end :s
+* @param[out]    x   :ǂݍ񂾒l
+* @return bool       :ǂݍ߂true
+*/
+static bool parse_float(const char*& p, const char* end, float& x) {
+    p = skip_space(p, end);
+    if (p < end && *p == '+') p++; // from_chars͐̕󂯕tȂ
+    auto result = std::from_chars(p, end, x);
+    if (result.ec != std::errc()) return false;
+    p = result.ptr;
+    return true;
+}
+
+/**
+* @brief ǂݍފ֐
+* @param[in,out] p   :݈ʒu(ǂݍ񂾐l̒ɐi)
+* @param[in]     end :s
+* @param[out]    x   :ǂݍ񂾒l
+* @return bool       :ǂݍ߂true
+*/
+static bool parse_int(const char*& p, const char* end, int64_t& x) {
+    if (p < end && *p == '+') p++;
+    auto result = std::from_chars(p, end, x);
+    if (result.ec != std::errc()) return false;
+    p = result.ptr;
+    return true;
+}
+
+/**
+* @brief ʂ̒_̔ԍ0n܂̔ԍɕϊĒǉ֐
+* @param[in,out] chunk :`N̉͌
+* @param[in]     attr  :vf̎
+* @param[in]     index :t@C̔ԍ(Ȃ1n܂CȂ璼Oɒ`ꂽvf̑Έʒu)
+* @param[in]     count :`Nł܂łɒ`ꂽvf
+*/
+static void push_index(ObjChunk& chunk, int attr, int64_t index, size_t count) {
+    if (index < 0) {
+        // Ń`N̐擪܂ł̗vf𑫂
+        chunk.relatives[attr].push_back(chunk.indices[attr].size());
+        chunk.indices[attr].push_back((int64_t)count + index);
+    }
+    else {
+        chunk.indices[attr].push_back(index - 1);
+    }
+}
+
+/**
+* @brief ʂ̍s͂ĎOp`֐
+* @param[in]     p     :"f"̒̈ʒu
+* @param[in]     end   :s
+* @param[in,out] chunk :`N̉͌
+* @return bool         :͂łtrue
+* @note s̑SĂ̒_͂łꍇ̂ݎOp`ǉ
+*/
+static bool parse_face(const char* p, const char* end, ObjChunk& chunk) {
+    // ʂ̒_Ƃ̗vf̔ԍ(0Ȃȗ)ɑSēǂݍ
+    auto& corners = chunk.face_corners;
+    corners.clear();
+    bool has_uv = true, has_normal = true;
+    while (true) {
+        p = skip_space(p, end);
+        if (p >= end || *p == '#') break;
+        // v, v/vt, v//vn, v/vt/vn̏
+        int64_t corner[OBJ_NUM_ATTRIBUTES] = { 0 };
+        if (!parse_int(p, end, corner[OBJ_POSITION]) || corner[OBJ_POSITION] == 0) return false;
+        if (p < end && *p == '/') {
+            p++;
+            if (p < end && *p != '/') {
+                if (!parse_int(p, end, corner[OBJ_UV])) return false;
+            }
+            if (p < end && *p == '/') {
+                p++;
+                if (!parse_int(p, end, corner[OBJ_NORMAL])) return false;
+            }
+        }
+        if (p < end && *p != ' ' && *p != '\t') return false;
+        has_uv &= corner[OBJ_UV] != 0;
+        has_normal &= corner[OBJ_NORMAL] != 0;
+        corners.insert(corners.end(), corner, corner + OBJ_NUM_ATTRIBUTES);
+    }
+    const int num_corners = (int)corners.size() / OBJ_NUM_ATTRIBUTES;
+    if (num_corners < 3) return false;
+    // ɎOp`Ēǉ
+    const size_t counts[OBJ_NUM_ATTRIBUTES] = { chunk.positions.size(), chunk.uvs.size(), chunk.normals.size() };
+    for (int i = 2; i < num_corners; i++) {
+        const int tri[3] = { 0, i - 1, i };
+        for (int k = 0; k < 3; k++) {
+            for (int a = 0; a < OBJ_NUM_ATTRIBUTES; a++) {
+                push_index(chunk, a, corners[tri[k] * OBJ_NUM_ATTRIBUTES + a], counts[a]);
+            }
+        }
+    }
+    chunk.has_uv &= has_uv;
+    chunk.has_normal &= has_normal;
+    return true;
+}
+
+/**
+* @brief `NsƂɉ͂֐
+* @param[in]  begin :`N̐擪(s)
+* @param[in]  end   :`N̖(s̒)
+* @param[out] chunk :`N̉͌
+*/
+static void parse_chunk(const char* begin, const char* end, ObjChunk& chunk) {
+    const char* line = begin;
+    for (; line < end; chunk.num_lines++) {
+        const char* line_end = std::find(line, end, '\n');
+        const char* next = line_end < end ? line_end + 1 : end;
+        if (line_end > line && line_end[-1] == '\r') line_end--;
+        const char* p = skip_space(line, line_end);
+        // sƃRg
+        if (p >= line_end || *p == '#') {
+            line = next;
+            continue;
+        }
+        // L[[h擾
+        const char* key = p;
+        while (p < line_end && *p != ' ' && *p != '\t') p++;
+        std::string_view keyword(key, p - key);
+        bool is_valid = true;
+        if (keyword == "v") {
+            float x, y, z;
+            is_valid = parse_float(p, line_end, x) && parse_float(p, line_end, y) && parse_float(p, line_end, z);
+            if (is_valid) chunk.positions.push_back(Vec3(x, y, z));
+        }
+        else if (keyword == "vn") {
+            float x, y, z;
+            is_valid = parse_float(p, line_end, x) && parse_float(p, line_end, y) && parse_float(p, line_end, z);
+            if (is_valid) chunk.normals.push_back(Vec3(x, y, z));
+        }
+        else if (keyword == "vt") {
+            float u, v = 0.f;
+            is_valid = parse_float(p, line_end, u);
+            parse_float(p, line_end, v); // 1̃eNX`W
+            if (is_valid) chunk.uvs.push_back(Vec2(u, v));
+        }
+        else if (keyword == "f") {
+            is_valid = parse_face(p, line_end, chunk);
+        }
+        if (!is_valid) {
+            chunk.invalid_lines.emplace_back(chunk.num_lines, keyword);
+        }
+        line = next;
+    }
+}
+
+
+bool load_obj(const std::string& filename, ObjMesh& mesh, int num_threads) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        return false;
+    }
+    const char* data = file.get_data();
+    const size_t size = file.get_size();
+    ThreadPool pool(num_threads);
+    // s̋EŃ`Nɕ
+    size_t num_chunks = std::clamp(size / OBJ_MIN_CHUNK_SIZE, (size_t)1, (size_t)pool.get_num_threads() * 4);
+    std::vector<size_t> bounds(num_chunks + 1, size);
+    bounds[0] = 0;
+    for (size_t c = 1; c < num_chunks; c++) {
+        size_t pos = std::max(size * c / num_chunks, bounds[c - 1]);
+        const char* nl = std::find(data + pos, data + size, '\n');
+        bounds[c] = nl < data + size ? (size_t)(nl - data) + 1 : size;
+    }
+    // `NƂɕɉ
+    std::vector<ObjChunk> chunks(num_chunks);
+    pool.parallel_for((int)num_chunks, [&](int c, int thread_id) {
+        parse_chunk(data + bounds[c], data + bounds[c + 1], chunks[c]);
+    });
+    // `N̐擪܂ł̗vf(Δԍ̉ƌɎg)
+    std::vector<size_t> offsets[OBJ_NUM_ATTRIBUTES + 1];
+    for (auto& o : offsets) o.assign(num_chunks + 1, 0);
+    bool has_uv = true, has_normal = true;
+    size_t num_invalid_lines = 0;
+    int line_offset = 0;
+    for (size_t c = 0; c < num_chunks; c++) {
+        const auto& chunk = chunks[c];
+        offsets[OBJ_POSITION][c + 1] = offsets[OBJ_POSITION][c] + chunk.positions.size();
+        offsets[OBJ_UV][c + 1] = offsets[OBJ_UV][c] + chunk.uvs.size();
+        offsets[OBJ_NORMAL][c + 1] = offsets[OBJ_NORMAL][c] + chunk.normals.size();
+        offsets[OBJ_NUM_ATTRIBUTES][c + 1] = offsets[OBJ_NUM_ATTRIBUTES][c] + chunk.indices[OBJ_POSITION].size();
+        has_uv &= chunk.has_uv;
+        has_normal &= chunk.has_normal;
+        // ͂łȂs1n܂̍sԍŕ
+        for (const auto& [line, keyword] : chunk.invalid_lines) {
+            if (num_invalid_lines++ < OBJ_MAX_REPORTED_LINES) {
+                std::cerr << filename << ':' << line_offset + line + 1 << ": malformed '" << keyword
+                          << "' record\n";
+            }
+        }
+        line_offset += chunk.num_lines;
+    }
+    const size_t counts[OBJ_NUM_ATTRIBUTES] = {
+        offsets[OBJ_POSITION][num_chunks], offsets[OBJ_UV][num_chunks], offsets[OBJ_NORMAL][num_chunks] };
+    const size_t num_corners = offsets[OBJ_NUM_ATTRIBUTES][num_chunks];
+    if (counts[OBJ_POSITION] > UINT32_MAX || num_corners > UINT32_MAX) {
+        std::cerr << filename << ": too many vertices or faces\n";
+        return false;
+    }
+    mesh = ObjMesh();
+    mesh.positions.resize(counts[OBJ_POSITION]);
+    mesh.uvs.resize(counts[OBJ_UV]);
+    mesh.normals.resize(counts[OBJ_NORMAL]);
+    std::vector<uint32_t>* dst[OBJ_NUM_ATTRIBUTES] = { &mesh.indices, &mesh.uv_indices, &mesh.normal_indices };
+    const bool is_used[OBJ_NUM_ATTRIBUTES] = { true, has_uv, has_normal };
+    for (int a = 0; a < OBJ_NUM_ATTRIBUTES; a++) {
+        if (is_used[a]) dst[a]->resize(num_corners);
+    }
+    // `NƂɕɌ
+    std::vector<char> is_out_of_range(num_chunks, 0);
+    pool.parallel_for((int)num_chunks, [&](int c, int thread_id) {
+        auto& chunk = chunks[c];
+        std::copy(chunk.positions.begin(), chunk.positions.end(), mesh.positions.begin() + offsets[OBJ_POSITION][c]);
+        std::copy(chunk.uvs.begin(), chunk.uvs.end(), mesh.uvs.begin() + offsets[OBJ_UV][c]);
+        std::copy(chunk.normals.begin(), chunk.normals.end(), mesh.normals.begin() + offsets[OBJ_NORMAL][c]);
+        for (int a = 0; a < OBJ_NUM_ATTRIBUTES; a++) {
+            if (!is_used[a]) continue;
+            auto& indices = chunk.indices[a];
+            for (auto i : chunk.relatives[a]) {
+                indices[i] += (int64_t)offsets[a][c];
+            }
+            auto out = dst[a]->begin() + offsets[OBJ_NUM_ATTRIBUTES][c];
+            for (auto index : indices) {
+                if (index < 0 || index >= (int64_t)counts[a]) {
+                    is_out_of_range[c] = 1;
+                    index = 0;
+                }
+                *out++ = (uint32_t)index;
+            }
+        }
+        chunk = ObjChunk(); // 
+    });
+    if (std::find(is_out_of_range.begin(), is_out_of_range.end(), 1) != is_out_of_range.end()) {
+        std::cerr << filename << ": face index out of range\n";
+        return false;
+    }
+    if (num_invalid_lines > 0) {
+        std::cerr << filename << ": skipped " << num_invalid_lines << " malformed lines\n";
+    }
+    if (mesh.indices.empty()) {
+        std::cerr << filename << ": no valid faces\n";
+        return false;
+    }
+    return true;
+}
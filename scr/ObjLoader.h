@@ -0,0 +1,37 @@
+/**
+* @file  ObjLoader.h
+* @brief Wavefront .objt@C̓ǂݍ
+* @note  t@C}bvčs̋Eŕ`Nɉ͂
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Math.h"
+
+/** .objt@Cǂݍ񂾃bV */
+struct ObjMesh {
+    std::vector<Vec3> positions;          /**< _W(v)                                        */
+    std::vector<Vec3> normals;            /**< @(vn)                                           */
+    std::vector<Vec2> uvs;                /**< eNX`W(vt)                                 */
+    std::vector<uint32_t> indices;        /**< Op`Ƃ3ׂ_W̔ԍ(0n܂)       */
+    std::vector<uint32_t> normal_indices; /**< Op`Ƃ3ׂ@̔ԍ(SĂ̖ʂɂȂ΋) */
+    std::vector<uint32_t> uv_indices;     /**< Op`Ƃ3ׂeNX`W̔ԍ()    */
+
+    int get_num_triangles() const { return (int)indices.size() / 3; }
+};
+
+
+/**
+* @brief .objt@Cǂݍފ֐
+* @param[in]  filename    :.objt@C̃pX
+* @param[out] mesh        :ǂݍ񂾃bV
+* @param[in]  num_threads :͂ɎgXbh(0ȉȂn[hEFÃXbh)
+* @return bool            :ǂݍ߂true
+* @note ʂv, v/vt, v//vn, v/vt/vn̏ƕ()ԍɑΉCp`͐ɎOp`
+* @note _EʈȊO̗vf(o, g, usemtlȂ)͖
+* @note ͂łȂv, vn, vt, f̍s͍sԍo͂ēǂݔ΂CLȖʂȂΎsƂ
+*/
+bool load_obj(const std::string& filename, ObjMesh& mesh, int num_threads=0);
@@ -0,0 +1,106 @@
+#include "Parallel.h"
+#include <algorithm>
+
+
+ThreadPool::ThreadPool(int num_threads) {
+    if (num_threads <= 0) {
+        num_threads = default_num_threads();
+    }
+    for (int i = 0; i < num_threads; i++) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+    for (int i = 0; i < num_threads; i++) {
+        workers.emplace_back(&ThreadPool::worker_loop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        is_stop = true;
+    }
+    cv_start.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+int ThreadPool::default_num_threads() {
+    return std::max(1, (int)std::thread::hardware_concurrency());
+}
+
+void ThreadPool::parallel_for(int count, const std::function<void(int, int)>& func) {
+    if (count <= 0) {
+        return;
+    }
+    int num_threads = get_num_threads();
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        // ^XNAubNŃ[J[֔z
+        for (int i = 0; i < num_threads; i++) {
+            int begin = (int)((int64_t)count * i / num_threads);
+            int end = (int)((int64_t)count * (i + 1) / num_threads);
+            std::lock_guard<std::mutex> queue_lock(queues[i]->mtx);
+            for (int task = begin; task < end; task++) {
+                queues[i]->tasks.push_back(task);
+            }
+        }
+        job = &func;
+        num_finished = 0;
+        generation++;
+    }
+    cv_start.notify_all();
+    // SẴ[J[WuI܂ő҂
+    std::unique_lock<std::mutex> lock(mtx);
+    cv_done.wait(lock, [&] { return num_finished == num_threads; });
+    job = nullptr;
+}
+
+void ThreadPool::worker_loop(int id) {
+    uint64_t seen_generation = 0;
+    while (true) {
+        const std::function<void(int, int)>* current_job;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv_start.wait(lock, [&] { return is_stop || generation != seen_generation; });
+            if (is_stop) return;
+            seen_generation = generation;
+            current_job = job;
+        }
+        // ^XNȂȂ܂Ŏs
+        int task;
+        while (pop_task(id, task)) {
+            (*current_job)(task, id);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            num_finished++;
+        }
+        cv_done.notify_one();
+    }
+}
+
+bool ThreadPool::pop_task(int id, int& task) {
+    // ̃L[̐擪o
+    {
+        auto& queue = *queues[id];
+        std::lock_guard<std::mutex> lock(queue.mtx);
+        if (!queue.tasks.empty()) {
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+            return true;
+        }
+    }
+    // ̃[J[̃L[̖瓐
+    int num_threads = (int)queues.size();
+    for (int i = 1; i < num_threads; i++) {
+        auto& victim = *queues[(id + i) % num_threads];
+        std::lock_guard<std::mutex> lock(victim.mtx);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.back();
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,79 @@
+/**
+* @file  Parallel.h
+* @brief [NXeB[O^̃Xbhv[
+* @note  e[J[͎̃L[̐擪^XNoC
+*        ɂȂ瑼̃[J[̃L[̖^XN𓐂
+*/
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** Xbhv[NX */
+class ThreadPool {
+public:
+    /**
+    * @brief Xbhv[
+    * @param[in] num_threads :[J[Xbh(0ȉȂn[hEFÃXbh)
+    */
+    explicit ThreadPool(int num_threads=0);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int get_num_threads() const { return (int)workers.size(); }
+
+    /**
+    * @brief [0, count)̃^XNɎsđSĂ̊҂֐
+    * @param[in] count :^XN
+    * @param[in] func  :^XN֐ void(int index, int thread_id)
+    * @note ^XN͘AubNƂɃ[J[֔z
+    */
+    void parallel_for(int count, const std::function<void(int, int)>& func);
+
+    /**
+    * @brief ̃Xbh擾֐
+    * @return int :n[hEFÃXbh(擾łȂ1)
+    */
+    static int default_num_threads();
+
+private:
+    /** [J[Ƃ̃^XNL[ */
+    struct WorkQueue {
+        std::mutex mtx;         /**< L[̔r */
+        std::deque<int> tasks;  /**< ^XNԍ       */
+    };
+
+    /**
+    * @brief [J[Xbh̏
+    * @param[in] id :[J[ԍ
+    */
+    void worker_loop(int id);
+
+    /**
+    * @brief ^XNo֐(̃L[Ȃ瑼̃L[瓐)
+    * @param[in]  id   :[J[ԍ
+    * @param[out] task :o^XNԍ
+    * @return bool     :otrue
+    */
+    bool pop_task(int id, int& task);
+
+    std::vector<std::thread> workers;                /**< [J[Xbh       */
+    std::vector<std::unique_ptr<WorkQueue>> queues;  /**< [J[Ƃ̃L[   */
+    std::mutex mtx;                                  /**< Ԃ̔r         */
+    std::condition_variable cv_start;                /**< WuJn̒ʒm       */
+    std::condition_variable cv_done;                 /**< Wu̒ʒm       */
+    const std::function<void(int, int)>* job = nullptr; /**< s̃^XN֐  */
+    uint64_t generation = 0;                         /**< Wu̐           */
+    int num_finished = 0;                            /**< WuI[J[ */
+    bool is_stop = false;                            /**< Iv               */
+};
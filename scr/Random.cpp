@@ -1,41 +1,50 @@
 #include "Random.h"
 #include <algorithm>
 
+static thread_local PCG32 rng; /**< (XbhƂɓƗ) */
+
+
 /** NX */
-void Random::init() {
-    //std::random_device rd;
-    //mt.seed(rd()); 
-    mt.seed(0); // V[hŒ
+void Random::init(uint64_t seed, uint64_t stream) {
+    rng.set_sequence(seed, stream);
 }
 
 float Random::uniform_float() {
-    return uniform_float(0.f, 1.0f);
+    return rng.next_float();
 }
 
 float Random::uniform_float(float min, float max) {
-    std::uniform_real_distribution<float> dist(min, max);
-    return dist(mt);
+    return min + (max - min) * rng.next_float();
 }
 
 int Random::uniform_int(int min, int max) {
-    std::uniform_int_distribution<> dist(min, max);
-    return dist(mt);
+    return min + (int)rng.next_uint((uint32_t)(max - min) + 1u);
 }
 
 Vec2 Random::uniform_disk_sample() {
     auto u = Random::uniform_float();
     auto v = Random::uniform_float();
-    auto r = std::sqrt(u);
-    auto phi = 2 * pi * v;
+    return uniform_disk_sample(Vec2(u, v));
+}
+
+Vec2 Random::uniform_disk_sample(const Vec2& u) {
+    auto r = std::sqrt(u[0]);
+    auto phi = 2 * pi * u[1];
     auto x = std::cos(phi) * r;
     auto y = std::sin(phi) * r;
     return Vec2(x, y);
 }
 
 Vec2 Random::concentric_disk_sample() {
+    auto u = Random::uniform_float();
+    auto v = Random::uniform_float();
+    return concentric_disk_sample(Vec2(u, v));
+}
+
+Vec2 Random::concentric_disk_sample(const Vec2& uv) {
     float r, phi;
-    auto u = 2 * Random::uniform_float() -1.0f;
-    auto v = 2 * Random::uniform_float() -1.0f;
+    auto u = 2 * uv[0] - 1.0f;
+    auto v = 2 * uv[1] - 1.0f;
     if (u == 0 && v == 0) {
         return Vec2::zero;
     }
@@ -55,18 +64,26 @@ Vec2 Random::concentric_disk_sample() {
 Vec2 Random::uniform_triangle_sample() {
     auto u = Random::uniform_float();
     auto v = Random::uniform_float();
-    auto sqrt_u = std::sqrt(u);
+    return uniform_triangle_sample(Vec2(u, v));
+}
+
+Vec2 Random::uniform_triangle_sample(const Vec2& u) {
+    auto sqrt_u = std::sqrt(u[0]);
     auto x = 1 - sqrt_u;
-    auto y = v * sqrt_u;
+    auto y = u[1] * sqrt_u;
     return Vec2(x, y);
 }
 
 Vec3 Random::uniform_sphere_sample() {
     auto u = Random::uniform_float();
     auto v = Random::uniform_float();
-    auto z = 1 - 2 * u;
+    return uniform_sphere_sample(Vec2(u, v));
+}
+
+Vec3 Random::uniform_sphere_sample(const Vec2& u) {
+    auto z = 1 - 2 * u[0];
     auto r = std::sqrt(std::max(1.0f - z*z, 0.f));
-    auto phi = 2 * pi * v;
+    auto phi = 2 * pi * u[1];
     auto x = std::cos(phi) * r;
     auto y = std::sin(phi) * r;
     return Vec3(x, y, z);
@@ -75,16 +92,26 @@ Vec3 Random::uniform_sphere_sample() {
 Vec3 Random::uniform_hemisphere_sample() {
     auto u = Random::uniform_float();
     auto v = Random::uniform_float();
-    auto z = u;
+    return uniform_hemisphere_sample(Vec2(u, v));
+}
+
+Vec3 Random::uniform_hemisphere_sample(const Vec2& u) {
+    auto z = u[0];
     auto r = std::sqrt(std::max(1.0f - z*z, 0.f));
-    auto phi = 2 * pi * v;
+    auto phi = 2 * pi * u[1];
     auto x = std::cos(phi) * r;
     auto y = std::sin(phi) * r;
     return Vec3(x, y, z);
 }
 
 Vec3 Random::cosine_hemisphere_sample() {
-    auto d = Random::concentric_disk_sample();
+    auto u = Random::uniform_float();
+    auto v = Random::uniform_float();
+    return cosine_hemisphere_sample(Vec2(u, v));
+}
+
+Vec3 Random::cosine_hemisphere_sample(const Vec2& u) {
+    auto d = Random::concentric_disk_sample(u);
     auto x = d.get_x();
     auto y = d.get_y();
     auto z = std::sqrt(std::max(1.0f - x*x - y*y, 0.f));
@@ -104,6 +131,75 @@ float Random::power_heuristic(int n1, float pdf1, int n2, float pdf2, float beta
 }
 
 
+/** GCAXe[u */
+AliasTable::AliasTable(const std::vector<float>& weights)
+    : bins(weights.size())
+{
+    int n = (int)weights.size();
+    if (n == 0) {
+        return;
+    }
+    double sum = 0.0;
+    for (auto w : weights) {
+        sum += std::max(w, 0.f);
+    }
+    for (int i = 0; i < n; i++) {
+        bins[i].pmf = sum > 0 ? float(std::max(weights[i], 0.f) / sum) : 1.0f / n;
+    }
+    // ςyvfƏdvfɕ
+    std::vector<int> under, over;
+    std::vector<double> p(n);
+    for (int i = 0; i < n; i++) {
+        p[i] = (double)bins[i].pmf * n;
+        if (p[i] < 1.0) under.push_back(i);
+        else            over.push_back(i);
+    }
+    // yvf̃r̎cdvfŖ߂
+    while (!under.empty() && !over.empty()) {
+        int small = under.back();
+        int large = over.back();
+        under.pop_back();
+        over.pop_back();
+        bins[small].q = (float)p[small];
+        bins[small].alias = large;
+        p[large] -= 1.0 - p[small];
+        if (p[large] < 1.0) under.push_back(large);
+        else                over.push_back(large);
+    }
+    // c͌덷Ίm1
+    for (int i : under) {
+        bins[i].q = 1.0f;
+        bins[i].alias = -1;
+    }
+    for (int i : over) {
+        bins[i].q = 1.0f;
+        bins[i].alias = -1;
+    }
+}
+
+int AliasTable::sample(float u, float& pmf) const {
+    float u_remapped;
+    return sample(u, pmf, u_remapped);
+}
+
+int AliasTable::sample(float u, float& pmf, float& u_remapped) const {
+    // u̐ŃrIсCŎgGCAXI
+    int n = (int)bins.size();
+    int index = std::min((int)(u * n), n - 1);
+    float up = std::min(u * n - index, one_minus_epsilon);
+    const auto& bin = bins[index];
+    if (up < bin.q) {
+        u_remapped = std::min(up / bin.q, one_minus_epsilon);
+    }
+    else {
+        u_remapped = std::min((up - bin.q) / (1 - bin.q), one_minus_epsilon);
+        index = bin.alias;
+    }
+    pmf = bins[index].pmf;
+    return index;
+}
+
+
 /** 1D敪֐ */
 Piecewise1D::Piecewise1D(const float* data, int _n)
     : f(data, data+_n), n(_n), cdf(_n + 1)
@@ -114,18 +210,22 @@ Piecewise1D::Piecewise1D(const float* data, int _n)
         cdf[i] = cdf[i-1] + f[i-1] / n;
     }
     integral_f = cdf[n];
+    // CDF͍\z_ŒPȂ̂ŐK̂ݍs(֐[Ȃlz)
     for (int i = 1; i < n + 1; i++) {
-        cdf[i] /= integral_f;
+        cdf[i] = integral_f > 0 ? cdf[i] / integral_f : (float)i / n;
     }
-    std::sort(cdf.begin(), cdf.end());
+    cdf[n] = 1.0f;
 }
 
 float Piecewise1D::sample(float& pdf, int& index) const {
-    // cdf[index] <= u < cdf[index+1]ƂȂCfbNXT
-    auto u = Random::uniform_float();
-    auto iter = std::lower_bound(cdf.begin(), cdf.end(), u); // 񕪒T
-    index = std::distance(cdf.begin(), iter) - 1; // cdf[index] <= uƂ邽߂-1
-    pdf = f[index] / integral_f;
+    return sample(Random::uniform_float(), pdf, index);
+}
+
+float Piecewise1D::sample(float u, float& pdf, int& index) const {
+    // cdf[index] <= u < cdf[index+1]ƂȂCfbNXT([̋Ԃ͑I΂Ȃ)
+    auto iter = std::upper_bound(cdf.begin(), cdf.end(), u); // 񕪒T
+    index = std::clamp((int)std::distance(cdf.begin(), iter) - 1, 0, n - 1);
+    pdf = integral_f > 0 ? f[index] / integral_f : 1.0f;
     auto t = (u - cdf[index]) / (cdf[index + 1] - cdf[index]);
     return (index + t) / n;
 }
@@ -148,10 +248,16 @@ Piecewise2D::Piecewise2D(const float* data, int _nu, int _nv)
 }
 
 Vec2 Piecewise2D::sample(float& pdf) const {
+    auto v = Random::uniform_float();
+    auto u = Random::uniform_float();
+    return sample(Vec2(u, v), pdf);
+}
+
+Vec2 Piecewise2D::sample(const Vec2& uv, float& pdf) const {
     float pdf_u = 0, pdf_v = 0;
     int index_u, index_v;
-    float v = merginal_pdf->sample(pdf_v, index_v);
-    float u = conditional_pdf[index_v]->sample(pdf_u, index_u);
+    float v = merginal_pdf->sample(uv[1], pdf_v, index_v);
+    float u = conditional_pdf[index_v]->sample(uv[0], pdf_u, index_u);
     pdf = pdf_u * pdf_v;
     return Vec2(u, v);
 }
@@ -161,4 +267,55 @@ float Piecewise2D::eval_pdf(const Vec2& uv) const {
     int index_v = std::clamp(int(uv[1] * nv), 0, nv - 1);
     // p(u, v) = f(u,v) / \int \int f(u,v) dudv
     return conditional_pdf[index_v]->get_f(index_u) / merginal_pdf->get_integral_f();
+}
+
+
+/** GCAXe[uɂ1D敪֐ */
+AliasPiecewise1D::AliasPiecewise1D(const float* data, int _n)
+    : table(std::vector<float>(data, data + _n)), n(_n), integral_f(0.f)
+{
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) {
+        sum += std::max(data[i], 0.f);
+    }
+    integral_f = (float)(sum / n);
+}
+
+float AliasPiecewise1D::sample(float u, float& pdf, int& index) const {
+    // ԂIŎc̗ԓ̈ʒuɎg
+    float pmf, t;
+    index = table.sample(u, pmf, t);
+    pdf = pmf * n;
+    return (index + t) / n;
+}
+
+
+/** GCAXe[uɂ2D敪֐ */
+AliasPiecewise2D::AliasPiecewise2D(const float* data, int _nu, int _nv)
+    : nu(_nu), nv(_nv)
+{
+    // tmx֐p(u|v)ƎӖx֐p(v)vZ
+    conditional_pdf.reserve(nv);
+    std::vector<float> marginal_f(nv);
+    for (int v = 0; v < nv; v++) {
+        conditional_pdf.emplace_back(&data[v * nu], nu);
+        marginal_f[v] = conditional_pdf[v].get_integral_f();
+    }
+    marginal_pdf = std::make_unique<AliasPiecewise1D>(marginal_f.data(), nv);
+}
+
+Vec2 AliasPiecewise2D::sample(const Vec2& uv, float& pdf) const {
+    float pdf_u = 0, pdf_v = 0;
+    int index_u, index_v;
+    float v = marginal_pdf->sample(uv[1], pdf_v, index_v);
+    float u = conditional_pdf[index_v].sample(uv[0], pdf_u, index_u);
+    pdf = pdf_u * pdf_v;
+    return Vec2(u, v);
+}
+
+float AliasPiecewise2D::eval_pdf(const Vec2& uv) const {
+    int index_u = std::clamp(int(uv[0] * nu), 0, nu - 1);
+    int index_v = std::clamp(int(uv[1] * nv), 0, nv - 1);
+    // p(u, v) = p(u|v) p(v)
+    return conditional_pdf[index_v].get_pdf(index_u) * marginal_pdf->get_pdf(index_v);
 }
\ No newline at end of file
@@ -5,16 +5,107 @@
 
 #pragma once
 
+#include <cstdint>
 #include "utility.h"
 #include "Math.h"
 
+/** PCG32 */
+class PCG32 {
+    // Ql: https://www.pcg-random.org/
+public:
+    /**
+    * @brief 
+    * @param[in] seed   :V[hl(Xg[̊Jnʒu)
+    * @param[in] stream :Xg[ԍ(قȂԍ̌n͓Ɨ)
+    */
+    PCG32(uint64_t seed=0, uint64_t stream=0) { set_sequence(seed, stream); }
+
+    /**
+    * @brief V[hlƃXg[ԍݒ肷֐
+    * @param[in] seed   :V[hl
+    * @param[in] stream :Xg[ԍ
+    */
+    void set_sequence(uint64_t seed, uint64_t stream) {
+        state = 0u;
+        inc = (stream << 1u) | 1u; // ͊łȂ΂ȂȂ
+        next_uint();
+        state += seed;
+        next_uint();
+    }
+
+    /**
+    * @brief 32biẗl𐶐֐
+    * @return uint32_t :TvOl
+    */
+    uint32_t next_uint() {
+        uint64_t old_state = state;
+        state = old_state * MULTIPLIER + inc;
+        uint32_t xorshifted = (uint32_t)(((old_state >> 18u) ^ old_state) >> 27u);
+        uint32_t rot = (uint32_t)(old_state >> 59u);
+        return (xorshifted >> rot) | (xorshifted << ((~rot + 1u) & 31));
+    }
+
+    /**
+    * @brief [0, bound)̈lȐ𐶐֐
+    * @param[in] bound :(܂܂Ȃ)
+    * @return uint32_t :TvOl
+    */
+    uint32_t next_uint(uint32_t bound) {
+        // ]̕΂肪o͈͂p
+        uint32_t threshold = (~bound + 1u) % bound;
+        while (true) {
+            uint32_t r = next_uint();
+            if (r >= threshold) return r % bound;
+        }
+    }
+
+    /**
+    * @brief float^̈l[0, 1)𐶐֐
+    * @return float :TvOl
+    */
+    float next_float() {
+        // 24bit̐x[0, 1)ɕϊ
+        return (next_uint() >> 8) * 0x1p-24f;
+    }
+
+    /**
+    * @brief delta̏Ԃ܂Ői߂֐
+    * @param[in] delta :i߂
+    * @note LCG̑Q񕪗ݏō̂O(log delta)
+    */
+    void advance(uint64_t delta) {
+        uint64_t cur_mult = MULTIPLIER, cur_plus = inc;
+        uint64_t acc_mult = 1u, acc_plus = 0u;
+        while (delta > 0) {
+            if (delta & 1) {
+                acc_mult *= cur_mult;
+                acc_plus = acc_plus * cur_mult + cur_plus;
+            }
+            cur_plus = (cur_mult + 1) * cur_plus;
+            cur_mult *= cur_mult;
+            delta /= 2;
+        }
+        state = acc_mult * state + acc_plus;
+    }
+
+private:
+    static constexpr uint64_t MULTIPLIER = 0x5851f42d4c957f2dULL; /**< LCG̏搔 */
+
+    uint64_t state; /**<            */
+    uint64_t inc;   /**< (Xg[ԍ) */
+};
+
+
 /** NX */
 class Random {
 public:
     /**
     * @brief ̏֐
+    * @param[in] seed   :V[hl
+    * @param[in] stream :Xg[ԍ
+    * @note ̓XbhƂɓƗĂ̂ŊeXbhŏ
     */
-    static void init();
+    static void init(uint64_t seed=0, uint64_t stream=0);
 
     /**
     * @brief float^̈l[0, 1]𐶐֐
@@ -44,6 +135,13 @@ public:
     */
     static Vec2 uniform_disk_sample();
 
+    /**
+    * @brief Pʉ~̈lȃTvO
+    * @param[in] u :[0, 1)^2̈lȃTv
+    * @return Vec2 :TvOl(x,y)W
+    */
+    static Vec2 uniform_disk_sample(const Vec2& u);
+
     /**
     * @brief Pʉ~̈lȃTvO(c݂)
     * @return Vec2 :TvOl(x,y)W
@@ -51,24 +149,52 @@ public:
     */
     static Vec2 concentric_disk_sample();
 
+    /**
+    * @brief Pʉ~̈lȃTvO(c݂)
+    * @param[in] u :[0, 1)^2̈lȃTv
+    * @return Vec2 :TvOl(x,y)W
+    */
+    static Vec2 concentric_disk_sample(const Vec2& u);
+
     /**
     * @brief Op`̈lȃTvO(dSW)
     * @return Vec3 :TvOl(dSW)
     */
     static Vec2 uniform_triangle_sample();
 
+    /**
+    * @brief Op`̈lȃTvO(dSW)
+    * @param[in] u :[0, 1)^2̈lȃTv
+    * @return Vec3 :TvOl(dSW)
+    */
+    static Vec2 uniform_triangle_sample(const Vec2& u);
+
     /**
     * @brief Pʋ̈lȕxNgTvO
     * @return Vec3 :TvOl
     */
     static Vec3 uniform_sphere_sample();
 
+    /**
+    * @brief Pʋ̈lȕxNgTvO
+    * @param[in] u :[0, 1)^2̈lȃTv
+    * @return Vec3 :TvOl
+    */
+    static Vec3 uniform_sphere_sample(const Vec2& u);
+
     /**
     * @brief Pʔ̈lȕxNgTvO
     * @return Vec3 :TvOl
     */
     static Vec3 uniform_hemisphere_sample();
 
+    /**
+    * @brief Pʔ̈lȕxNgTvO
+    * @param[in] u :[0, 1)^2̈lȃTv
+    * @return Vec3 :TvOl
+    */
+    static Vec3 uniform_hemisphere_sample(const Vec2& u);
+
     /**
     * @brief Pʔ̃RTCd݂̕TvO
     * @return Vec3 :TvOl
@@ -77,6 +203,13 @@ public:
     */
     static Vec3 cosine_hemisphere_sample();
 
+    /**
+    * @brief Pʔ̃RTCd݂̕TvO
+    * @param[in] u :[0, 1)^2̈lȃTv
+    * @return Vec3 :TvOl
+    */
+    static Vec3 cosine_hemisphere_sample(const Vec2& u);
+
     /**
     * @brief dd_ITvȌd݂vZ֐
     * @param[in] n1   :1ڂ̊֐̃Tv
@@ -100,7 +233,59 @@ public:
     static float power_heuristic(int n1, float pdf1, int n2, float pdf2, float beta=2.0f);
 };
 
-static std::mt19937 mt; /**<  */
+
+/** GCAXe[u */
+class AliasTable {
+    // Ql: [Vose 1991] "A linear algorithm for generating random numbers with a given distribution"
+public:
+    /**
+    * @brief ̃GCAXe[u
+    */
+    AliasTable() {};
+
+    /**
+    * @brief d݂GCAXe[u\z
+    * @param[in] weights :vfƂ̔񕉂̏d(a[ȂlzƂ)
+    */
+    AliasTable(const std::vector<float>& weights);
+
+    int get_n() const { return (int)bins.size(); }
+    bool is_empty() const { return bins.empty(); }
+
+    /**
+    * @brief vf̊mʂ擾֐
+    * @param[in] index :vf̃CfbNX
+    * @return float    :m
+    */
+    float get_pmf(int index) const { return bins[index].pmf; }
+
+    /**
+    * @brief d݂ɔႵmŗvfTv֐(O(1))
+    * @param[in]  u   :[0, 1)̈lȃTv
+    * @param[out] pmf :Tvvf̊m
+    * @return int     :Tvvf̃CfbNX
+    */
+    int sample(float u, float& pmf) const;
+
+    /**
+    * @brief vfTvĎc̗[0, 1)ɈL΂ĕԂ֐(O(1))
+    * @param[in]  u          :[0, 1)̈lȃTv
+    * @param[out] pmf        :Tvvf̊m
+    * @param[out] u_remapped :vf̒ł̈ʒuɍėpł[0, 1)̈lȃTv
+    * @return int            :Tvvf̃CfbNX
+    */
+    int sample(float u, float& pmf, float& u_remapped) const;
+
+private:
+    /** GCAXe[ũr */
+    struct Bin {
+        float q=0.f;    /**< rg̗vfIԊm   */
+        float pmf=0.f;  /**< rg̗vf̊m   */
+        int alias=-1;   /**< ̗vf̃CfbNX */
+    };
+
+    std::vector<Bin> bins; /**< vfƂ̃r */
+};
 
 
 /** 1D敪֐ */
@@ -126,6 +311,15 @@ public:
     */
     float sample(float& pdf, int& index) const;
 
+    /**
+    * @brief lȃTvut֐@ŕϊxTv֐
+    * @param[in]  u     :[0, 1)̈lȃTv
+    * @param[out] pdf   :TvOmx
+    * @param[out] index :TvOl̔zCfbNX
+    * @return float     :Tvx̒l
+    */
+    float sample(float u, float& pdf, int& index) const;
+
 private:
     std::vector<float> f;   /**< 1D敪֐̔z      */
     int n;                  /**< z̗vf          */
@@ -156,6 +350,14 @@ public:
     */
     Vec2 sample(float& pdf) const;
 
+    /**
+    * @brief lȃTvut֐@ŕϊ(u, v)Tv֐
+    * @param[in]  u   :[0, 1)^2̈lȃTv
+    * @param[out] pdf :TvOmx
+    * @return Vec2    :Tv(u,v)̒l
+    */
+    Vec2 sample(const Vec2& u, float& pdf) const;
+
     /**
     * @brief (u, v)TvOmx]֐
     * @param[out] uv:(u,v)W
@@ -168,4 +370,84 @@ private:
     int nv; /**< v̗vf */
     std::vector<std::unique_ptr<Piecewise1D>> conditional_pdf; /**< tmx(p[u|v]) */
     std::unique_ptr<Piecewise1D> merginal_pdf; /**< ӊmx(p[v]) */
+};
+
+
+/**
+* @brief GCAXe[uɂ1D敪֐
+* @note t֐@̓񕪒T̑O(1)ŋԂIԁDuƋԂ̑ΉPłȂ̂ŁC
+*       HႢʗ̑wPiecewise1DقǕۂȂ
+*/
+class AliasPiecewise1D {
+public:
+    /**
+    * @brief RXgN^
+    * @param[in] data :Uꂽ֐z
+    * @param[in] _n   :z̗vf
+    */
+    AliasPiecewise1D(const float* data, int _n);
+
+    int get_n() const { return n; }
+    float get_integral_f() const { return integral_f; }
+
+    /**
+    * @brief Ԃ̊mx擾֐
+    * @param[in] index :Ԃ̃CfbNX
+    * @return float    :[0, 1)̊mx
+    */
+    float get_pdf(int index) const { return table.get_pmf(index) * n; }
+
+    /**
+    * @brief lȃTvuGCAX@ŕϊxTv֐
+    * @param[in]  u     :[0, 1)̈lȃTv
+    * @param[out] pdf   :TvOmx
+    * @param[out] index :TvOl̔zCfbNX
+    * @return float     :Tvx̒l
+    */
+    float sample(float u, float& pdf, int& index) const;
+
+private:
+    AliasTable table;    /**< ԂIԃGCAXe[u */
+    int n;               /**< z̗vf                 */
+    float integral_f;    /**< f`Őϕl        */
+};
+
+
+/**
+* @brief GCAXe[uɂ2D敪֐
+* @note s(v)ƍs(u)̑IꂼO(1)ōs
+*/
+class AliasPiecewise2D {
+public:
+    /**
+    * @brief RXgN^
+    * @param[in] data :Uꂽ֐̔z
+    * @param[in] _nu  :u̗vf
+    * @param[in] _nv  :v̗vf
+    */
+    AliasPiecewise2D(const float* data, int _nu, int _nv);
+
+    int get_nu() const { return nu; }
+    int get_nv() const { return nv; }
+
+    /**
+    * @brief lȃTvuGCAX@ŕϊ(u, v)Tv֐
+    * @param[in]  u   :[0, 1)^2̈lȃTv
+    * @param[out] pdf :TvOmx
+    * @return Vec2    :Tv(u,v)̒l
+    */
+    Vec2 sample(const Vec2& u, float& pdf) const;
+
+    /**
+    * @brief (u, v)TvOmx]֐
+    * @param[in] uv :(u,v)W
+    * @return float :mx
+    */
+    float eval_pdf(const Vec2& uv) const;
+
+private:
+    int nu; /**< u̗vf */
+    int nv; /**< v̗vf */
+    std::vector<AliasPiecewise1D> conditional_pdf; /**< tmx(p[u|v]) */
+    std::unique_ptr<AliasPiecewise1D> marginal_pdf; /**< ӊmx(p[v])       */
 };
\ No newline at end of file
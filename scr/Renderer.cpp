@@ -1,10 +1,18 @@
 #include "Renderer.h"
 #include "external/stb_image_write.h"
 #include "external/stb_image.h"
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <csignal>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <iterator>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -17,8 +25,10 @@
 #include "Math.h"
 #include "Microfacet.h"
 #include "ONB.h"
+#include "Parallel.h"
 #include "Random.h"
 #include "Ray.h"
+#include "Sampler.h"
 #include "Scene.h"
 #include "Shape.h"
 #include "Math.h"
@@ -26,52 +36,256 @@
 
 // fobOp
 constexpr bool DEBUG_MODE = false; // (fobO[h)@Lɂ
-constexpr bool IS_GAMMA_CORRECTION = true;  // K}␳Lɂ
+
+constexpr int MAX_DEPTH = 100;       // C̍őoEX
+constexpr int WAVEFRONT_SIZE = 4096; // EF[utg@œɒǐՂpX̖̐ڈ
+
+/**
+* @brief sNZƂ̃Tvq[g}bvƂďo͂֐
+* @param[in] filename      :_O摜̃t@C(gq̑O_spptďo)
+* @param[in] w             :摜̕
+* @param[in] h             :摜̍
+* @param[in] sample_counts :sNZƂ̃Tv
+* @param[in] min_spp       :ŏTv()
+* @param[in] max_spp       :őTv()
+*/
+static void write_sample_heatmap(const std::string& filename, int w, int h,
+    const std::vector<int>& sample_counts, int min_spp, int max_spp) {
+    std::vector<uint8_t> img(w * h * 3);
+    double total = 0.0;
+    for (int i = 0; i < w * h; i++) {
+        total += sample_counts[i];
+        float t = max_spp > min_spp ? float(sample_counts[i] - min_spp) / (max_spp - min_spp) : 1.0f;
+        t = std::clamp(t, 0.f, 1.f);
+        // ->VA->->->Ԃ̃J[}bv
+        float r = std::clamp(1.5f - std::abs(4 * t - 3), 0.f, 1.f);
+        float g = std::clamp(1.5f - std::abs(4 * t - 2), 0.f, 1.f);
+        float b = std::clamp(1.5f - std::abs(4 * t - 1), 0.f, 1.f);
+        img[3 * i]     = static_cast<uint8_t>(r * 255);
+        img[3 * i + 1] = static_cast<uint8_t>(g * 255);
+        img[3 * i + 2] = static_cast<uint8_t>(b * 255);
+    }
+    auto dot_pos = filename.find_last_of('.');
+    auto heatmap_name = filename.substr(0, dot_pos) + "_spp.png";
+    stbi_write_png(heatmap_name.c_str(), w, h, 3, img.data(), w * 3 * sizeof(uint8_t));
+    std::cout << "average spp: " << total / (w * h) << " (" << heatmap_name << ")\n";
+}
+
+// *** vObVu_Õ`FbN|Cg ***
+
+// `FbN|Cǧ`̔(wb_sNZ̃f[^ςXV)
+constexpr uint32_t CHECKPOINT_VERSION = 2;
+
+/** `FbN|Cgt@C̃wb_(ɃsNZƂ̓vʂ) */
+struct CheckpointHeader {
+    char magic[4] = { 'T', 'P', 'C', 'K' }; /**< t@C̎ʎq                     */
+    uint32_t version = CHECKPOINT_VERSION;  /**< `̔                             */
+    uint32_t layout = (uint32_t)sizeof(PixelStats); /**< \̂̑傫̊mFp̒l */
+    int32_t w = 0;                          /**< 摜̕                             */
+    int32_t h = 0;                          /**< 摜̍                           */
+    int32_t spp = 0;                        /**< ڕW̃Tv                     */
+    uint32_t sampler_type = 0;              /**< Tv[̎                     */
+    uint32_t strategy = 0;                  /**< ̃TvO헪               */
+    uint64_t scene_hash = 0;                /**< V[Lqt@CƃJ̃nbVl */
+    double elapsed = 0.0;                   /**< ܂ł̃_OԂ̍v[b] */
+};
 
 /**
-* @brief  Low-Discrepancy̐ɗp֐
-* @param[in] i  :
-* @return float :[0,1]̎
-* @note // Ref. T. Kollig and A. Keller. "Efficient Multidimensional Sampling" 2002.
+* @brief `FbN|Cg̏ƍɎgV[ƃJ̃nbVlvZ֐
+* @param[in] scene_path :V[Lqt@C̃pX(Ȃgݍ݂̃V[)
+* @param[in] cam        :J
+* @return uint64_t      :nbVl(FNV-1a)
+* @note V[QƂ.objt@C}bv̓e͊܂܂Ȃ
 */
-float radical_inverse(unsigned int i) {
-    i = (i << 16) | (i >> 16);
-    i = ((i & 0x00FF00FF) << 8) | ((i & 0xFF00FF00) >> 8);
-    i = ((i & 0x0F0F0F0F) << 4) | ((i & 0xF0F0F0F0) >> 4);
-    i = ((i & 0x33333333) << 2) | ((i & 0xCCCCCCCC) >> 2);
-    i = ((i & 0x55555555) << 1) | ((i & 0xAAAAAAAA) >> 1);
-    return (float)i / (float)0x100000000;
+static uint64_t hash_scene(const std::string& scene_path, const Camera& cam) {
+    uint64_t hash = 14695981039346656037ull;
+    auto add_bytes = [&](const void* data, size_t size) {
+        auto bytes = (const unsigned char*)data;
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+    if (!scene_path.empty()) {
+        std::ifstream ifs(scene_path, std::ios::binary);
+        std::string contents((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+        add_bytes(contents.data(), contents.size());
+    }
+    // J̌_ƃtB3ւ̃CŃJ̔zuƉp\
+    const float corners[3][2] = { { 0.f, 0.f }, { 1.0f, 0.f }, { 0.f, 1.0f } };
+    for (const auto& c : corners) {
+        auto r = cam.generate_ray(c[0], c[1]);
+        const float v[6] = { r.get_origin()[0], r.get_origin()[1], r.get_origin()[2],
+                             r.get_dir()[0], r.get_dir()[1], r.get_dir()[2] };
+        add_bytes(v, sizeof(v));
+    }
+    return hash;
 }
 
+/**
+* @brief `FbN|Cgo֐
+* @param[in] path   :`FbN|Cg̃pX
+* @param[in] header :wb_
+* @param[in] stats  :sNZƂ̓v
+* @return bool      :otrue
+* @note ꎞt@CɏĂûŁCoɒfĂÕ`FbN|Cgc
+*/
+static bool write_checkpoint(const std::string& path, const CheckpointHeader& header,
+    const std::vector<PixelStats>& stats) {
+    const std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream ofs(tmp_path, std::ios::binary);
+        if (!ofs) {
+            return false;
+        }
+        ofs.write((const char*)&header, sizeof(header));
+        ofs.write((const char*)stats.data(), stats.size() * sizeof(PixelStats));
+        if (!ofs) {
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, path, ec);
+    return !ec;
+}
 
-Renderer::Renderer(int _spp, Sampling _strategy)
-    : spp(_spp), strategy(_strategy)
+/**
+* @brief `FbN|Cgǂݍފ֐
+* @param[in]     path   :`FbN|Cg̃pX
+* @param[in,out] header :wb_(摜̑傫TvO̐ݒCV[v邩mFCoߎԂǂݍ)
+* @param[out]    stats  :sNZƂ̓v
+* @return bool          :ݒƃV[̈v`FbN|Cgǂݍ߂true
+*/
+static bool read_checkpoint(const std::string& path, CheckpointHeader& header,
+    std::vector<PixelStats>& stats) {
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs) {
+        return false;
+    }
+    CheckpointHeader file_header;
+    ifs.read((char*)&file_header, sizeof(file_header));
+    if (!ifs || std::memcmp(file_header.magic, header.magic, sizeof(header.magic)) != 0 ||
+        file_header.version != header.version || file_header.layout != header.layout ||
+        file_header.w != header.w || file_header.h != header.h || file_header.spp != header.spp ||
+        file_header.sampler_type != header.sampler_type || file_header.strategy != header.strategy) {
+        std::cerr << path << ": checkpoint does not match the render settings\n";
+        return false;
+    }
+    if (file_header.scene_hash != header.scene_hash) {
+        std::cerr << path << ": checkpoint was rendered from a different scene or camera\n";
+        return false;
+    }
+    std::vector<PixelStats> file_stats(stats.size());
+    ifs.read((char*)file_stats.data(), file_stats.size() * sizeof(PixelStats));
+    if (!ifs) {
+        std::cerr << path << ": checkpoint is truncated\n";
+        return false;
+    }
+    header.elapsed = file_header.elapsed;
+    stats = std::move(file_stats);
+    return true;
+}
+
+// Iv(SIGINT/SIGTERM)󂯂true(VOinh珑ނ̂ŃbNt[atomicg)
+static std::atomic<bool> is_stop_requested(false);
+
+/**
+* @brief IvL^VOinh
+* @param[in] sig :VOiԍ
+*/
+static void request_stop(int sig) {
+    is_stop_requested = true;
+}
+
+
+Renderer::Renderer(int _spp, Sampling _strategy, int _num_threads, SamplerType _sampler_type)
+    : spp(_spp), strategy(_strategy), sampler_type(_sampler_type), num_threads(_num_threads),
+    tile_size(16), error_threshold(0.f), max_spp(_spp), is_wavefront(false),
+    pass_spp(0), time_budget(0.f), checkpoint_interval(60.f), node_index(0), num_nodes(1)
 {}
 
-Vec3 Renderer::explict_uniform(const Ray& r, const intersection& isect, 
-    const Scene& world, const ONB& shading_coord) const {
-    auto Ld = Vec3::zero;
+void Renderer::set_adaptive_sampling(float _error_threshold, int _max_spp) {
+    error_threshold = _error_threshold;
+    max_spp = std::max(_max_spp, spp);
+}
+
+void Renderer::set_progressive(int _pass_spp, float _time_budget, const std::string& _scene_path,
+    float _checkpoint_interval, const std::string& _checkpoint_path) {
+    pass_spp = _pass_spp;
+    time_budget = _time_budget;
+    scene_path = _scene_path;
+    checkpoint_interval = _checkpoint_interval;
+    checkpoint_path = _checkpoint_path;
+}
+
+void Renderer::set_distributed(int _node_index, int _num_nodes) {
+    num_nodes = std::max(_num_nodes, 1);
+    node_index = std::clamp(_node_index, 0, num_nodes - 1);
+}
+
 
+// *** sNZl̓v ***
+
+void PixelStats::add(const Vec3& L) {
+    n++;
+    sum += L;
+    float y = luminance(L);
+    float delta = y - mean_y;
+    mean_y += delta / n;
+    m2_y += delta * (y - mean_y);
+}
+
+Vec3 PixelStats::get_mean() const {
+    return n > 0 ? sum * (1.0f / n) : Vec3::zero;
+}
+
+float PixelStats::relative_error() const {
+    if (n < 2) {
+        return inf;
+    }
+    float variance = m2_y / (n - 1);
+    float std_error = std::sqrt(variance / n);
+    // ÂsNZ臒lȂ肷Ȃ悤ɕɉ݂
+    return std_error / std::max(mean_y, 1e-3f);
+}
+
+// *** EF[utg@̃pX̃L[ ***
+
+void PathQueue::clear() {
+    origin.clear();
+    dir.clear();
+    contrib.clear();
+    path_index.clear();
+    dimension.clear();
+    is_specular.clear();
+}
+
+void PathQueue::push(const Vec3& o, const Vec3& d, const Vec3& beta, int index, int dim, bool is_spec) {
+    origin.push_back(o);
+    dir.push_back(d);
+    contrib.push_back(beta);
+    path_index.push_back(index);
+    dimension.push_back(dim);
+    is_specular.push_back(is_spec);
+}
+
+
+bool Renderer::explict_uniform(const Ray& r, const intersection& isect, const Scene& world,
+    const ONB& shading_coord, Sampler& sampler, ShadowRay& shadow) const {
     // ˕_ɃTvO
-    Vec3 wi_local = Random::uniform_hemisphere_sample();
+    Vec3 wi_local = Random::uniform_hemisphere_sample(sampler.get_2d());
     Vec3 wi = shading_coord.to_world(wi_local);
 
     // ւ̃CƌȂΊ^̓[
     auto r_to_light = Ray(isect.pos, wi); // ֌̃C
     intersection isect_light;
     if (!world.intersect_light(r_to_light, eps_isect, inf, isect_light)) {
-        return Ld;
+        return false;
     }
 
     // ̕ˋPxvZ
     auto L = isect_light.light->evel_light(wi);
     if (is_zero(L)) {
-        return Ld;
-    }
-
-    // ւ̃CVFCvɎՕƊ^̓[
-    if (world.intersect_object(r_to_light, eps_isect, isect_light.t)) {
-        return Ld;
+        return false;
     }
 
     // TvOłBSDFpdf]
@@ -79,18 +293,17 @@ Vec3 Renderer::explict_uniform(const Ray& r, const intersection& isect,
     auto wo_local = -shading_coord.to_local(wo); // ̕\ʂ痣
     auto bsdf = isect.mat->eval_f(wo_local, wi_local, isect);
     if (is_zero(bsdf)) {
-        return Ld;
+        return false;
     }
     float pdf_scattering = 0.5f * invpi; // lTvÔ
-    // ^̌vZ
+    // ^̌vZ(ւ̃CVFCvɎՕƊ^̓[)
     auto cos_term = dot(isect.normal, wi);
-    Ld += bsdf * cos_term * L / pdf_scattering;
-    return Ld;
+    shadow = { isect.pos, wi, isect_light.t, bsdf * cos_term * L / pdf_scattering };
+    return true;
 }
 
-Vec3 Renderer::explict_bsdf(const Ray& r, const intersection& isect, 
-    const Scene& world, const ONB& shading_coord) const{
-    auto Ld = Vec3::zero;
+bool Renderer::explict_bsdf(const Ray& r, const intersection& isect, const Scene& world,
+    const ONB& shading_coord, Sampler& sampler, ShadowRay& shadow) const {
     Vec3 wi_local;
     float pdf_scattering, pdf_light, weight = 1.0f;
 
@@ -98,9 +311,11 @@ Vec3 Renderer::explict_bsdf(const Ray& r, const intersection& isect,
     auto wo = unit_vector(r.get_dir());
     auto wo_local = -shading_coord.to_local(wo);
     BxDFType sampled_type;
-    auto bsdf = isect.mat->sample_f(wo_local, isect, wi_local, pdf_scattering, sampled_type);
+    auto u_bxdf = sampler.get_1d();
+    auto u = sampler.get_2d();
+    auto bsdf = isect.mat->sample_f(wo_local, isect, wi_local, pdf_scattering, sampled_type, u_bxdf, u);
     if (pdf_scattering == 0 || is_zero(bsdf)) {
-        return Ld;
+        return false;
     }
     auto wi = shading_coord.to_world(wi_local); // ڌ̓˕(_痣)
 
@@ -108,61 +323,61 @@ Vec3 Renderer::explict_bsdf(const Ray& r, const intersection& isect,
     auto r_to_light = Ray(isect.pos, wi); // ֌̃C
     intersection isect_light;
     if (!world.intersect_light(r_to_light, eps_isect, inf, isect_light)) {
-        return Ld;
+        return false;
     }
 
     // ̕ˋPxvZ
     auto L = isect_light.light->evel_light(wi);
     pdf_light = isect_light.light->eval_pdf(isect, wi);
     if (pdf_light == 0 || is_zero(L)) {
-        return Ld;
+        return false;
     }
-
-    // ւ̃CVFCvɎՕƊ^̓[
-    if (world.intersect_object(r_to_light, eps_isect, isect_light.t)) {
-        return Ld;
+    // TvOƓmŔr邽ߌ̑Iml
+    // NOTE: Im[̌͌TvOőI΂Ȃ̂MISd݂1ɂȂ
+    if (const auto* light_sampler = world.get_light_sampler()) {
+        pdf_light *= light_sampler->eval_pmf(isect, isect_light.light);
     }
 
-    // ^̌vZ
+    // ^̌vZ(ւ̃CVFCvɎՕƊ^̓[)
     bool is_delta_bxdf = is_spacular_type(sampled_type); // f^zȂMISd݂1
     if (strategy == Sampling::MIS && !is_delta_bxdf) {
         weight = Random::power_heuristic(1, pdf_scattering, 1, pdf_light);
     }
     auto cos_term = dot(isect.normal, wi);
-    Ld += bsdf * cos_term * weight * L / pdf_scattering;
-    return Ld;
+    shadow = { isect.pos, wi, isect_light.t, bsdf * cos_term * weight * L / pdf_scattering };
+    return true;
 }
 
-Vec3 Renderer::explict_one_light(const Ray& r, const intersection& isect, 
-    const Scene& world, const ONB& shading_coord) const {
-    auto Ld = Vec3::zero;
+bool Renderer::explict_one_light(const Ray& r, const intersection& isect, const Scene& world,
+    const ONB& shading_coord, Sampler& sampler, ShadowRay& shadow) const {
     Vec3 wi; // ̓˕(_痣)
     float pdf_scattering, pdf_light, weight = 1.0f;
 
-    // _ɈI
-    // TODO: GlM[zx[XɌIт
-    const auto& lights = world.get_light();
-    int num_lights = (int)lights.size();
-    if (num_lights == 0) {
-        return Ld;
+    // Iɏ]ČI
+    // NOTE: g̐ςȂ悤ɑ^[̑OɃTv𐶐
+    auto u_light = sampler.get_1d();
+    auto u = sampler.get_2d();
+    const auto* light_sampler = world.get_light_sampler();
+    if (light_sampler == nullptr) {
+        return false;
+    }
+    float light_pmf;
+    const auto* light = light_sampler->sample(isect, u_light, light_pmf);
+    if (light == nullptr || light_pmf == 0) {
+        return false;
     }
-    auto light_index = Random::uniform_int(0, num_lights - 1);
-    const auto& light = lights[light_index];
 
     // I񂾌˕TvO
-    auto L = light->sample_light(isect, wi, pdf_light);
+    auto L = light->sample_light(isect, wi, pdf_light, u);
     if (pdf_light == 0 || is_zero(L)) {
-        return Ld;
+        return false;
     }
-    pdf_light = pdf_light / num_lights; // ̃_ȑIl
+    pdf_light = pdf_light * light_pmf; // ̑Iml
 
-    // ւ̃CՕƊ^̓[
+    // ̌_擾
     auto r_to_light = Ray(isect.pos, wi); // ֌C
     intersection isect_light;
-    light->intersect(r_to_light, eps_isect, inf, isect_light); // ̌_擾
-    if (world.intersect_object(r_to_light, eps_isect, isect_light.t)) {
-        return Ld;
-    }
+    light->intersect(r_to_light, eps_isect, inf, isect_light);
 
     // TvO˕łBSDF]
     auto wo = unit_vector(r.get_dir());
@@ -171,43 +386,67 @@ Vec3 Renderer::explict_one_light(const Ray& r, const intersection& isect,
     auto bsdf = isect.mat->eval_f(wo_local, wi_local, isect);
     pdf_scattering = isect.mat->eval_pdf(wo_local, wi_local, isect);
     if (pdf_scattering == 0 || is_zero(bsdf)) {
-        return Ld;
+        return false;
     }
 
-    // ^̌vZ
+    // ^̌vZ(ւ̃CՕƊ^̓[)
     bool is_delta_light = light->is_delta_light(); // f^zȂMISd݂1
     if (strategy == Sampling::MIS && !is_delta_light) {
         weight = Random::power_heuristic(1, pdf_light, 1, pdf_scattering);
     }
     auto cos_term = std::abs(dot(isect.normal, wi));
-    Ld += bsdf * L * cos_term * weight / pdf_light;
-    return Ld;
+    shadow = { isect.pos, wi, isect_light.t, bsdf * L * cos_term * weight / pdf_light };
+    return true;
 }
 
-Vec3 Renderer::explicit_direct_light_sampling(const Ray& r, const intersection& isect,
-    const Scene& world, const ONB& shading_coord) const {
-    auto Ld = Vec3::zero;
+int Renderer::sample_direct_light(const Ray& r, const intersection& isect, const Scene& world,
+    const ONB& shading_coord, Sampler& sampler, ShadowRay shadows[2]) const {
+    int num_shadows = 0;
     // lTvO
     if (strategy == Sampling::UNIFORM) {
-        auto L = explict_uniform(r, isect, world, shading_coord);
-        Ld += exclude_invalid(L);
-        return Ld;
+        auto& shadow = shadows[num_shadows];
+        if (explict_uniform(r, isect, world, shading_coord, sampler, shadow)) {
+            shadow.Ld = exclude_invalid(shadow.Ld);
+            num_shadows++;
+        }
+        return num_shadows;
     }
     // BSDFɊÂTvO
     if ((strategy == Sampling::BSDF) || (strategy == Sampling::MIS)) {
-        auto L = explict_bsdf(r, isect, world, shading_coord);
-        Ld += exclude_invalid(L);
+        auto& shadow = shadows[num_shadows];
+        if (explict_bsdf(r, isect, world, shading_coord, sampler, shadow)) {
+            shadow.Ld = exclude_invalid(shadow.Ld);
+            num_shadows++;
+        }
     }
     // ɊÂTvO
     if ((strategy == Sampling::LIGHT) || (strategy == Sampling::MIS)) {
-        auto L = explict_one_light(r, isect, world, shading_coord);
-        Ld += exclude_invalid(L);
+        auto& shadow = shadows[num_shadows];
+        if (explict_one_light(r, isect, world, shading_coord, sampler, shadow)) {
+            shadow.Ld = exclude_invalid(shadow.Ld);
+            num_shadows++;
+        }
+    }
+    return num_shadows;
+}
+
+Vec3 Renderer::explicit_direct_light_sampling(const Ray& r, const intersection& isect,
+    const Scene& world, const ONB& shading_coord, Sampler& sampler) const {
+    auto Ld = Vec3::zero;
+    ShadowRay shadows[2];
+    int num_shadows = sample_direct_light(r, isect, world, shading_coord, sampler, shadows);
+    // ւ̃CVFCvɎՕȂΊ^Z
+    for (int i = 0; i < num_shadows; i++) {
+        const auto& s = shadows[i];
+        if (!world.occluded(Ray(s.origin, s.dir), eps_isect, s.t_max)) {
+            Ld += s.Ld;
+        }
     }
     return Ld;
 }
 
 
-Vec3 Renderer::L_raytracing(const Ray& r_in, int max_depth, const Scene& world) const {
+Vec3 Renderer::L_raytracing(const Ray& r_in, int max_depth, const Scene& world, Sampler& sampler) const {
     const int RUSSIAN_ROULETTE = 1;
     const int SPLIT_SAMPLES = 1; // VhEC̃Tv
     auto L = Vec3::zero, contrib = Vec3::one;
@@ -232,7 +471,7 @@ Vec3 Renderer::L_raytracing(const Ray& r_in, int max_depth, const Scene& world)
         // ̂XyLłȂȂ璼ڌ̃TvO
         if (!isect.mat->is_perfect_specular()) {
             for (int i = 0; i < SPLIT_SAMPLES; i++) {
-                L += contrib * explicit_direct_light_sampling(r, isect, world, shading_coord);
+                L += contrib * explicit_direct_light_sampling(r, isect, world, shading_coord, sampler);
             }
             L /= SPLIT_SAMPLES;
             break;
@@ -243,7 +482,9 @@ Vec3 Renderer::L_raytracing(const Ray& r_in, int max_depth, const Scene& world)
         Vec3 wi_local;
         float pdf;
         BxDFType sampled_type;
-        auto bsdf = isect.mat->sample_f(wo_local, isect, wi_local, pdf, sampled_type);
+        auto u_bxdf = sampler.get_1d();
+        auto u = sampler.get_2d();
+        auto bsdf = isect.mat->sample_f(wo_local, isect, wi_local, pdf, sampled_type, u_bxdf, u);
         auto wi = shading_coord.to_world(wi_local);
 
         // ^̍XV
@@ -253,7 +494,7 @@ Vec3 Renderer::L_raytracing(const Ray& r_in, int max_depth, const Scene& world)
         //VA[bg
         if (bounces >= RUSSIAN_ROULETTE) {
             float p_rr = std::max(0.05f, 1.0f - contrib.average()); // ł؂m
-            if (p_rr > Random::uniform_float()) break;
+            if (p_rr > sampler.get_1d()) break;
             contrib /= std::max(epsilon, 1.0f - p_rr);
         }
 
@@ -271,7 +512,7 @@ Vec3 Renderer::L_raytracing(const Ray& r_in, int max_depth, const Scene& world)
 * @param[in]  world     :_OV[̃f[^
 * @return Vec3          :CɉˋPx
 */
-Vec3 Renderer::L_naive_pathtracing(const Ray& r_in, int max_depth, const Scene& world) const {
+Vec3 Renderer::L_naive_pathtracing(const Ray& r_in, int max_depth, const Scene& world, Sampler& sampler) const {
     const int RUSSIAN_ROULETTE = 1;
     auto L = Vec3::zero, contrib = Vec3::one;
     Ray r = Ray(r_in);
@@ -299,7 +540,9 @@ Vec3 Renderer::L_naive_pathtracing(const Ray& r_in, int max_depth, const Scene&
         Vec3 wi_local;
         float pdf;
         BxDFType sampled_type;
-        auto bsdf = isect.mat->sample_f(wo_local, isect, wi_local, pdf, sampled_type);
+        auto u_bxdf = sampler.get_1d();
+        auto u = sampler.get_2d();
+        auto bsdf = isect.mat->sample_f(wo_local, isect, wi_local, pdf, sampled_type, u_bxdf, u);
         if (pdf == 0.0f || is_zero(bsdf)) break;
         auto wi = shading_coord.to_world(wi_local); // TvO˕
         auto cos_term = std::abs(dot(isect.normal, wi));
@@ -310,7 +553,7 @@ Vec3 Renderer::L_naive_pathtracing(const Ray& r_in, int max_depth, const Scene&
         //VA[bg
         if (bounces >= RUSSIAN_ROULETTE) {
             float p_rr = std::max(0.05f, 1.0f - contrib.average()); // ł؂m
-            if (p_rr > Random::uniform_float()) break;
+            if (p_rr > sampler.get_1d()) break;
             contrib /= std::max(epsilon, 1.0f - p_rr);
         }
     }
@@ -318,7 +561,7 @@ Vec3 Renderer::L_naive_pathtracing(const Ray& r_in, int max_depth, const Scene&
 }
 
 
-Vec3 Renderer::L_pathtracing(const Ray& r_in, int max_depth, const Scene& world) const {
+Vec3 Renderer::L_pathtracing(const Ray& r_in, int max_depth, const Scene& world, Sampler& sampler) const {
     const int RUSSIAN_ROULETTE = 1;
     auto L = Vec3::zero, contrib = Vec3::one;
     Ray r = Ray(r_in);
@@ -353,7 +596,7 @@ Vec3 Renderer::L_pathtracing(const Ray& r_in, int max_depth, const Scene& world)
 
         // ̂XyLłȂȂ璼ڌ̃TvO
         if (!isect.mat->is_perfect_specular()) {
-            L += contrib * explicit_direct_light_sampling(r, isect, world, shading_coord);
+            L += contrib * explicit_direct_light_sampling(r, isect, world, shading_coord, sampler);
         }
 
         // BSDFɊÂoH()̃TvO
@@ -361,7 +604,9 @@ Vec3 Renderer::L_pathtracing(const Ray& r_in, int max_depth, const Scene& world)
         Vec3 wi_local;
         float pdf;
         BxDFType sampled_type;
-        auto bsdf = isect.mat->sample_f(wo_local, isect, wi_local, pdf, sampled_type);
+        auto u_bxdf = sampler.get_1d();
+        auto u = sampler.get_2d();
+        auto bsdf = isect.mat->sample_f(wo_local, isect, wi_local, pdf, sampled_type, u_bxdf, u);
         if (pdf == 0.0f || is_zero(bsdf)) break;
         auto wi = shading_coord.to_world(wi_local);
 
@@ -372,7 +617,7 @@ Vec3 Renderer::L_pathtracing(const Ray& r_in, int max_depth, const Scene& world)
         //VA[bg
         if (bounces >= RUSSIAN_ROULETTE) {
             float p_rr = std::max(0.05f, 1.0f - contrib.average()); // ł؂m
-            if (p_rr > Random::uniform_float()) break;
+            if (p_rr > sampler.get_1d()) break;
             contrib /= std::max(epsilon, 1.0f - p_rr);
         }
 
@@ -399,51 +644,391 @@ Vec3 Renderer::L_normal(const Ray& r, const Scene& world) const {
 }
 
 
-void Renderer::render(const Scene& world, const Camera& cam) const {
-    const int max_depth = 100;
-    Random::init(); // ̏
+Vec3 Renderer::render_pixel(int x, int y, const Scene& world, const Camera& cam,
+    Sampler& sampler, int& num_samples) const {
+    PixelStats stats;
+    if (error_threshold > 0) {
+        // sppƂɎ𔻒
+        while (stats.n < max_spp) {
+            add_pixel_samples(x, y, world, cam, sampler, std::min(stats.n + spp, max_spp), stats);
+            if (stats.n % spp == 0 && stats.relative_error() < error_threshold) {
+                break;
+            }
+        }
+    }
+    else {
+        add_pixel_samples(x, y, world, cam, sampler, spp, stats);
+    }
+    num_samples = stats.n;
+    return stats.get_mean();
+}
+
+
+void Renderer::add_pixel_samples(int x, int y, const Scene& world, const Camera& cam,
+    Sampler& sampler, int k_end, PixelStats& stats) const {
+    const int max_depth = MAX_DEPTH;
+    const auto w = cam.get_w();
+    const auto h = cam.get_h();
+    for (int k = stats.n; k < k_end; k++) {
+        sampler.start_pixel_sample(x, y, k);
+        Vec2 uv = sampler.get_2d(); // sNZ̈ʒu
+        Ray r = cam.generate_ray((x + uv[0]) / (w - 1), (y + uv[1]) / (h - 1));
+        Vec3 L;
+        if (DEBUG_MODE) {
+            L = L_normal(r, world);
+        }
+        else {
+            //L = L_raytracing(r, max_depth, world, sampler);
+            //L = L_naive_pathtracing(r, max_depth, world, sampler);
+            L = L_pathtracing(r, max_depth, world, sampler);
+        }
+        stats.add(exclude_invalid(L));
+    }
+}
+
+
+void Renderer::render_tile_wavefront(int x0, int y0, int x1, int y1, const Scene& world,
+    const Camera& cam, Sampler& sampler, std::vector<Vec3>& colors) const {
+    const int RUSSIAN_ROULETTE = 1;
+    const auto w = cam.get_w();
+    const auto h = cam.get_h();
+    const int tile_w = x1 - x0;
+    const int num_pixels = tile_w * (y1 - y0);
+    // 1̃EF[uŃ^C̑SsNZ̕Tv܂Ƃ߂Ēǐ
+    const int samples_per_wave = std::max(1, std::min(spp, WAVEFRONT_SIZE / num_pixels));
+    std::vector<PixelStats> stats(num_pixels);
+    std::vector<Vec3> L(samples_per_wave * num_pixels); // pXƂ̕ˋPx
+    PathQueue queue, next_queue;
+    std::vector<intersection> isects;
+    std::vector<uint8_t> is_hit;
+    std::vector<int> active;              // VF[fBOpX
+    std::vector<Vec3> contrib_direct, Ld; // ڌ𐄒肵_̃pX̊^ƒڌ
+    std::vector<uint8_t> has_direct;
+    std::vector<ShadowRay> shadow_rays;
+    std::vector<int> shadow_path;         // VhEC𐶐pX
+    for (int k0 = 0; k0 < spp; k0 += samples_per_wave) {
+        const int num_samples = std::min(samples_per_wave, spp - k0);
+
+        // JC̐
+        queue.clear();
+        for (int s = 0; s < num_samples; s++) {
+            for (int p = 0; p < num_pixels; p++) {
+                int x = x0 + p % tile_w;
+                int y = y0 + p / tile_w;
+                sampler.start_pixel_sample(x, y, k0 + s);
+                Vec2 uv = sampler.get_2d(); // sNZ̈ʒu
+                Ray r = cam.generate_ray((x + uv[0]) / (w - 1), (y + uv[1]) / (h - 1));
+                int index = s * num_pixels + p;
+                L[index] = Vec3::zero;
+                queue.push(r.get_origin(), r.get_dir(), Vec3::one, index, sampler.get_dimension(), false);
+            }
+        }
+
+        for (int bounces = 0; bounces < MAX_DEPTH && queue.size() > 0; bounces++) {
+            const int n = queue.size();
+
+            // 
+            isects.assign(n, intersection());
+            is_hit.resize(n);
+            for (int i = 0; i < n; i++) {
+                is_hit[i] = world.intersect(Ray(queue.origin[i], queue.dir[i]), eps_isect, inf, isects[i]);
+            }
+
+            // Ƃ̌ɂ^̉ZƏI
+            active.clear();
+            for (int i = 0; i < n; i++) {
+                if (!is_hit[i]) continue;
+                const auto& isect = isects[i];
+                if (isect.type == IsectType::Light) {
+                    // JCƃXyLC͌̊^Z
+                    if (bounces == 0 || queue.is_specular[i]) {
+                        auto& Lp = L[queue.path_index[i]];
+                        // ʌ@t̏ꍇ͌TvȂ
+                        if (isect.light->get_type() == LightType::Area && !isect.is_front) {
+                            Lp = Vec3::zero;
+                        }
+                        else {
+                            Lp += queue.contrib[i] * isect.light->evel_light(queue.dir[i]);
+                        }
+                    }
+                    continue;
+                }
+                active.push_back(i);
+            }
+
+            // }eÃpX܂Ƃ߂ăVF[fBO
+            std::stable_sort(active.begin(), active.end(), [&](int a, int b) {
+                return isects[a].mat < isects[b].mat;
+            });
+            next_queue.clear();
+            contrib_direct.resize(n);
+            Ld.assign(n, Vec3::zero);
+            has_direct.assign(n, 0);
+            shadow_rays.clear();
+            shadow_path.clear();
+            for (int i : active) {
+                const auto& isect = isects[i];
+                const int index = queue.path_index[i];
+                const int p = index % num_pixels;
+                sampler.resume_pixel_sample(x0 + p % tile_w, y0 + p / tile_w, k0 + index / num_pixels,
+                                            queue.dimension[i]);
+                Ray r(queue.origin[i], queue.dir[i]);
+                auto contrib = queue.contrib[i];
+                ONB shading_coord(isect.is_front ? isect.normal : -isect.normal); // ߑȂ@𔽓]
+
+                // ̂XyLłȂȂ璼ڌ̃VhEC𐶐
+                if (!isect.mat->is_perfect_specular()) {
+                    ShadowRay shadows[2];
+                    int num_shadows = sample_direct_light(r, isect, world, shading_coord, sampler, shadows);
+                    for (int j = 0; j < num_shadows; j++) {
+                        shadow_rays.push_back(shadows[j]);
+                        shadow_path.push_back(i);
+                    }
+                    contrib_direct[i] = contrib;
+                    has_direct[i] = 1;
+                }
+
+                // BSDFɊÂoH()̃TvO
+                Vec3 wo_local = -shading_coord.to_local(unit_vector(r.get_dir())); // ̕\ʂ痣
+                Vec3 wi_local;
+                float pdf;
+                BxDFType sampled_type;
+                auto u_bxdf = sampler.get_1d();
+                auto u = sampler.get_2d();
+                auto bsdf = isect.mat->sample_f(wo_local, isect, wi_local, pdf, sampled_type, u_bxdf, u);
+                if (pdf == 0.0f || is_zero(bsdf)) continue;
+                auto wi = shading_coord.to_world(wi_local);
+
+                // ^̍XV
+                auto cos_term = std::abs(dot(isect.normal, wi));
+                contrib = contrib * bsdf * cos_term / pdf;
+
+                //VA[bg
+                if (bounces >= RUSSIAN_ROULETTE) {
+                    float p_rr = std::max(0.05f, 1.0f - contrib.average()); // ł؂m
+                    if (p_rr > sampler.get_1d()) continue;
+                    contrib /= std::max(epsilon, 1.0f - p_rr);
+                }
+
+                // ̃C𐶐
+                next_queue.push(isect.pos, wi, contrib, index, sampler.get_dimension(),
+                                is_spacular_type(sampled_type));
+            }
+
+            // VhEC̎Օ܂Ƃ߂čsڌZ
+            for (int j = 0; j < (int)shadow_rays.size(); j++) {
+                const auto& s = shadow_rays[j];
+                if (!world.occluded(Ray(s.origin, s.dir), eps_isect, s.t_max)) {
+                    Ld[shadow_path[j]] += s.Ld;
+                }
+            }
+            for (int i : active) {
+                if (has_direct[i]) {
+                    L[queue.path_index[i]] += contrib_direct[i] * Ld[i];
+                }
+            }
+            std::swap(queue, next_queue);
+        }
+
+        // Tvԍ̏ɃsNZ֏Wv
+        for (int s = 0; s < num_samples; s++) {
+            for (int p = 0; p < num_pixels; p++) {
+                stats[p].add(exclude_invalid(L[s * num_pixels + p]));
+            }
+        }
+    }
+    colors.resize(num_pixels);
+    for (int p = 0; p < num_pixels; p++) {
+        colors[p] = stats[p].get_mean();
+    }
+}
+
 
+
+void Renderer::render(const Scene& world, const Camera& cam) const {
+    if (pass_spp > 0 && num_nodes > 1) {
+        // ݒ̈قĖȂ悤ɉ_OȂ
+        std::cerr << "progressive rendering is not supported in distributed rendering\n";
+        return;
+    }
+    if (pass_spp > 0) {
+        render_progressive(world, cam);
+        return;
+    }
     // o͉摜̐ݒ
     const auto w = cam.get_w(); // 
     const auto h = cam.get_h(); // 
-    const auto c = cam.get_c(); // `l
-    std::vector<uint8_t> img(w * h * c);  // 摜f[^
+    auto film = cam.get_film();            // ˋPxރtB
+    std::vector<int> sample_counts(w * h); // sNZƂ̃Tv
+
+    // 摜^Cɕ
+    const int num_tiles_x = (w + tile_size - 1) / tile_size;
+    const int num_tiles_y = (h + tile_size - 1) / tile_size;
+    const int num_tiles = num_tiles_x * num_tiles_y;
+    // U_Oł̓^CԍɊevZX֊蓖Ă
+    const int num_node_tiles = (num_tiles - node_index + num_nodes - 1) / num_nodes;
 
     // Cg[VO
     auto start_time = std::chrono::system_clock::now(); // vJn
-    int index = 0;
-    for (int y = 0; y < h; y++) {
-        std::cout << '\r' << y + 1 << '/' << h << std::flush;
-        for (int x = 0; x < w; x++) {
-            Vec3 I(0.f, 0.f, 0.f);
-            // indexԖڂ̃sNZ̃Tv𐶐
-            for (int k = 0; k < spp; k++) {
-                //Vec2 uv(float(k)/spp, radical_inverse(k)); // Low-Discrepancy𗘗p
-                Vec2 uv(Random::uniform_float(), Random::uniform_float()); // lTvO
-                Ray r = cam.generate_ray((x + uv[0]) / (w - 1), (y + uv[1]) / (h - 1));
-                Vec3 L;
-                if (DEBUG_MODE) {
-                    L = L_normal(r, world);
+    ThreadPool pool(num_threads);
+    std::atomic<int> num_done(0); // ^C
+    std::mutex mtx_progress;      // i\̔r
+    pool.parallel_for(num_node_tiles, [&](int node_tile, int thread_id) {
+        auto sampler = create_sampler(sampler_type, spp);
+        const int tile = node_index + node_tile * num_nodes;
+        const int x0 = (tile % num_tiles_x) * tile_size;
+        const int y0 = (tile / num_tiles_x) * tile_size;
+        const int x1 = std::min(x0 + tile_size, w);
+        const int y1 = std::min(y0 + tile_size, h);
+        // EF[utg@Ȃ^CŜ܂Ƃ߂Ēǐ
+        std::vector<Vec3> colors;
+        const bool use_wavefront = is_wavefront && !DEBUG_MODE && error_threshold <= 0;
+        if (use_wavefront) {
+            render_tile_wavefront(x0, y0, x1, y1, world, cam, *sampler, colors);
+        }
+        for (int y = y0; y < y1; y++) {
+            for (int x = x0; x < x1; x++) {
+                Vec3 I;
+                if (use_wavefront) {
+                    I = colors[(y - y0) * (x1 - x0) + (x - x0)];
+                    sample_counts[y * w + x] = spp;
                 }
                 else {
-                    //L = L_raytracing(r, max_depth, world);
-                    //L = L_naive_pathtracing(r, max_depth, world);
-                    L = L_pathtracing(r, max_depth, world);
+                    I = render_pixel(x, y, world, cam, *sampler, sample_counts[y * w + x]);
                 }
-                I += exclude_invalid(L);
+                film->set_pixel(x, y, I, (float)sample_counts[y * w + x]);
             }
-            I *= 1.0f / spp;
-            I = clamp(I); // [0, 1]ŃNv(TODO: g[}bsO̎)
-            if (IS_GAMMA_CORRECTION) I = gamma_correction(I);
-            img[index++] = static_cast<uint8_t>(I.get_x() * 255);
-            img[index++] = static_cast<uint8_t>(I.get_y() * 255);
-            img[index++] = static_cast<uint8_t>(I.get_z() * 255);
         }
-    }
+        int done = ++num_done;
+        std::lock_guard<std::mutex> lock(mtx_progress);
+        std::cout << '\r' << done << '/' << num_node_tiles << std::flush;
+    });
 
     // 摜o
     auto end_time = std::chrono::system_clock::now(); // vI
     auto time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
-    std::cout << '\n' << time_ms / 1000 << "sec\n";
-    stbi_write_png(cam.get_filename(), w, h, 3, img.data(), w * c * sizeof(uint8_t));
-}
\ No newline at end of file
+    std::cout << '\n' << time_ms / 1000 << "sec (" << pool.get_num_threads() << " threads)\n";
+    if (num_nodes > 1) {
+        // SsNẐ݃Tv̏d݂摜o
+        auto part_filename = std::string(cam.get_filename()) + "." + std::to_string(node_index) + ".part";
+        if (!film->write_partial(part_filename)) {
+            std::cerr << "Failed to write " << part_filename << '\n';
+        }
+        return;
+    }
+    if (!film->write()) {
+        std::cerr << "Failed to write " << cam.get_filename() << '\n';
+    }
+
+    // KITvÕTṽq[g}bvo
+    if (error_threshold > 0) {
+        write_sample_heatmap(cam.get_filename(), w, h, sample_counts, spp, max_spp);
+    }
+}
+
+
+void Renderer::render_progressive(const Scene& world, const Camera& cam) const {
+    const auto w = cam.get_w();
+    const auto h = cam.get_h();
+    auto film = cam.get_film();
+    const int num_pixels = w * h;
+    std::vector<PixelStats> stats(num_pixels); // sNZƂɒ~ςˋPx
+
+    // `FbN|CgΑĊJ
+    CheckpointHeader header;
+    header.w = w;
+    header.h = h;
+    header.spp = spp;
+    header.sampler_type = (uint32_t)sampler_type;
+    header.strategy = (uint32_t)strategy;
+    header.scene_hash = hash_scene(scene_path, cam);
+    const std::string path = checkpoint_path.empty() ? std::string(cam.get_filename()) + ".ckpt"
+                                                     : checkpoint_path;
+    if (read_checkpoint(path, header, stats)) {
+        int min_n = spp;
+        for (const auto& s : stats) min_n = std::min(min_n, s.n);
+        std::cout << "resumed from " << path << " (" << min_n << '/' << spp << " spp)\n";
+    }
+
+    // 摜Ɠro߂o_
+    auto write_output = [&](double elapsed, bool is_complete) {
+        for (int p = 0; p < num_pixels; p++) {
+            film->set_pixel(p % w, p / w, stats[p].get_mean(), (float)stats[p].n);
+        }
+        if (!film->write()) {
+            std::cerr << "Failed to write " << cam.get_filename() << '\n';
+        }
+        if (is_complete) {
+            // `FbN|Cg폜C̎s͍ŏ烌_O
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+            return;
+        }
+        CheckpointHeader h_out = header;
+        h_out.elapsed = header.elapsed + elapsed;
+        if (!write_checkpoint(path, h_out, stats)) {
+            std::cerr << "Failed to write " << path << '\n';
+        }
+    };
+
+    // 摜^Cɕ
+    const int num_tiles_x = (w + tile_size - 1) / tile_size;
+    const int num_tiles_y = (h + tile_size - 1) / tile_size;
+    const int num_tiles = num_tiles_x * num_tiles_y;
+
+    // f̗v󂯕t
+    is_stop_requested = false;
+    auto prev_sigint = std::signal(SIGINT, request_stop);
+    auto prev_sigterm = std::signal(SIGTERM, request_stop);
+    auto start_time = std::chrono::system_clock::now(); // vJn
+    auto get_elapsed = [&]() {
+        return std::chrono::duration<double>(std::chrono::system_clock::now() - start_time).count();
+    };
+    auto is_stopped = [&]() {
+        return is_stop_requested || (time_budget > 0 && get_elapsed() >= time_budget);
+    };
+    double last_checkpoint = 0.0;
+    ThreadPool pool(num_threads);
+    int min_n = 0;
+    while (true) {
+        // łTv̏ȂsNZɃpX̖ڕW߂(fpX̑)
+        min_n = spp;
+        for (const auto& s : stats) min_n = std::min(min_n, s.n);
+        if (min_n >= spp || is_stopped()) {
+            break;
+        }
+        const int pass_end = std::min(min_n + pass_spp, spp);
+        pool.parallel_for(num_tiles, [&](int tile, int thread_id) {
+            // f͎c̃^CȂ(Tv[̓sNZƃTvԍŌ܂̂œrłĊJł)
+            if (is_stopped()) return;
+            auto sampler = create_sampler(sampler_type, spp);
+            const int x0 = (tile % num_tiles_x) * tile_size;
+            const int y0 = (tile / num_tiles_x) * tile_size;
+            const int x1 = std::min(x0 + tile_size, w);
+            const int y1 = std::min(y0 + tile_size, h);
+            for (int y = y0; y < y1; y++) {
+                for (int x = x0; x < x1; x++) {
+                    const int p = y * w + x;
+                    if (stats[p].n >= pass_end) continue;
+                    add_pixel_samples(x, y, world, cam, *sampler, pass_end, stats[p]);
+                }
+            }
+        });
+        double elapsed = get_elapsed();
+        std::cout << '\r' << pass_end << '/' << spp << " spp, " << (int)elapsed << "sec" << std::flush;
+        if (elapsed - last_checkpoint >= checkpoint_interval) {
+            write_output(elapsed, false);
+            last_checkpoint = elapsed;
+        }
+    }
+    std::signal(SIGINT, prev_sigint);
+    std::signal(SIGTERM, prev_sigterm);
+
+    // 摜ƃ`FbN|Cgo
+    double elapsed = get_elapsed();
+    write_output(elapsed, min_n >= spp);
+    std::cout << '\n' << min_n << '/' << spp << " spp"
+              << (min_n < spp ? " (stopped, resume from " + path + ")" : std::string())
+              << ", " << (int)elapsed << "sec (total " << (int)(header.elapsed + elapsed) << "sec, "
+              << pool.get_num_threads() << " threads)\n";
+}
@@ -6,7 +6,11 @@
 
 #pragma once
 
+#include <cstdint>
+#include <string>
+#include <vector>
 #include "Math.h"
+#include "Sampler.h"
 
 struct intersection;
 class Camera;
@@ -23,6 +27,69 @@ enum class Sampling {
     MIS     = 1 << 3,  /**< dd_ITvO       */
 };
 
+/** sNZl̓v */
+struct PixelStats {
+    // Ql: Welford̃ICASY(https://en.wikipedia.org/wiki/Algorithms_for_calculating_variance)
+    int n = 0;             /**< Tv             */
+    Vec3 sum;              /**< ˋPx̑a         */
+    float mean_y = 0.f;    /**< Px̕             */
+    float m2_y = 0.f;      /**< Px̕΍̓a     */
+
+    /**
+    * @brief Tvǉ֐
+    * @param[in] L :ˋPx̃Tv
+    */
+    void add(const Vec3& L);
+
+    /**
+    * @brief ˋPx̕ς擾֐
+    * @return Vec3 :ˋPx̕
+    */
+    Vec3 get_mean() const;
+
+    /**
+    * @brief Px̕ς̑Ό덷(W덷/)𐄒肷֐
+    * @return float :Ό덷
+    */
+    float relative_error() const;
+};
+
+
+/** Օōsڌ̃VhEC */
+struct ShadowRay {
+    Vec3 origin;      /**< C̎n_(_)                 */
+    Vec3 dir;         /**< ֌                   */
+    float t_max=0.f;  /**< ܂ł̃C̃p[^         */
+    Vec3 Ld;          /**< ՕȂꍇ̒ڌ̊^     */
+};
+
+
+/** EF[utg@œɒǐՂpX̃L[(SoA) */
+struct PathQueue {
+    std::vector<Vec3> origin;           /**< C̎n_                         */
+    std::vector<Vec3> dir;              /**< C̕                         */
+    std::vector<Vec3> contrib;          /**< pX̊^(X[vbg)           */
+    std::vector<int> path_index;        /**< pX̔ԍ(Tvԍ*f+f) */
+    std::vector<int> dimension;         /**< ɎgTv[̎           */
+    std::vector<uint8_t> is_specular;   /**< O̎UʂȂtrue          */
+
+    int size() const { return (int)path_index.size(); }
+
+    void clear();
+
+    /**
+    * @brief pXǉ֐
+    * @param[in] o           :C̎n_
+    * @param[in] d           :C̕
+    * @param[in] beta        :pX̊^
+    * @param[in] index       :pX̔ԍ
+    * @param[in] dim         :ɎgTv[̎
+    * @param[in] is_spec     :O̎UʂȂtrue
+    */
+    void push(const Vec3& o, const Vec3& d, const Vec3& beta, int index, int dim, bool is_spec);
+};
+
+
 /** _[NX */
 class Renderer {
 public:
@@ -30,8 +97,11 @@ public:
     * @brief _[
     * @param[in] _spp : 1sNZ̃Tv(samples per pixel)
     * @param[in] strategy  :}eA
+    * @param[in] _num_threads :Xbh(0Ȃn[hEFÃXbh)
+    * @param[in] _sampler_type :Tv[̎
     */
-    Renderer(int _spp=4, Sampling _strategy=Sampling::UNIFORM);
+    Renderer(int _spp=4, Sampling _strategy=Sampling::UNIFORM, int _num_threads=0,
+             SamplerType _sampler_type=SamplerType::Sobol);
 
     /**
     * @brief ڌlɑI񂾓˕TvO֐
@@ -39,11 +109,13 @@ public:
     * @pram[in] isect         :IuWFNǧ_
     * @pram[in] world         :V[
     * @pram[in] shading_coord :VF[fBOWn
-    * @return Vec3 :ڌ̓˕ˋPx
+    * @pram[in] sampler       :Tv[
+    * @param[out] shadow      :ՕO̒ڌ̓˕ˋPxƃVhEC
+    * @return bool :^true
     * @note XyLCł͎sȂ
     */
-    Vec3 explict_uniform(const Ray& r, const intersection& isect, const Scene& world,
-        const ONB& shading_coord) const;
+    bool explict_uniform(const Ray& r, const intersection& isect, const Scene& world,
+        const ONB& shading_coord, Sampler& sampler, ShadowRay& shadow) const;
 
     /**
     * @brief ڌBSDFɉ˕TvO֐
@@ -51,11 +123,13 @@ public:
     * @pram[in] isect         :IuWFNǧ_
     * @pram[in] world         :V[
     * @pram[in] shading_coord :VF[fBOWn
-    * @return Vec3 :ڌ̏dݕt˕ˋPx
+    * @pram[in] sampler       :Tv[
+    * @param[out] shadow      :ՕO̒ڌ̏dݕt˕ˋPxƃVhEC
+    * @return bool :^true
     * @note XyLCł͎sȂ
     */
-    Vec3 explict_bsdf(const Ray& r, const intersection& isect, const Scene& world,
-        const ONB& shading_coord) const;
+    bool explict_bsdf(const Ray& r, const intersection& isect, const Scene& world,
+        const ONB& shading_coord, Sampler& sampler, ShadowRay& shadow) const;
 
     /**
     * @brief ڌ̌TvO
@@ -63,11 +137,26 @@ public:
     * @pram[in] isect         :IuWFNǧ_
     * @pram[in] world         :V[
     * @pram[in] shading_coord :VF[fBOWn
-    * @return Vec3 :ڌ̏dݕt˕ˋPx
+    * @pram[in] sampler       :Tv[
+    * @param[out] shadow      :ՕO̒ڌ̏dݕt˕ˋPxƃVhEC
+    * @return bool :^true
     * @note XyLCł͎sȂ
     */
-    Vec3 explict_one_light(const Ray& r, const intersection& isect, const Scene& world,
-        const ONB& shading_coord) const;
+    bool explict_one_light(const Ray& r, const intersection& isect, const Scene& world,
+        const ONB& shading_coord, Sampler& sampler, ShadowRay& shadow) const;
+
+    /**
+    * @brief ڌTvOĎՕÕVhEC𐶐֐
+    * @pram[in] r             :ǐՃC
+    * @pram[in] isect         :IuWFNǧ_
+    * @pram[in] world         :V[
+    * @pram[in] shading_coord :VF[fBOWn
+    * @pram[in] sampler       :Tv[
+    * @param[out] shadows     :VhEC(ő2{)
+    * @return int :VhEC̐
+    */
+    int sample_direct_light(const Ray& r, const intersection& isect, const Scene& world,
+        const ONB& shading_coord, Sampler& sampler, ShadowRay shadows[2]) const;
 
     /**
     * @brief IɒڌTvO
@@ -75,38 +164,42 @@ public:
     * @pram[in] isect         :IuWFNǧ_
     * @pram[in] world         :V[
     * @pram[in] shading_coord :VF[fBOWn
+    * @pram[in] sampler       :Tv[
     * @return Vec3 :̏dݕtˋPx
     */
     Vec3 explicit_direct_light_sampling(const Ray& r, const intersection& isect,
-        const Scene& world, const ONB& shading_coord) const;
+        const Scene& world, const ONB& shading_coord, Sampler& sampler) const;
 
     /**
     * @brief mICg[VOs֐
     * @param[in]  r_in      :J̃C
     * @param[in]  max_depth :C̍őoEX
     * @param[in]  world     :_OV[̃f[^
+    * @param[in]  sampler   :Tv[
     * @return Vec3          :CɉˋPx
     * @note VA[bgɂł؂ĂȂ̂max_depth͏߂ɂĂ
     */
-    Vec3 L_raytracing(const Ray& r_in, int max_depth, const Scene& world) const;
+    Vec3 L_raytracing(const Ray& r_in, int max_depth, const Scene& world, Sampler& sampler) const;
 
     /**
     * @brief iC[uȃpXg[VOs֐
     * @param[in]  r_in      :J̃C
     * @param[in]  max_depth :C̍őoEX
     * @param[in]  world     :_OV[̃f[^
+    * @param[in]  sampler   :Tv[
     * @return Vec3          :CɉˋPx
     */
-    Vec3 L_naive_pathtracing(const Ray& r_in, int max_depth, const Scene& world) const;
+    Vec3 L_naive_pathtracing(const Ray& r_in, int max_depth, const Scene& world, Sampler& sampler) const;
 
     /**
     * @brief pXg[VOs֐
     * @param[in]  r_in      :J̃C
     * @param[in]  max_depth :C̍őoEX
     * @param[in]  world     :_OV[̃f[^
+    * @param[in]  sampler   :Tv[
     * @return Vec3          :CɉˋPx
     */
-    Vec3 L_pathtracing(const Ray& r_in, int max_depth, const Scene& world) const;
+    Vec3 L_pathtracing(const Ray& r_in, int max_depth, const Scene& world, Sampler& sampler) const;
 
     /**
     * @brief V[̃VFCv̖@֐
@@ -121,11 +214,114 @@ public:
     * @brief w肵f[^V[_O֐
     * @param[out] world    :V[f[^
     * @param[out] cam      :Jf[^
+    * @note vObVu_OƕU_Oݒ肳Ă΃G[o͂ĉȂ
     */
     void render(const Scene& world, const Camera& cam) const;
 
+    /**
+    * @brief KITvOݒ肷֐
+    * @param[in] _error_threshold :sNZ̑Ό덷臒l(0ȉȂKITvOsȂ)
+    * @param[in] _max_spp         :1sNZ̍őTv
+    * @note sppŏTvƂCsppƂɑΌ덷]臒l܂ŃTvǉ
+    * @note Lȏꍇ̓Tṽq[g}bv(*_spp.png)o͂
+    */
+    void set_adaptive_sampling(float _error_threshold, int _max_spp);
+
+    /**
+    * @brief EF[utg@ɂpXg[VOݒ肷֐
+    * @param[in] _is_wavefront :EF[utg@gȂtrue
+    * @note ^C̑̃pXEVF[fBOEVhEC̒iKƂɂ܂Ƃ߂ď
+    * @note L_pathtracingƓlɂȂ(KITvO͎gȂ)
+    */
+    void set_wavefront(bool _is_wavefront) { is_wavefront = _is_wavefront; }
+
+    /**
+    * @brief vObVu_Oݒ肷֐
+    * @param[in] _pass_spp            :1pXŊesNZɒǉTv(0ȉȂ疳)
+    * @param[in] _time_budget         :ł؂܂ł̎s[b](0ȉȂ疳)
+    * @param[in] _scene_path          :V[Lqt@C̃pX(Ȃgݍ݂̃V[)
+    * @param[in] _checkpoint_interval :`FbN|CgoԊu[b]
+    * @param[in] _checkpoint_path     :`FbN|Cg̃pX(Ȃ"<o͉摜>.ckpt")
+    * @note sppɒB邩sԂg؂܂ŃpXJԂC`FbN|CgƓr̉摜o
+    * @note `FbN|Cg΂̑ĊJCsppxɃ_OꍇƓ摜ɂȂ
+    * @note V[Lqt@C̓eJς`FbN|Cg͍ĊJC폜
+    * @note KITvOƃEF[utg@͎gȂ
+    */
+    void set_progressive(int _pass_spp, float _time_budget, const std::string& _scene_path="",
+                         float _checkpoint_interval=60.f, const std::string& _checkpoint_path="");
+
+    /**
+    * @brief ̃vZX}VŕSă_Oݒ֐
+    * @param[in] _node_index :̃vZX̔ԍ[0, _num_nodes)
+    * @param[in] _num_nodes  :SvZX̑(1Ȃ番SȂ)
+    * @note ^CԍɊevZX֊蓖āCS̕摜"<o͉摜>.<ԍ>.part"ɏo
+    * @note Tv[̌n̓sNZƃTvԍŌ܂̂ŁCmerge_partial_filmsŌ1vZX̌ʂƈv
+    * @note vObVu_OƂ͕płȂ
+    */
+    void set_distributed(int _node_index, int _num_nodes);
+
 
 private:
+    /**
+    * @brief 1sNZ̕ˋPx𐄒肷֐
+    * @param[in]  x           :sNZ̗
+    * @param[in]  y           :sNZ̍s
+    * @param[in]  world       :V[f[^
+    * @param[in]  cam         :Jf[^
+    * @param[in]  sampler     :Tv[
+    * @param[out] num_samples :gpTv
+    * @return Vec3            :sNZ̕ˋPx(Tv̕)
+    */
+    Vec3 render_pixel(int x, int y, const Scene& world, const Camera& cam, Sampler& sampler,
+                      int& num_samples) const;
+
+    /**
+    * @brief 1sNZɃTvǉ֐
+    * @param[in]     x       :sNZ̗
+    * @param[in]     y       :sNZ̍s
+    * @param[in]     world   :V[f[^
+    * @param[in]     cam     :Jf[^
+    * @param[in]     sampler :Tv[
+    * @param[in]     k_end   :ǉ̃Tv(Tvԍstats.nk_end-1܂łǉ)
+    * @param[in,out] stats   :sNZl̓v
+    */
+    void add_pixel_samples(int x, int y, const Scene& world, const Camera& cam, Sampler& sampler,
+                           int k_end, PixelStats& stats) const;
+
+    /**
+    * @brief pXJԂăTv~ςvObVu_Os֐
+    * @param[in] world :V[f[^
+    * @param[in] cam   :Jf[^
+    */
+    void render_progressive(const Scene& world, const Camera& cam) const;
+
+    /**
+    * @brief ^C̑SsNZ̕ˋPxEF[utg@Ő肷֐
+    * @param[in]  x0      :^C̍[̗
+    * @param[in]  y0      :^C̏[̍s
+    * @param[in]  x1      :^C̉E[̗(܂܂Ȃ)
+    * @param[in]  y1      :^C̉[̍s(܂܂Ȃ)
+    * @param[in]  world   :V[f[^
+    * @param[in]  cam     :Jf[^
+    * @param[in]  sampler :Tv[
+    * @param[out] colors  :sNZ̕ˋPx(^CōsD)
+    */
+    void render_tile_wavefront(int x0, int y0, int x1, int y1, const Scene& world,
+                               const Camera& cam, Sampler& sampler, std::vector<Vec3>& colors) const;
+
     int spp;           /**< 1sNZ̃Tv */
     Sampling strategy; /**< ̃TvO헪      */
+    SamplerType sampler_type; /**< Tv[̎       */
+    int num_threads;   /**< Xbh(0Ȃn[hEFÃXbh) */
+    int tile_size;     /**< ^C̈ӂ̃sNZ   */
+    float error_threshold; /**< KITvȎΌ덷臒l */
+    int max_spp;       /**< KITvO̍őTv */
+    bool is_wavefront; /**< EF[utg@ŃpXǐՂȂtrue */
+    int pass_spp;      /**< vObVu_O1pX̃Tv(0Ȃ疳) */
+    float time_budget; /**< vObVu_O̎sԂ̏[b] */
+    std::string scene_path;      /**< `FbN|Cg̏ƍɎgV[Lqt@C */
+    float checkpoint_interval;   /**< `FbN|CgoԊu[b] */
+    std::string checkpoint_path; /**< `FbN|Cg̃pX             */
+    int node_index;    /**< U_Oł̂̃vZX̔ԍ */
+    int num_nodes;     /**< U_ÕvZX           */
 };
\ No newline at end of file
@@ -0,0 +1,313 @@
+#include "Sampler.h"
+#include <algorithm>
+#include <cmath>
+
+
+// *** nbVƒu ***
+
+/**
+* @brief 64bit̃rbgha֐
+* @param[in] v     :͒l
+* @return uint64_t :nbVl
+*/
+static uint64_t mix_bits(uint64_t v) {
+    v ^= (v >> 31);
+    v *= 0x7fb5d329728ea185ULL;
+    v ^= (v >> 27);
+    v *= 0x81dadef4bc2dd44dULL;
+    v ^= (v >> 33);
+    return v;
+}
+
+/**
+* @brief 32bit[0, 1)̎ɕϊ֐
+* @param[in] x  :͒l
+* @return float :[0, 1)̎
+*/
+static float to_unit_float(uint32_t x) {
+    return std::min(x * 0x1p-32f, one_minus_epsilon);
+}
+
+/**
+* @brief [0, n)̃_ȒuiԖڂ̗vfvZ֐
+* @param[in] i    :uvf
+* @param[in] n    :vf
+* @param[in] seed :uIԃV[hl
+* @return int     :u̗vf
+* @note Ql: [Kensler 2013] "Correlated Multi-Jittered Sampling"
+*/
+static int permutation_element(uint32_t i, uint32_t n, uint32_t seed) {
+    uint32_t w = n - 1;
+    w |= w >> 1;
+    w |= w >> 2;
+    w |= w >> 4;
+    w |= w >> 8;
+    w |= w >> 16;
+    // nȏ̒l͒uJԂĊp(cycle-walking)
+    do {
+        i ^= seed;
+        i *= 0xe170893d;
+        i ^= seed >> 16;
+        i ^= (i & w) >> 4;
+        i ^= seed >> 8;
+        i *= 0x0929eb3f;
+        i ^= seed >> 23;
+        i ^= (i & w) >> 1;
+        i *= 1 | seed >> 27;
+        i *= 0x6935fa69;
+        i ^= (i & w) >> 11;
+        i *= 0x74dcb303;
+        i ^= (i & w) >> 2;
+        i *= 0x9e501cc3;
+        i ^= (i & w) >> 2;
+        i *= 0xc860a3df;
+        i &= w;
+        i ^= i >> 5;
+    } while (i >= n);
+    return (int)((i + seed) % n);
+}
+
+/**
+* @brief 32bit̃rbg̏Ԃ𔽓]֐
+* @param[in] x     :͒l
+* @return uint32_t :rbg𔽓]l
+*/
+static uint32_t reverse_bits(uint32_t x) {
+    x = (x << 16) | (x >> 16);
+    x = ((x & 0x00FF00FF) << 8) | ((x & 0xFF00FF00) >> 8);
+    x = ((x & 0x0F0F0F0F) << 4) | ((x & 0xF0F0F0F0) >> 4);
+    x = ((x & 0x33333333) << 2) | ((x & 0xCCCCCCCC) >> 2);
+    x = ((x & 0x55555555) << 1) | ((x & 0xAAAAAAAA) >> 1);
+    return x;
+}
+
+/**
+* @brief nbVɂOwenXNu(2i̓q̈lȒu){֐
+* @param[in] x     :͒l(Œ菬_[0, 1))
+* @param[in] seed  :XNũV[hl
+* @return uint32_t :XNul
+* @note Ql: [Burley 2020] "Practical Hash-based Owen Scrambling"
+*/
+static uint32_t nested_uniform_scramble(uint32_t x, uint32_t seed) {
+    // ʃrbgʃrbĝ݂ɈˑLaine-Karrasurbg]lɓKp
+    x = reverse_bits(x);
+    x += seed;
+    x ^= x * 0x6c50b47cu;
+    x ^= x * 0xb82f1e52u;
+    x ^= x * 0xc7afe638u;
+    x ^= x * 0x8d22f6e6u;
+    return reverse_bits(x);
+}
+
+
+// *** Tv[ ***
+
+void Sampler::start_pixel_sample(int x, int y, int _sample_index) {
+    px = x;
+    py = y;
+    sample_index = _sample_index;
+    dimension = 0;
+}
+
+void Sampler::resume_pixel_sample(int x, int y, int _sample_index, int _dimension) {
+    start_pixel_sample(x, y, _sample_index);
+    skip_dimensions(_dimension);
+}
+
+uint64_t Sampler::hash_dimension(uint64_t salt) const {
+    uint64_t pixel = ((uint64_t)(uint32_t)py << 32) | (uint32_t)px;
+    return mix_bits(mix_bits(mix_bits(pixel ^ seed) ^ (uint64_t)dimension) ^ salt);
+}
+
+
+// *** ƗTv[ ***
+
+void IndependentSampler::start_pixel_sample(int x, int y, int _sample_index) {
+    Sampler::start_pixel_sample(x, y, _sample_index);
+    // sNZXg[ԍCTvԍV[hlƂ
+    uint64_t stream = ((uint64_t)(uint32_t)y << 32) | (uint32_t)x;
+    rng.set_sequence(mix_bits(seed ^ (uint64_t)sample_index), stream);
+}
+
+float IndependentSampler::get_1d() {
+    dimension++;
+    return rng.next_float();
+}
+
+Vec2 IndependentSampler::get_2d() {
+    dimension += 2;
+    auto u = rng.next_float();
+    auto v = rng.next_float();
+    return Vec2(u, v);
+}
+
+void IndependentSampler::skip_dimensions(int n) {
+    // 1藐1
+    rng.advance(n);
+    dimension += n;
+}
+
+
+// *** wTv[ ***
+
+StratifiedSampler::StratifiedSampler(int _spp, bool _is_jitter, uint64_t _seed)
+    : Sampler(_spp, _seed), is_jitter(_is_jitter), nx(1), ny(_spp)
+{
+    // spp؂sppȉōő̖񐔂Ŋiqɕ
+    for (int d = (int)std::sqrt((float)spp); d >= 1; d--) {
+        if (spp % d == 0) {
+            nx = d;
+            ny = spp / d;
+            break;
+        }
+    }
+}
+
+void StratifiedSampler::start_pixel_sample(int x, int y, int _sample_index) {
+    Sampler::start_pixel_sample(x, y, _sample_index);
+    uint64_t stream = ((uint64_t)(uint32_t)y << 32) | (uint32_t)x;
+    rng.set_sequence(mix_bits(seed ^ (uint64_t)sample_index), stream);
+}
+
+float StratifiedSampler::get_1d() {
+    // spp𒴂Tv͕ʂ̒uőwJԂ
+    int round = sample_index / spp;
+    int stratum = permutation_element(sample_index % spp, spp, (uint32_t)hash_dimension(round));
+    float delta = is_jitter ? rng.next_float() : 0.5f;
+    dimension++;
+    return std::min((stratum + delta) / spp, one_minus_epsilon);
+}
+
+Vec2 StratifiedSampler::get_2d() {
+    int round = sample_index / spp;
+    int index = sample_index % spp;
+    uint64_t hash = hash_dimension(round);
+    float dx = is_jitter ? rng.next_float() : 0.5f;
+    float dy = is_jitter ? rng.next_float() : 0.5f;
+    dimension += 2;
+    // iqɕłȂꍇ̓ei(eւ̎ˉew)
+    if (nx == 1 && spp > 1) {
+        int sx = permutation_element(index, spp, (uint32_t)hash);
+        int sy = permutation_element(index, spp, (uint32_t)(hash >> 32));
+        return Vec2(std::min((sx + dx) / spp, one_minus_epsilon),
+                    std::min((sy + dy) / spp, one_minus_epsilon));
+    }
+    int stratum = permutation_element(index, spp, (uint32_t)hash);
+    int sx = stratum % nx;
+    int sy = stratum / nx;
+    return Vec2(std::min((sx + dx) / nx, one_minus_epsilon),
+                std::min((sy + dy) / ny, one_minus_epsilon));
+}
+
+void StratifiedSampler::skip_dimensions(int n) {
+    if (is_jitter) rng.advance(n);
+    dimension += n;
+}
+
+
+// *** HaltonTv[ ***
+
+/** Halton̊e̊(f) */
+static constexpr int PRIMES[HaltonSampler::MAX_DIMENSION] = {
+    2,   3,   5,   7,   11,  13,  17,  19,  23,  29,  31,  37,  41,  43,  47,  53,
+    59,  61,  67,  71,  73,  79,  83,  89,  97,  101, 103, 107, 109, 113, 127, 131,
+    137, 139, 149, 151, 157, 163, 167, 173, 179, 181, 191, 193, 197, 199, 211, 223,
+    227, 229, 233, 239, 241, 251, 257, 263, 269, 271, 277, 281, 283, 293, 307, 311
+};
+
+/**
+* @brief OwenXNu{t֐vZ֐
+* @param[in] base  :
+* @param[in] a     :̔ԍ
+* @param[in] hash  :XNũV[hl
+* @return float    :[0, 1)̎
+* @note e艺ʂ̌Ɉˑuŕבւ
+*/
+static float owen_scrambled_radical_inverse(int base, uint64_t a, uint64_t hash) {
+    float inv_base = 1.0f / base;
+    float inv_base_m = 1.0f;
+    uint64_t reversed_digits = 0;
+    // floatxŋʂł錅܂ŌvZ
+    while (1 - (base - 1) * inv_base_m < 1) {
+        uint64_t next = a / base;
+        int digit = (int)(a - next * base);
+        uint32_t digit_hash = (uint32_t)mix_bits(hash ^ reversed_digits);
+        digit = permutation_element(digit, base, digit_hash);
+        reversed_digits = reversed_digits * base + digit;
+        inv_base_m *= inv_base;
+        a = next;
+    }
+    return std::min(inv_base_m * reversed_digits, one_minus_epsilon);
+}
+
+float HaltonSampler::get_1d() {
+    float u;
+    if (dimension < MAX_DIMENSION) {
+        u = owen_scrambled_radical_inverse(PRIMES[dimension], sample_index, hash_dimension());
+    }
+    else {
+        // ̓nbVɂ闐őp
+        u = to_unit_float((uint32_t)mix_bits(hash_dimension() ^ (uint64_t)sample_index));
+    }
+    dimension++;
+    return u;
+}
+
+Vec2 HaltonSampler::get_2d() {
+    auto u = get_1d();
+    auto v = get_1d();
+    return Vec2(u, v);
+}
+
+
+// *** SobolTv[ ***
+
+/**
+* @brief Sobol2Ԗڂ̎vZ֐
+* @param[in] index :̔ԍ
+* @return uint32_t :Œ菬_[0, 1)
+* @note v[i+1] = v[i] ^ (v[i] >> 1)ƂȂ(1Ԗڂ̎̓rbg]van der Corput)
+*/
+static uint32_t sobol_second_dimension(uint32_t index) {
+    uint32_t x = 0;
+    for (uint32_t v = 1u << 31; index != 0; index >>= 1, v ^= v >> 1) {
+        if (index & 1) x ^= v;
+    }
+    return x;
+}
+
+float SobolSampler::get_1d() {
+    // ƂɃTvԍuĎԂ̑ւ
+    uint64_t hash = hash_dimension();
+    uint32_t index = nested_uniform_scramble(sample_index, (uint32_t)hash);
+    uint32_t x = nested_uniform_scramble(reverse_bits(index), (uint32_t)(hash >> 32));
+    dimension++;
+    return to_unit_float(x);
+}
+
+Vec2 SobolSampler::get_2d() {
+    // Sobol̍ŏ2(0,2)Ȃ̂2Ƃɑw
+    uint64_t hash = hash_dimension();
+    uint64_t hash_x = mix_bits(hash ^ 1);
+    uint64_t hash_y = mix_bits(hash ^ 2);
+    uint32_t index = nested_uniform_scramble(sample_index, (uint32_t)hash);
+    uint32_t x = nested_uniform_scramble(reverse_bits(index), (uint32_t)hash_x);
+    uint32_t y = nested_uniform_scramble(sobol_second_dimension(index), (uint32_t)hash_y);
+    dimension += 2;
+    return Vec2(to_unit_float(x), to_unit_float(y));
+}
+
+
+std::unique_ptr<Sampler> create_sampler(SamplerType type, int spp, uint64_t seed) {
+    switch (type) {
+    case SamplerType::Independent:
+        return std::make_unique<IndependentSampler>(spp, seed);
+    case SamplerType::Stratified:
+        return std::make_unique<StratifiedSampler>(spp, true, seed);
+    case SamplerType::Halton:
+        return std::make_unique<HaltonSampler>(spp, seed);
+    case SamplerType::Sobol:
+    default:
+        return std::make_unique<SobolSampler>(spp, seed);
+    }
+}
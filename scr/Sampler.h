@@ -0,0 +1,165 @@
+/**
+* @file  Sampler.h
+* @brief ϕ̊eɗ^[0, 1)̈lTv̐
+* @note  Tv̓sNZWETvԍE猈܂̂ŁCXbh^C̏ɂȂ
+* @note  Ql: https://pbr-book.org/4ed/Sampling_and_Reconstruction
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include "Math.h"
+#include "Random.h"
+
+/** Tv[̎ */
+enum class SamplerType {
+    Independent = 1 << 0,  /**< ƗȈl                       */
+    Stratified  = 1 << 1,  /**< w(Wb^[)TvO           */
+    Halton      = 1 << 2,  /**< OwenXNu{Halton     */
+    Sobol       = 1 << 3,  /**< OwenXNu{Sobol      */
+};
+
+
+/** Tv[̊NX */
+class Sampler {
+public:
+    /**
+    * @brief Tv[
+    * @param[in] _spp  :1sNZ̃Tv
+    * @param[in] _seed :V[hl
+    */
+    Sampler(int _spp, uint64_t _seed=0) : spp(_spp), seed(_seed) {};
+
+    virtual ~Sampler() {};
+
+    int get_spp() const { return spp; }
+
+    /**
+    * @brief sNZ̃Tv̐Jn֐
+    * @param[in] x            :sNZ̗
+    * @param[in] y            :sNZ̍s
+    * @param[in] sample_index :sNZ̃Tvԍ
+    * @note 0ɖ߂
+    */
+    virtual void start_pixel_sample(int x, int y, int sample_index);
+
+    /**
+    * @brief fsNZ̃Tv̐w肵ĊJ֐
+    * @param[in] x            :sNZ̗
+    * @param[in] y            :sNZ̍s
+    * @param[in] sample_index :sNZ̃Tvԍ
+    * @param[in] _dimension   :Ɏg
+    * @note 1̃Tv[ŕ̃pX݂ɐi߂(EF[utg)ƂɎg
+    */
+    void resume_pixel_sample(int x, int y, int sample_index, int _dimension);
+
+    int get_dimension() const { return dimension; }
+
+    /**
+    * @brief 1̃Tv𐶐֐
+    * @return float :[0, 1)̃Tv
+    */
+    virtual float get_1d() = 0;
+
+    /**
+    * @brief 2̃Tv𐶐֐
+    * @return Vec2 :[0, 1)^2̃Tv
+    */
+    virtual Vec2 get_2d() = 0;
+
+protected:
+    /**
+    * @brief ǂݔ΂֐
+    * @param[in] n :ǂݔ΂̐
+    * @note Tv[͏闐i߂
+    */
+    virtual void skip_dimensions(int n) { dimension += n; }
+
+    /**
+    * @brief ݂̃sNZEEV[hlnbVlvZ֐
+    * @param[in] salt :prƂɒlς邽߂̒l
+    * @return uint64_t :nbVl
+    */
+    uint64_t hash_dimension(uint64_t salt=0) const;
+
+    int spp;               /**< 1sNZ̃Tv */
+    uint64_t seed;         /**< V[hl                   */
+    int px = 0;            /**< sNZ̗               */
+    int py = 0;            /**< sNZ̍s               */
+    int sample_index = 0;  /**< sNZ̃Tvԍ   */
+    int dimension = 0;     /**< Ɏg               */
+};
+
+
+/** ƗȈlɂTv[ */
+class IndependentSampler : public Sampler {
+public:
+    IndependentSampler(int _spp, uint64_t _seed=0) : Sampler(_spp, _seed) {};
+    void start_pixel_sample(int x, int y, int sample_index) override;
+    float get_1d() override;
+    Vec2 get_2d() override;
+
+protected:
+    void skip_dimensions(int n) override;
+
+private:
+    PCG32 rng; /**<  */
+};
+
+
+/** w(Wb^[)Tv[ */
+class StratifiedSampler : public Sampler {
+public:
+    /**
+    * @brief wTv[
+    * @param[in] _spp       :1sNZ̃Tv
+    * @param[in] _is_jitter :wŃTv炷Ȃtrue(falseȂw̒S)
+    * @param[in] _seed      :V[hl
+    * @note 2sppnx*nẙiqɕđwCłȂ(f)ꍇ̓eiőw
+    */
+    StratifiedSampler(int _spp, bool _is_jitter=true, uint64_t _seed=0);
+    void start_pixel_sample(int x, int y, int sample_index) override;
+    float get_1d() override;
+    Vec2 get_2d() override;
+
+protected:
+    void skip_dimensions(int n) override;
+
+private:
+    bool is_jitter; /**< wŃTv炷Ȃtrue */
+    int nx;         /**< 2̑wx̕       */
+    int ny;         /**< 2̑wy̕       */
+    PCG32 rng;      /**< Wb^[p̗         */
+};
+
+
+/** OwenXNu{HaltonɂTv[ */
+class HaltonSampler : public Sampler {
+public:
+    HaltonSampler(int _spp, uint64_t _seed=0) : Sampler(_spp, _seed) {};
+    float get_1d() override;
+    Vec2 get_2d() override;
+
+    static constexpr int MAX_DIMENSION = 64; /**< Haltongő原(ȍ~̓nbVɂ闐) */
+};
+
+
+/** OwenXNu{SobolɂTv[ */
+class SobolSampler : public Sampler {
+    // Ql: [Burley 2020](https://jcgt.org/published/0009/04/01/)
+public:
+    SobolSampler(int _spp, uint64_t _seed=0) : Sampler(_spp, _seed) {};
+    float get_1d() override;
+    Vec2 get_2d() override;
+};
+
+
+/**
+* @brief w肵ނ̃Tv[𐶐֐
+* @param[in] type :Tv[̎
+* @param[in] spp  :1sNZ̃Tv
+* @param[in] seed :V[hl
+* @return std::unique_ptr<Sampler> :Tv[
+*/
+std::unique_ptr<Sampler> create_sampler(SamplerType type, int spp, uint64_t seed=0);
@@ -6,25 +6,74 @@
 #include "Shape.h"
 
 
+void Scene::build() {
+    // VFCvBVH\z
+    std::vector<AABB> shape_bounds;
+    for (const auto& object : shape_list) {
+        shape_bounds.push_back(object->get_bounds());
+    }
+    shape_bvh = BVH(shape_bounds, 1);
+    // E̗LŕނċEBVH\z
+    area_light_list.clear();
+    infinite_light_list.clear();
+    std::vector<AABB> light_bounds;
+    for (const auto& light : light_list) {
+        auto bounds = light->get_bounds();
+        if (bounds.is_empty()) {
+            infinite_light_list.push_back(light);
+        }
+        else {
+            area_light_list.push_back(light);
+            light_bounds.push_back(bounds);
+        }
+    }
+    light_bvh = BVH(light_bounds, 1);
+    // V[̑傫ɈˑOČI\z
+    auto scene_bounds = merge(shape_bvh.get_bounds(), light_bvh.get_bounds());
+    for (const auto& light : light_list) {
+        light->preprocess(scene_bounds);
+    }
+    light_sampler = create_light_sampler(light_sampler_type, light_list);
+}
+
+
 bool Scene::intersect(const Ray& r, float t_min, float t_max, intersection& p) const {
-    intersection isect;
-    bool is_isect = false;
+    HitRecord hit;
+    const Light* hit_light = nullptr;
     auto t_first = t_max;
-    isect.type = IsectType::None;
-    // VFCvƂ̌
-    for (const auto& object : shape_list) {
-        if (object->intersect(r, t_min, t_first, isect)) {
-            is_isect = true;
-            t_first = isect.t;
-            isect.type = IsectType::Material;
+    // VFCvƂ̌(_͍ł߂_ɂĂ̂݌vZ)
+    bool is_isect = shape_bvh.intersect(r, t_min, t_first, [&](int i, float t_near, float& t_far) {
+        if (shape_list[i]->intersect_hit(r, t_near, t_far, hit)) {
+            t_far = hit.t;
+            return true;
         }
+        return false;
+    });
+    if (is_isect) {
+        t_first = hit.t;
     }
     // Ƃ̌
-    for (const auto& light : light_list) {
+    is_isect |= light_bvh.intersect(r, t_min, t_first, [&](int i, float t_near, float& t_far) {
+        if (area_light_list[i]->intersect_hit(r, t_near, t_far, hit)) {
+            t_far = hit.t;
+            hit_light = area_light_list[i].get();
+            return true;
+        }
+        return false;
+    });
+    intersection isect;
+    isect.type = IsectType::None;
+    if (is_isect) {
+        t_first = hit.t;
+        hit.shape->get_intersection(r, hit, isect);
+        isect.type = hit_light ? IsectType::Light : IsectType::Material;
+        isect.light = hit_light;
+    }
+    for (const auto& light : infinite_light_list) {
         if (light->intersect(r, t_min, t_first, isect)) {
             is_isect = true;
             t_first = isect.t;
-            isect.light = light;
+            isect.light = light.get();
             isect.type = IsectType::Light;
         }
     }
@@ -33,37 +82,45 @@ bool Scene::intersect(const Ray& r, float t_min, float t_max, intersection& p) c
 }
 
 
-bool Scene::intersect_object(const Ray& r, float t_min, float t_max) const {
-    intersection isect;
-    bool is_isect = false;
-    auto t_first = t_max;
-    isect.type = IsectType::None;
-    // VFCvƂ̌
-    for (const auto& object : shape_list) {
-        if (object->intersect(r, t_min, t_first, isect)) {
-            is_isect = true;
-            t_first = isect.t;
-            isect.type = IsectType::Material;
-        }
-    }
-    return is_isect;
+bool Scene::occluded(const Ray& r, float t_min, float t_max) const {
+    // VFCvƂ̎Օ
+    return shape_bvh.occluded(r, t_min, t_max, [&](int i) {
+        return shape_list[i]->occluded(r, t_min, t_max);
+    });
 }
 
 
 bool Scene::intersect_light(const Ray& r, float t_min, float t_max, intersection& p) const {
-    intersection isect;
-    bool is_isect = false;
+    HitRecord hit;
+    const Light* hit_light = nullptr;
     auto t_first = t_max;
-    isect.type = IsectType::None;
     // Ƃ̌
-    for (const auto& light : light_list) {
+    bool is_isect = light_bvh.intersect(r, t_min, t_first, [&](int i, float t_near, float& t_far) {
+        if (area_light_list[i]->intersect_hit(r, t_near, t_far, hit)) {
+            t_far = hit.t;
+            hit_light = area_light_list[i].get();
+            return true;
+        }
+        return false;
+    });
+    intersection isect;
+    isect.type = IsectType::None;
+    if (is_isect) {
+        t_first = hit.t;
+        hit.shape->get_intersection(r, hit, isect);
+        isect.light = hit_light;
+        isect.type = IsectType::Light;
+    }
+    for (const auto& light : infinite_light_list) {
         if (light->intersect(r, t_min, t_first, isect)) {
             is_isect = true;
             t_first = isect.t;
-            isect.light = light;
+            isect.light = light.get();
             isect.type = IsectType::Light;
-            p = isect;
         }
     }
+    if (is_isect) {
+        p = isect;
+    }
     return is_isect;
-}
\ No newline at end of file
+}
@@ -7,6 +7,8 @@
 
 #include <memory>
 #include <vector>
+#include "BVH.h"
+#include "LightSampler.h"
 #include "Math.h"
 
 struct intersection;
@@ -47,8 +49,32 @@ public:
     void clear() { 
         shape_list.clear();
         light_list.clear();
+        infinite_light_list.clear();
+        area_light_list.clear();
+        shape_bvh = BVH();
+        light_bvh = BVH();
+        light_sampler = nullptr;
     }
 
+    /**
+    * @brief V[̉\ƌI\z֐
+    * @note VFCvƌSĒǉC_ȎOɌĂяo
+    */
+    void build();
+
+    /**
+    * @brief I̎ނݒ肷֐
+    * @param[in] type :I̎
+    * @note build()̑Oɐݒ肷
+    */
+    void set_light_sampler_type(LightSamplerType type) { light_sampler_type = type; }
+
+    /**
+    * @brief ڌ̃TvOɎgI擾
+    * @return const LightSampler* :I(build()Onullptr)
+    */
+    const LightSampler* get_light_sampler() const { return light_sampler.get(); }
+
     /**
     * @brief V[̑SVFCv擾
     * @return std::vector<std::shared_ptr<Shape>> :V[̃VFCv̏W
@@ -71,19 +97,18 @@ public:
     * @param[in]  t_max :˃C̃p[^
     * @param[out] p     :_
     * @return bool      :̌
-    * @note TODO: BVH̎
     */
     bool intersect(const Ray& r, float t_min, float t_max, intersection& p) const;
 
     /**
-    * @brief CƃVFCv̌s֐
+    * @brief CԓŃVFCvɎՕ邩肷֐
     * @param[in]  r     :˃C
     * @param[in]  t_min :˃C̃p[^
     * @param[in]  t_max :˃C̃p[^
-    * @return bool      :̌
-    * @note TODO: BVH̎
+    * @return bool      :ՕĂtrue
+    * @note VhECpɍŏɌőł؂C_͐Ȃ
     */
-    bool intersect_object(const Ray& r, float t_min, float t_max) const;
+    bool occluded(const Ray& r, float t_min, float t_max) const;
 
     /**
     * @brief Cƌ̌s֐
@@ -92,7 +117,6 @@ public:
     * @param[in]  t_max :˃C̃p[^
     * @param[out] p     :_
     * @return bool      :̌
-    * @note TODO: BVH̎
     */
     bool intersect_light(const Ray& r, float t_min, float t_max, intersection& p) const;
 
@@ -100,5 +124,11 @@ public:
 private:
     std::vector<std::shared_ptr<Shape>> shape_list; /**< V[̃VFCv */
     std::vector<std::shared_ptr<Light>> light_list; /**< V[̌     */
+    std::vector<std::shared_ptr<Light>> area_light_list;     /**< E(BVH̊i[) */
+    std::vector<std::shared_ptr<Light>> infinite_light_list; /**< EȂ          */
+    BVH shape_bvh; /**< VFCvBVH         */
+    BVH light_bvh; /**< EBVH   */
+    LightSamplerType light_sampler_type = LightSamplerType::BVH;   /**< I̎ */
+    std::shared_ptr<LightSampler> light_sampler;                   /**< I       */
     Vec3 bg_color; /**< wiF */
 };
\ No newline at end of file
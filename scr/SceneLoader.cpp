@@ -0,0 +1,803 @@
+#include "SceneLoader.h"
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+#include "Camera.h"
+#include "Film.h"
+#include "Light.h"
+#include "Material.h"
+#include "Scene.h"
+#include "Shape.h"
+#include "Transform.h"
+
+
+// ***  ***
+
+/** V[Lqt@C̎ */
+struct SceneToken {
+    enum class Type { Word, Number, String, List } type; /**< ̎               */
+    std::string text;                                   /**< P܂͕         */
+    std::vector<float> numbers;                         /**< l܂̓Xg̗vf   */
+};
+
+/** p[^̒l */
+struct SceneValue {
+    std::vector<float> numbers; /**< l̕                   */
+    std::string text;           /**< P܂͕             */
+    bool is_text = false;       /**< P܂͕̒lȂtrue */
+};
+
+/** V[Lqt@C1̖ */
+struct SceneStatement {
+    int line = 0;                                           /**< ߂̐擪̍sԍ */
+    std::string directive;                                  /**<                */
+    std::vector<std::string> args;                          /**< ʒu           */
+    std::vector<std::pair<std::string, SceneValue>> params; /**< L[ƒl           */
+};
+
+/**
+* @brief ߂̈ʒu̐擾֐
+* @param[in] directive :
+* @return int          :ʒu̐(m̖߂Ȃ-1)
+*/
+static int get_num_args(const std::string& directive) {
+    if (directive == "film" || directive == "camera" || directive == "renderer" || directive == "scene") {
+        return 0;
+    }
+    if (directive == "shape" || directive == "light") {
+        return 1; // 
+    }
+    if (directive == "material") {
+        return 2; // OƎ
+    }
+    return -1;
+}
+
+/**
+* @brief Ŝ𐔒lƂĉ͂֐
+* @param[in]  text  :
+* @param[out] value :l
+* @return bool      :lȂtrue
+*/
+static bool parse_number(const std::string& text, float& value) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    value = std::strtof(text.c_str(), &end);
+    return end == text.c_str() + text.size();
+}
+
+/**
+* @brief 1s̎𖽗߂ɕϊ֐
+* @param[in]  tokens    :
+* @param[in]  line      :sԍ
+* @param[out] statement :
+* @param[out] error     :G[bZ[W
+* @return bool          :ϊłtrue
+*/
+static bool make_statement(const std::vector<SceneToken>& tokens, int line,
+    SceneStatement& statement, std::string& error) {
+    statement = SceneStatement();
+    statement.line = line;
+    if (tokens[0].type != SceneToken::Type::Word) {
+        error = "statement must begin with a directive";
+        return false;
+    }
+    statement.directive = tokens[0].text;
+    int num_args = get_num_args(statement.directive);
+    if (num_args < 0) {
+        error = "unknown directive '" + statement.directive + "'";
+        return false;
+    }
+    size_t i = 1;
+    for (int k = 0; k < num_args; k++, i++) {
+        if (i >= tokens.size() || (tokens[i].type != SceneToken::Type::Word &&
+                                   tokens[i].type != SceneToken::Type::String)) {
+            error = "'" + statement.directive + "' needs " + std::to_string(num_args) + " argument(s)";
+            return false;
+        }
+        statement.args.push_back(tokens[i].text);
+    }
+    while (i < tokens.size()) {
+        if (tokens[i].type != SceneToken::Type::Word) {
+            error = "expected a parameter name";
+            return false;
+        }
+        const auto& key = tokens[i++].text;
+        SceneValue value;
+        // P̒l1̂݁CȊO͎̒P(L[)܂ł̐lEEXgA
+        if (i < tokens.size() && tokens[i].type == SceneToken::Type::Word) {
+            value.text = tokens[i++].text;
+            value.is_text = true;
+        }
+        while (i < tokens.size() && tokens[i].type != SceneToken::Type::Word) {
+            const auto& token = tokens[i++];
+            if (token.type == SceneToken::Type::String) {
+                if (value.is_text || !value.numbers.empty()) {
+                    error = "parameter '" + key + "' mixes strings and numbers";
+                    return false;
+                }
+                value.text = token.text;
+                value.is_text = true;
+            }
+            else {
+                if (value.is_text) {
+                    error = "parameter '" + key + "' mixes strings and numbers";
+                    return false;
+                }
+                value.numbers.insert(value.numbers.end(), token.numbers.begin(), token.numbers.end());
+            }
+        }
+        if (!value.is_text && value.numbers.empty()) {
+            error = "parameter '" + key + "' has no value";
+            return false;
+        }
+        statement.params.emplace_back(key, std::move(value));
+    }
+    return true;
+}
+
+/**
+* @brief V[Lq̕𖽗߂̗ɕ֐
+* @param[in]  text       :V[Lq
+* @param[in]  filename   :G[\p̃t@C
+* @param[out] statements :߂̗
+* @return bool           :@true
+*/
+static bool read_statements(const std::string& text, const std::string& filename,
+    std::vector<SceneStatement>& statements) {
+    std::vector<SceneToken> tokens;
+    int line = 1;
+    int statement_line = 1;
+    std::string error;
+    auto finish_statement = [&]() {
+        if (tokens.empty()) return true;
+        SceneStatement statement;
+        if (!make_statement(tokens, statement_line, statement, error)) {
+            line = statement_line;
+            return false;
+        }
+        statements.push_back(std::move(statement));
+        tokens.clear();
+        return true;
+    };
+    auto is_delimiter = [](char c) {
+        return std::isspace((unsigned char)c) || c == '#' || c == '"' || c == '[' || c == ']';
+    };
+    size_t i = 0;
+    while (error.empty() && i < text.size()) {
+        char c = text[i];
+        if (c == '\n') {
+            if (!finish_statement()) break;
+            line++;
+            i++;
+            continue;
+        }
+        if (std::isspace((unsigned char)c)) {
+            i++;
+            continue;
+        }
+        if (c == '#') {
+            while (i < text.size() && text[i] != '\n') i++;
+            continue;
+        }
+        if (tokens.empty()) {
+            statement_line = line;
+        }
+        SceneToken token;
+        if (c == '"') {
+            // (s܂܂Ȃ)
+            auto end = text.find_first_of("\"\n", i + 1);
+            if (end == std::string::npos || text[end] != '"') {
+                error = "unterminated string";
+                break;
+            }
+            token.type = SceneToken::Type::String;
+            token.text = text.substr(i + 1, end - i - 1);
+            i = end + 1;
+        }
+        else if (c == '[') {
+            // l̃Xg(sɓnĂ悢)
+            token.type = SceneToken::Type::List;
+            const int list_line = line;
+            i++;
+            while (error.empty()) {
+                while (i < text.size() && (std::isspace((unsigned char)text[i]) || text[i] == '#')) {
+                    if (text[i] == '#') {
+                        while (i < text.size() && text[i] != '\n') i++;
+                        continue;
+                    }
+                    if (text[i] == '\n') line++;
+                    i++;
+                }
+                if (i >= text.size()) {
+                    line = list_line;
+                    error = "unterminated list";
+                }
+                else if (text[i] == ']') {
+                    i++;
+                    break;
+                }
+                else {
+                    size_t begin = i;
+                    while (i < text.size() && !is_delimiter(text[i])) i++;
+                    float value;
+                    if (!parse_number(text.substr(begin, i - begin), value)) {
+                        error = "list may only contain numbers";
+                    }
+                    token.numbers.push_back(value);
+                }
+            }
+        }
+        else if (c == ']') {
+            error = "unexpected ']'";
+        }
+        else {
+            size_t begin = i;
+            while (i < text.size() && !is_delimiter(text[i])) i++;
+            token.text = text.substr(begin, i - begin);
+            float value;
+            if (parse_number(token.text, value)) {
+                token.type = SceneToken::Type::Number;
+                token.numbers.push_back(value);
+            }
+            else {
+                token.type = SceneToken::Type::Word;
+            }
+        }
+        if (error.empty()) {
+            tokens.push_back(std::move(token));
+        }
+    }
+    if (error.empty()) {
+        finish_statement();
+    }
+    if (!error.empty()) {
+        std::cerr << filename << ':' << line << ": " << error << '\n';
+        return false;
+    }
+    return true;
+}
+
+
+// *** p[^̎擾 ***
+
+/** ߂̃p[^^mFȂ擾NX */
+class SceneParams {
+public:
+    /**
+    * @brief RXgN^
+    * @param[in] _statement :
+    * @param[in] _filename  :G[\p̃t@C
+    */
+    SceneParams(const SceneStatement& _statement, const std::string& _filename)
+        : statement(_statement), filename(_filename), is_used(_statement.params.size(), false)
+    {}
+
+    /**
+    * @brief G[o͂֐
+    * @param[in] message :G[bZ[W
+    */
+    void error(const std::string& message) {
+        std::cerr << filename << ':' << statement.line << ": " << message << '\n';
+        has_error = true;
+    }
+
+    bool has(const std::string& key) const { return find(key) != nullptr; }
+
+    float get_float(const std::string& key, float value) {
+        auto v = find_used(key);
+        if (v && (v->is_text || v->numbers.size() != 1)) {
+            error("'" + key + "' must be a number");
+        }
+        else if (v) {
+            value = v->numbers[0];
+        }
+        return value;
+    }
+
+    int get_int(const std::string& key, int value) {
+        return (int)get_float(key, (float)value);
+    }
+
+    Vec3 get_vec3(const std::string& key, const Vec3& value) {
+        auto v = find_used(key);
+        if (!v) return value;
+        // 1̐l3ɓWJ
+        if (!v->is_text && v->numbers.size() == 1) {
+            return Vec3(v->numbers[0], v->numbers[0], v->numbers[0]);
+        }
+        if (v->is_text || v->numbers.size() != 3) {
+            error("'" + key + "' must be 1 or 3 numbers");
+            return value;
+        }
+        return Vec3(v->numbers[0], v->numbers[1], v->numbers[2]);
+    }
+
+    std::string get_string(const std::string& key, const std::string& value) {
+        auto v = find_used(key);
+        if (v && !v->is_text) {
+            error("'" + key + "' must be a name or a string");
+        }
+        else if (v) {
+            return v->text;
+        }
+        return value;
+    }
+
+    bool get_bool(const std::string& key, bool value) {
+        auto v = find_used(key);
+        if (!v) return value;
+        if (v->is_text && (v->text == "true" || v->text == "false")) {
+            return v->text == "true";
+        }
+        if (!v->is_text && v->numbers.size() == 1) {
+            return v->numbers[0] != 0;
+        }
+        error("'" + key + "' must be true or false");
+        return value;
+    }
+
+    const std::vector<float>& get_floats(const std::string& key) {
+        static const std::vector<float> empty;
+        auto v = find_used(key);
+        if (v && v->is_text) {
+            error("'" + key + "' must be numbers");
+            return empty;
+        }
+        return v ? v->numbers : empty;
+    }
+
+    /**
+    * @brief SẴp[^gmF֐
+    * @return bool :G[Ȃtrue
+    * @note m̃p[^(Ԃ̌Ȃ)̓G[Ƃ
+    */
+    bool check() {
+        for (size_t i = 0; i < is_used.size(); i++) {
+            if (!is_used[i]) {
+                error("unknown parameter '" + statement.params[i].first + "' for '" +
+                      statement.directive + "'");
+                is_used[i] = true; // G[JԂo͂Ȃ
+            }
+        }
+        return !has_error;
+    }
+
+private:
+    const SceneValue* find(const std::string& key) const {
+        for (const auto& param : statement.params) {
+            if (param.first == key) return &param.second;
+        }
+        return nullptr;
+    }
+
+    const SceneValue* find_used(const std::string& key) {
+        for (size_t i = 0; i < statement.params.size(); i++) {
+            if (statement.params[i].first == key) {
+                is_used[i] = true;
+                return &statement.params[i].second;
+            }
+        }
+        return nullptr;
+    }
+
+    const SceneStatement& statement; /**<                          */
+    const std::string& filename;     /**< G[\p̃t@C     */
+    std::vector<bool> is_used;       /**< p[^擾true   */
+    bool has_error = false;          /**< G[true           */
+};
+
+
+// *** O̕ϊ ***
+
+bool parse_sampling(const std::string& name, Sampling& strategy) {
+    if (name == "uniform") strategy = Sampling::UNIFORM;
+    else if (name == "bsdf") strategy = Sampling::BSDF;
+    else if (name == "light") strategy = Sampling::LIGHT;
+    else if (name == "mis") strategy = Sampling::MIS;
+    else return false;
+    return true;
+}
+
+bool parse_sampler_type(const std::string& name, SamplerType& sampler) {
+    if (name == "independent") sampler = SamplerType::Independent;
+    else if (name == "stratified") sampler = SamplerType::Stratified;
+    else if (name == "halton") sampler = SamplerType::Halton;
+    else if (name == "sobol") sampler = SamplerType::Sobol;
+    else return false;
+    return true;
+}
+
+/**
+* @brief OI̎ނ擾֐
+* @param[in]  name :uniform, power, bvĥꂩ
+* @param[out] type :I̎
+* @return bool     :Otrue
+*/
+static bool parse_light_sampler_type(const std::string& name, LightSamplerType& type) {
+    if (name == "uniform") type = LightSamplerType::Uniform;
+    else if (name == "power") type = LightSamplerType::Power;
+    else if (name == "bvh") type = LightSamplerType::BVH;
+    else return false;
+    return true;
+}
+
+
+// *** V[̍\z ***
+
+/**
+* @brief VFCv̔zu̕ϊ擾֐
+* @param[in]  params   :VFCv̖߂̃p[^
+* @param[out] to_world :scaleCrotateCtranslatȅɓKpϊ
+* @return bool         :ꂩ̕ϊw肳Ătrue
+*/
+static bool get_transform(SceneParams& params, Transform& to_world) {
+    if (!params.has("scale") && !params.has("rotate") && !params.has("translate")) {
+        return false;
+    }
+    auto s = params.get_vec3("scale", Vec3::one);
+    if (s[0] == 0 || s[1] == 0 || s[2] == 0) {
+        params.error("'scale' must not be zero");
+        s = Vec3::one;
+    }
+    to_world = Transform::scale(s);
+    if (params.has("rotate")) {
+        // ]p[deg]Ɖ]
+        const auto& r = params.get_floats("rotate");
+        if (r.size() != 4 || Vec3(r[1], r[2], r[3]).length2() == 0) {
+            params.error("'rotate' must be an angle and a non-zero axis");
+        }
+        else {
+            to_world = Transform::rotate(Vec3(r[1], r[2], r[3]), r[0]) * to_world;
+        }
+    }
+    to_world = Transform::translate(params.get_vec3("translate", Vec3::zero)) * to_world;
+    return true;
+}
+
+/**
+* @brief }eA𐶐֐
+* @param[in]  type   :}eA̎
+* @param[in]  params :p[^
+* @param[out] key    :`̃}eAL邽߂̃L[
+* @return std::shared_ptr<Material> :}eA(m̎ނȂnullptr)
+*/
+static std::shared_ptr<Material> create_material(const std::string& type, SceneParams& params,
+    std::string& key) {
+    // ȗꂽl܂߂đSẴp[^L[ɏo(_16i\LŐm)
+    std::ostringstream ss;
+    ss << std::hexfloat << type;
+    auto vec3 = [&](const char* name, const Vec3& value) {
+        auto v = params.get_vec3(name, value);
+        ss << ' ' << v.get_x() << ' ' << v.get_y() << ' ' << v.get_z();
+        return v;
+    };
+    auto number = [&](const char* name, float value) {
+        auto v = params.get_float(name, value);
+        ss << ' ' << v;
+        return v;
+    };
+    auto flag = [&](const char* name, bool value) {
+        auto v = params.get_bool(name, value);
+        ss << ' ' << v;
+        return v;
+    };
+    std::shared_ptr<Material> material;
+    if (type == "diffuse") {
+        auto base = vec3("base", Vec3(0.8f, 0.8f, 0.8f));
+        material = std::make_shared<Diffuse>(base);
+    }
+    else if (type == "mirror") {
+        auto base = vec3("base", Vec3::one);
+        material = std::make_shared<Mirror>(base);
+    }
+    else if (type == "glass") {
+        auto base = vec3("base", Vec3::one);
+        auto r = vec3("r", Vec3::one);
+        auto t = vec3("t", Vec3::one);
+        auto n = number("n", 1.5f);
+        auto alpha = number("alpha", 0.f);
+        material = std::make_shared<Glass>(base, r, t, n, alpha);
+    }
+    else if (type == "metal") {
+        auto base = vec3("base", Vec3::one);
+        auto fr = vec3("fr", Vec3::one);
+        auto alpha = number("alpha", 0.1f);
+        auto is_multiple_scattering = flag("multiple_scattering", false);
+        material = std::make_shared<Metal>(base, fr, alpha, is_multiple_scattering);
+    }
+    else if (type == "plastic") {
+        auto base = vec3("base", Vec3::one);
+        auto kd = vec3("kd", Vec3(0.5f, 0.5f, 0.5f));
+        auto ks = vec3("ks", Vec3(0.5f, 0.5f, 0.5f));
+        auto alpha = number("alpha", 0.1f);
+        material = std::make_shared<Plastic>(base, kd, ks, alpha);
+    }
+    else if (type == "phong") {
+        auto base = vec3("base", Vec3::one);
+        auto kd = vec3("kd", Vec3(0.5f, 0.5f, 0.5f));
+        auto ks = vec3("ks", Vec3(0.5f, 0.5f, 0.5f));
+        auto shine = number("shine", 50.f);
+        material = std::make_shared<Phong>(base, kd, ks, shine);
+    }
+    else if (type == "thinfilm") {
+        auto base = vec3("base", Vec3::one);
+        auto thickness = number("thickness", 500.f);
+        auto n_inside = number("n_inside", 1.0f);
+        auto n_film = number("n_film", 1.34f);
+        auto alpha = number("alpha", 0.f);
+        auto is_transmission = flag("transmission", false);
+        material = std::make_shared<Thinfilm>(base, thickness, n_inside, n_film, alpha, is_transmission);
+    }
+    else {
+        params.error("unknown material type '" + type + "'");
+    }
+    key = ss.str();
+    return material;
+}
+
+/**
+* @brief V[Lqt@C̑΃pX֐
+* @param[in] scene_dir :V[Lqt@C̃fBNg
+* @param[in] path      :t@C̃pX
+* @return std::string  :pX
+*/
+static std::string resolve_path(const std::filesystem::path& scene_dir, const std::string& path) {
+    std::filesystem::path p(path);
+    if (p.is_absolute() || scene_dir.empty()) {
+        return p.string();
+    }
+    return (scene_dir / p).lexically_normal().string();
+}
+
+bool load_scene(const std::string& filename, Scene& world, Camera& cam, RenderSettings& settings) {
+    std::ifstream ifs(filename, std::ios::binary);
+    if (!ifs) {
+        std::cerr << filename << ": cannot open the scene file\n";
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << ifs.rdbuf();
+    std::vector<SceneStatement> statements;
+    if (!read_statements(buffer.str(), filename, statements)) {
+        return false;
+    }
+
+    world.clear();
+    settings = RenderSettings();
+    const auto scene_dir = std::filesystem::path(filename).parent_path();
+    // tBƃJ͑SĂ̖߂ǂł琶
+    int film_w = 600, film_h = 600;
+    float exposure = 0.f;
+    std::string output = "out.png";
+    Vec3 cam_pos(0.f, 0.f, 10.f), cam_target(0.f, 0.f, 0.f), cam_forward;
+    float fov = 30.f, focal_length = 0.f;
+    // L}eAƃbV
+    std::unordered_map<std::string, std::shared_ptr<Material>> named_materials;
+    std::unordered_map<std::string, std::shared_ptr<Material>> unique_materials;
+    std::unordered_map<std::string, std::shared_ptr<Shape>> unique_meshes;
+    int num_shared_materials = 0, num_shared_meshes = 0;
+
+    for (const auto& statement : statements) {
+        SceneParams params(statement, filename);
+        const auto& directive = statement.directive;
+        if (directive == "film") {
+            film_w = params.get_int("width", film_w);
+            film_h = params.get_int("height", film_h);
+            output = params.get_string("output", output);
+            exposure = params.get_float("exposure", exposure);
+            if (film_w <= 0 || film_h <= 0) {
+                params.error("film size must be positive");
+            }
+        }
+        else if (directive == "camera") {
+            cam_pos = params.get_vec3("position", cam_pos);
+            cam_target = params.get_vec3("target", cam_target);
+            cam_forward = params.get_vec3("forward", cam_forward);
+            fov = params.get_float("fov", fov);
+            focal_length = params.get_float("focal_length", focal_length);
+        }
+        else if (directive == "renderer") {
+            settings.spp = params.get_int("spp", settings.spp);
+            settings.num_threads = params.get_int("threads", settings.num_threads);
+            settings.error_threshold = params.get_float("error_threshold", settings.error_threshold);
+            settings.max_spp = params.get_int("max_spp", settings.max_spp);
+            settings.is_wavefront = params.get_bool("wavefront", settings.is_wavefront);
+            auto strategy = params.get_string("strategy", "mis");
+            if (!parse_sampling(strategy, settings.strategy)) {
+                params.error("unknown strategy '" + strategy + "'");
+            }
+            auto sampler = params.get_string("sampler", "sobol");
+            if (!parse_sampler_type(sampler, settings.sampler)) {
+                params.error("unknown sampler '" + sampler + "'");
+            }
+        }
+        else if (directive == "scene") {
+            world.set_bg_color(params.get_vec3("background", world.get_bg_color()));
+            if (params.has("light_sampler")) {
+                auto name = params.get_string("light_sampler", "bvh");
+                LightSamplerType type;
+                if (parse_light_sampler_type(name, type)) {
+                    world.set_light_sampler_type(type);
+                }
+                else {
+                    params.error("unknown light sampler '" + name + "'");
+                }
+            }
+        }
+        else if (directive == "material") {
+            const auto& name = statement.args[0];
+            if (named_materials.count(name)) {
+                params.error("material '" + name + "' is already defined");
+            }
+            std::string key;
+            auto material = create_material(statement.args[1], params, key);
+            // `̃}eA͋L
+            auto iter = unique_materials.find(key);
+            if (iter != unique_materials.end()) {
+                material = iter->second;
+                num_shared_materials++;
+            }
+            else if (material) {
+                unique_materials[key] = material;
+            }
+            named_materials[name] = material;
+        }
+        else if (directive == "shape") {
+            const auto& type = statement.args[0];
+            const bool is_light = params.has("emission");
+            auto emission = params.get_vec3("emission", Vec3::zero);
+            std::shared_ptr<Material> material;
+            if (params.has("material")) {
+                auto name = params.get_string("material", "");
+                auto iter = named_materials.find(name);
+                if (iter == named_materials.end()) {
+                    params.error("material '" + name + "' is not defined");
+                }
+                else {
+                    material = iter->second;
+                }
+            }
+            else if (!is_light) {
+                params.error("shape needs a material or an emission");
+            }
+            // ϊw肳ꂽVFCv̓CX^XƂĔzu
+            Transform to_world;
+            bool is_instance = get_transform(params, to_world);
+            std::shared_ptr<Shape> shape;
+            if (type == "sphere") {
+                auto center = params.get_vec3("center", Vec3::zero);
+                auto radius = params.get_float("radius", 1.0f);
+                shape = std::make_shared<Sphere>(center, radius, material);
+            }
+            else if (type == "mesh") {
+                auto file = resolve_path(scene_dir, params.get_string("file", ""));
+                bool is_smooth = params.get_bool("smooth", true);
+                int max_leaf_size = params.get_int("max_leaf_size", 4);
+                bool use_cache = params.get_bool("cache", true);
+                float crease_angle = params.get_float("crease_angle", 180.f);
+                auto weighting_name = params.get_string("weighting", "area");
+                if (weighting_name != "area" && weighting_name != "angle") {
+                    params.error("unknown weighting '" + weighting_name + "'");
+                }
+                auto weighting = weighting_name == "angle" ? NormalWeighting::Angle : NormalWeighting::Area;
+                // t@CEݒ̃bV͈xǂݍ݁C}eAقȂ΃CX^XŋL
+                std::ostringstream key;
+                key << std::hexfloat << file << '|' << is_smooth << ' ' << max_leaf_size << ' '
+                    << crease_angle << ' ' << (int)weighting;
+                auto iter = unique_meshes.find(key.str());
+                if (iter != unique_meshes.end()) {
+                    shape = iter->second;
+                    num_shared_meshes++;
+                    is_instance |= (material && material != shape->get_mat());
+                }
+                else if (params.check()) {
+                    shape = TriangleMesh::create(file, material, is_smooth, max_leaf_size,
+                                                 use_cache, crease_angle, weighting);
+                    if (shape) {
+                        unique_meshes[key.str()] = shape;
+                    }
+                    else {
+                        params.error("failed to load mesh '" + file + "'");
+                    }
+                }
+            }
+            else if (type == "triangles") {
+                const auto& v = params.get_floats("vertices");
+                const auto& f = params.get_floats("indices");
+                if (v.empty() || v.size() % 3 != 0 || f.empty() || f.size() % 3 != 0) {
+                    params.error("'vertices' and 'indices' must be non-empty lists of triples");
+                }
+                else {
+                    std::vector<Vec3> vertices, indices;
+                    for (size_t i = 0; i < v.size(); i += 3) {
+                        vertices.push_back(Vec3(v[i], v[i + 1], v[i + 2]));
+                    }
+                    const float num_vertices = (float)vertices.size();
+                    bool is_valid_index = true;
+                    for (size_t i = 0; i < f.size() && is_valid_index; i += 3) {
+                        for (int k = 0; k < 3; k++) {
+                            if (f[i + k] < 0 || f[i + k] >= num_vertices || f[i + k] != std::floor(f[i + k])) {
+                                params.error("triangle index out of range");
+                                is_valid_index = false;
+                                break;
+                            }
+                        }
+                        indices.push_back(Vec3(f[i], f[i + 1], f[i + 2]));
+                    }
+                    // sȃCfbNXł̓bV\zȂ
+                    if (is_valid_index) {
+                        shape = std::make_shared<TriangleMesh>(vertices, indices, material);
+                    }
+                }
+            }
+            else {
+                params.error("unknown shape type '" + type + "'");
+            }
+            if (is_light && is_instance && type == "sphere" && !to_world.is_similarity()) {
+                // ȉ~͕̂\ʐς߂ĈlɃTvOłȂ
+                params.error("emissive sphere needs a uniform scale");
+            }
+            if (is_instance && shape) {
+                shape = std::make_shared<Instance>(shape, to_world, material);
+            }
+            if (!params.check()) {
+                return false;
+            }
+            if (is_light) {
+                world.add(std::make_shared<AreaLight>(emission, shape));
+            }
+            else {
+                world.add(shape);
+            }
+            continue;
+        }
+        else if (directive == "light") {
+            const auto& type = statement.args[0];
+            if (type == "environment") {
+                if (params.has("file")) {
+                    auto file = resolve_path(scene_dir, params.get_string("file", ""));
+                    auto rotation = params.get_float("rotation", 0.f);
+                    world.add(std::make_shared<EnvironmentLight>(file, rotation));
+                }
+                else {
+                    world.add(std::make_shared<EnvironmentLight>(params.get_vec3("radiance", Vec3::one)));
+                }
+            }
+            else if (type == "parallel") {
+                auto intensity = params.get_vec3("intensity", Vec3::one);
+                auto direction = params.get_vec3("direction", Vec3(0.f, 1.0f, 0.f));
+                world.add(std::make_shared<ParallelLight>(intensity, direction));
+            }
+            else {
+                params.error("unknown light type '" + type + "'");
+            }
+        }
+        if (!params.check()) {
+            return false;
+        }
+    }
+
+    // JƃtB̐
+    auto film = std::make_shared<Film>(film_w, film_h, 3, output);
+    film->set_exposure(exposure);
+    if (is_zero(cam_forward)) {
+        cam_forward = cam_target - cam_pos;
+    }
+    // œ_MakeScene.cpp̊eV[Ɠ`ŎpvZ
+    auto fov_rad = fov * pi / 180;
+    auto fd = focal_length > 0 ? focal_length : 2.0f * std::cos(fov_rad) / std::sin(fov_rad);
+    cam = Camera(film, fd, cam_pos, unit_vector(cam_forward));
+    if (num_shared_materials > 0 || num_shared_meshes > 0) {
+        std::cout << filename << ": shared " << num_shared_materials << " materials and "
+                  << num_shared_meshes << " meshes\n";
+    }
+    return true;
+}
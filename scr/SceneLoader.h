@@ -0,0 +1,67 @@
+/**
+* @file  SceneLoader.h
+* @brief V[Lqt@C̓ǂݍ
+* @note  1s1̖߂C" [ʒu...] L[ l..."̌`Őݒ肷(#ȍ~̓Rg)
+* @note  l͐l̕сC""CP1C[]ň͂񂾐l̃Xg(sɓnĂ悢)̂ꂩ
+*
+* film      width 600 height 600 output "out.png" exposure 0
+* camera    position 0 2 10 target 0 2 0 fov 30
+* renderer  spp 128 strategy mis sampler sobol threads 0
+* scene     light_sampler bvh background 0 0 0
+* material  <O> diffuse|mirror|glass|metal|plastic|phong|thinfilm <p[^...>
+* shape     sphere center 0 2 0 radius 2 material <O>
+* shape     mesh file "bunny.obj" material <O> smooth true crease_angle 180
+* shape     triangles vertices [x y z ...] indices [i j k ...] material <O>
+* shape     <...> emission 10 10 10   (ʌƂĒǉ)
+* shape     <...> scale 2 rotate 90 0 1 0 translate 1 0 0   (CX^XƂĔzu)
+* light     environment file "envmap.hdr" rotation 270 | environment radiance 1 1 1
+* light     parallel intensity 1 1 1 direction 0 1 0
+*/
+
+#pragma once
+
+#include <string>
+#include "Renderer.h"
+
+class Camera;
+class Scene;
+
+/** V[Lqt@C̃_Oݒ */
+struct RenderSettings {
+    int spp = 128;                               /**< 1sNZ̃Tv          */
+    Sampling strategy = Sampling::MIS;           /**< ̃TvO헪                */
+    SamplerType sampler = SamplerType::Sobol;    /**< Tv[̎                      */
+    int num_threads = 0;                         /**< Xbh(0Ȃn[hEFÃXbh) */
+    float error_threshold = 0.f;                 /**< KITvO臒l(0Ȃ疳)   */
+    int max_spp = 0;                             /**< KITvO̍őTv    */
+    bool is_wavefront = false;                   /**< EF[utg@gȂtrue      */
+};
+
+
+/**
+* @brief V[Lqt@Cǂݍފ֐
+* @param[in]  filename :V[Lqt@C̃pX
+* @param[out] world    :V[(ǂݍݑOɋɂ)
+* @param[out] cam      :JƃtB
+* @param[out] settings :_Oݒ
+* @return bool         :ǂݍ߂true(s͍sԍt̃G[o)
+* @note bVƊ}bv̑΃pX̓V[Lqt@C̃fBNgCo͉摜͍ƃfBNgɂ
+* @note `̃}eAƁCt@CEݒ̃bV͈xċL(قȂ}eAϊ̓CX^Xɂ)
+*/
+bool load_scene(const std::string& filename, Scene& world, Camera& cam, RenderSettings& settings);
+
+/**
+* @brief OTvO헪擾֐
+* @param[in]  name     :uniform, bsdf, light, miŝꂩ
+* @param[out] strategy :TvO헪
+* @return bool         :Otrue
+*/
+bool parse_sampling(const std::string& name, Sampling& strategy);
+
+/**
+* @brief OTv[̎ނ擾֐
+* @param[in]  name    :independent, stratified, halton, sobol̂ꂩ
+* @param[out] sampler :Tv[̎
+* @return bool        :Otrue
+*/
+bool parse_sampler_type(const std::string& name, SamplerType& sampler);
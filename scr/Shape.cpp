@@ -1,51 +1,492 @@
 #include "Shape.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <random>
 #include <string>
+#include <unordered_map>
 #include <iostream>
-#include <fstream>
+#include "MappedFile.h"
 #include "Material.h"
+#include "ObjLoader.h"
 #include "ONB.h"
+#include "Parallel.h"
 #include "Random.h"
 #include "Ray.h"
 #include "utility.h"
 
 /**
-* @brief .obj`̃|Sfǂݍފ֐
-* @param[out]  vertex   :|S̒_z
-* @param[out]  index    :|S̃CfbNXz
-* @param[in]   filename :t@C
-* @return std::vector<std::string> z
-* @details .obj`̃f[^\: https://en.wikipedia.org/wiki/Wavefront_.obj_file
-* @note .objt@Cɓȏ̋󔒂ƃG[
+* @brief CƎOp`̌_̃p[^ƏdSWvZ֐
+* @param[in]  r     :˃C
+* @param[in]  V0    :Op`̒_
+* @param[in]  V1    :Op`̒_
+* @param[in]  V2    :Op`̒_
+* @param[in]  t_min :˃C̃p[^
+* @param[in]  t_max :˃C̃p[^
+* @param[out] t     :_̃C̃p[^
+* @param[out] u     :_V1̏dSW
+* @param[out] v     :_V2̏dSW
+* @return bool      :̌
 */
-void load_obj(std::vector<Vec3>& vertex, std::vector<Vec3>& index, const std::string& filename) {
-    std::ifstream ifs;
-    ifs.open(filename, std::ios::in); // ǂݍݐpŃt@CJ
-    if (!ifs) {
-        std::cerr << "Failed to load " << filename << '\n';
-        exit(1);
+inline bool intersect_triangle(const Ray& r, const Vec3& V0, const Vec3& V1, const Vec3& V2,
+    float t_min, float t_max, float& t, float& u, float& v) {
+    // Ql: http://www.graphics.cornell.edu/pubs/1997/MT97.html
+    Vec3 T = r.get_origin() - V0;
+    Vec3 E1 = V1 - V0;
+    Vec3 E2 = V2 - V0;
+    Vec3 D = r.get_dir();
+    Vec3 P = cross(D, E2);
+    Vec3 Q = cross(T, E1);
+    float det = dot(P, E1);
+    // COp`̕ʂƕsȂȂ(0ZNaNƔ肳̂h)
+    if (det == 0.f) {
+        return false;
+    }
+    float c = 1.0f / det;
+    t = c * dot(Q, E2);
+    u = c * dot(P, T);
+    v = c * dot(Q, D);
+    if (t < t_min || t > t_max) {
+        return false;
+    }
+    if (u < 0.f || v < 0.f || u + v > 1.0f) {
+        return false;
+    }
+    return true;
+}
+
+
+// _@̌vZ񉻂P(_܂͖ʂ̐)
+constexpr int SMOOTH_NORMAL_BLOCK_SIZE = 4096;
+
+/**
+* @brief אڂʂ̖@̏dݕtaŒ_@vZ֐
+* @param[in,out] vertices     :_z(܂pŖ@钸_͕)
+* @param[in,out] indices      :Op`Ƃ3ׂ_CfbNX(_QƂ悤ɍXV)
+* @param[out]    normals      :_̖@z
+* @param[in]     crease_angle :̊px[deg]傫܂ꂽʂǂ͕Ȃ
+* @param[in]     weighting    :_@̏dݕt
+* @note _ɐڂOp`̈ꗗĂ璸_ƂɕɏWv̂ŁCvZʂ͖ʂ̐ɔႷ
+* @note _Ƃɖʂ̏ő킹̂Ōʂ̓XbhɈ˂Ȃ
+*/
+static void compute_smooth_normals(std::vector<Vec3>& vertices, std::vector<uint32_t>& indices,
+    std::vector<Vec3>& normals, float crease_angle, NormalWeighting weighting) {
+    const int num_vertices = (int)vertices.size();
+    const int num_faces = (int)indices.size() / 3;
+    ThreadPool pool;
+    auto parallel_blocks = [&](int count, const std::function<void(int, int)>& func) {
+        int num_blocks = (count + SMOOTH_NORMAL_BLOCK_SIZE - 1) / SMOOTH_NORMAL_BLOCK_SIZE;
+        pool.parallel_for(num_blocks, [&](int b, int thread_id) {
+            func(b * SMOOTH_NORMAL_BLOCK_SIZE, std::min((b + 1) * SMOOTH_NORMAL_BLOCK_SIZE, count));
+        });
+    };
+    // ʂƂɒ_ɉdݕt̖@vZ
+    std::vector<Vec3> face_normals(num_faces);      // ʂ̒Pʖ@
+    std::vector<Vec3> corner_weights(3 * num_faces); // ʂ̒_Ƃ̏dݕt̖@
+    parallel_blocks(num_faces, [&](int begin, int end) {
+        for (int f = begin; f < end; f++) {
+            const Vec3 V[3] = { vertices[indices[3 * f]], vertices[indices[3 * f + 1]], vertices[indices[3 * f + 2]] };
+            Vec3 N = cross(V[1] - V[0], V[2] - V[0]); // 傫͖ʐς2{
+            float len = N.length();
+            face_normals[f] = len > 0 ? N / len : Vec3::zero;
+            for (int k = 0; k < 3; k++) {
+                if (weighting == NormalWeighting::Angle) {
+                    Vec3 a = V[(k + 1) % 3] - V[k];
+                    Vec3 b = V[(k + 2) % 3] - V[k];
+                    float la = a.length(), lb = b.length();
+                    float cos_angle = la > 0 && lb > 0 ? std::clamp(dot(a, b) / (la * lb), -1.0f, 1.0f) : 1.0f;
+                    corner_weights[3 * f + k] = std::acos(cos_angle) * face_normals[f];
+                }
+                else {
+                    corner_weights[3 * f + k] = N;
+                }
+            }
+        }
+    });
+    // _ɐڂʂ̒_̈ꗗ(CSR`Cʂ̏ɕ)
+    std::vector<int> adjacency_offset(num_vertices + 1, 0);
+    for (int c = 0; c < 3 * num_faces; c++) {
+        adjacency_offset[indices[c] + 1]++;
+    }
+    for (int v = 0; v < num_vertices; v++) {
+        adjacency_offset[v + 1] += adjacency_offset[v];
     }
-    // t@CsƂɓǂݍ
-    std::string line;
-    while (std::getline(ifs, line)) {
-        if (line.empty()) continue; // s
-        std::vector<std::string> s = split_string(line);
-        // TODO: 󔒃Xy[X
-        // _̏
-        if (s[0] == "v") {
-            float x = std::stof(s[1]);
-            float y = std::stof(s[2]);
-            float z = std::stof(s[3]);
-            vertex.push_back(Vec3(x, y, z));
+    std::vector<int> adjacency(3 * num_faces);
+    {
+        std::vector<int> fill(adjacency_offset.begin(), adjacency_offset.end() - 1);
+        for (int c = 0; c < 3 * num_faces; c++) {
+            adjacency[fill[indices[c]]++] = c;
+        }
+    }
+    // ܂plȂꍇ͒_ƂɑSĂ̐ڂʂ𑫂킹
+    if (crease_angle >= 180.f) {
+        normals.assign(num_vertices, Vec3::zero);
+        parallel_blocks(num_vertices, [&](int begin, int end) {
+            for (int v = begin; v < end; v++) {
+                Vec3 N;
+                int prev_face = -1;
+                for (int a = adjacency_offset[v]; a < adjacency_offset[v + 1]; a++) {
+                    int c = adjacency[a];
+                    if (c / 3 == prev_face) continue; // kނʂœ_dĐȂ
+                    prev_face = c / 3;
+                    N += corner_weights[c];
+                }
+                normals[v] = unit_vector(N);
+            }
+        });
+        return;
+    }
+    // ʂ̒_ƂɁC܂pȓ̐ڂʂ𑫂킹
+    const float cos_crease = std::cos(to_radian(std::max(crease_angle, 0.f)));
+    std::vector<Vec3> corner_normals(3 * num_faces);
+    parallel_blocks(num_vertices, [&](int begin, int end) {
+        for (int v = begin; v < end; v++) {
+            for (int a = adjacency_offset[v]; a < adjacency_offset[v + 1]; a++) {
+                int c = adjacency[a];
+                const Vec3& Nf = face_normals[c / 3];
+                Vec3 N, N_all;
+                int prev_face = -1;
+                for (int b = adjacency_offset[v]; b < adjacency_offset[v + 1]; b++) {
+                    int d = adjacency[b];
+                    if (d / 3 == prev_face) continue;
+                    prev_face = d / 3;
+                    N_all += corner_weights[d];
+                    if (d / 3 == c / 3 || dot(Nf, face_normals[d / 3]) >= cos_crease) {
+                        N += corner_weights[d];
+                    }
+                }
+                // kނʂ͑SĂ̐ڂʂ̖@g
+                corner_normals[c] = unit_vector(N.length2() > 0 ? N : N_all);
+            }
         }
-        // CfbNX̏
-        else if (s[0] == "f") {
-            int x = std::stoi(s[1].c_str());
-            int y = std::stoi(s[2].c_str());
-            int z = std::stoi(s[3].c_str());
-            // NOTE: Vec3floatvffloat^Ȃ̂ŃLXg(ƂŏC)
-            index.push_back(Vec3((float)x, (float)y, (float)z));
+    });
+    // @قȂʂ̒_͕ʂ̒_ɕ
+    std::vector<Vec3> split_vertices;
+    split_vertices.reserve(num_vertices);
+    normals.clear();
+    normals.reserve(num_vertices);
+    for (int v = 0; v < num_vertices; v++) {
+        int first = (int)normals.size();
+        for (int a = adjacency_offset[v]; a < adjacency_offset[v + 1]; a++) {
+            int c = adjacency[a];
+            const Vec3& N = corner_normals[c];
+            int found = -1;
+            for (int i = first; i < (int)normals.size(); i++) {
+                if (normals[i][0] == N[0] && normals[i][1] == N[1] && normals[i][2] == N[2]) {
+                    found = i;
+                    break;
+                }
+            }
+            if (found < 0) {
+                found = (int)normals.size();
+                split_vertices.push_back(vertices[v]);
+                normals.push_back(N);
+            }
+            indices[c] = (uint32_t)found;
         }
+        // ǂ̖ʂɂgȂ_c
+        if (adjacency_offset[v] == adjacency_offset[v + 1]) {
+            split_vertices.push_back(vertices[v]);
+            normals.push_back(Vec3::zero);
+        }
+    }
+    vertices = std::move(split_vertices);
+}
+
+
+// LbVt@Č`̔(z̕т\̂ςXV)
+constexpr uint32_t MESH_CACHE_VERSION = 2;
+// LbVt@C̔z̐擪̋E
+constexpr size_t MESH_CACHE_ALIGNMENT = 16;
+
+/** Op`bṼLbVt@C̃wb_(Ɋez񂪑) */
+struct MeshCacheHeader {
+    char magic[4] = { 'T', 'P', 'M', 'C' }; /**< t@C̎ʎq                         */
+    uint32_t version = MESH_CACHE_VERSION;  /**< `̔                                 */
+    uint32_t layout = 0;                    /**< \̂̑傫ƃoCg̊mFp̒l     */
+    uint32_t is_smooth = 0;                 /**< X[YVF[fBOKp       */
+    uint32_t max_leaf_size = 0;             /**< BVH̗tɊi[Op`̍ő吔          */
+    float total_area = 0.f;                 /**< \ʐ                                   */
+    float crease_angle = 0.f;               /**< ő̐܂p[deg]              */
+    uint32_t weighting = 0;                 /**< _@̏dݕt                       */
+    uint64_t source_size = 0;               /**< .objt@C̃oCg               */
+    int64_t source_time = 0;                /**< .objt@C̍XV               */
+    uint64_t num_vertices = 0;              /**< _                                   */
+    uint64_t num_normals = 0;               /**< @                                   */
+    uint64_t num_indices = 0;               /**< _CfbNX                       */
+    uint64_t num_nodes = 0;                 /**< BVH̃m[h                            */
+    uint64_t num_prims = 0;                 /**< BVH̃v~eBu                      */
+    uint64_t num_wide_nodes = 0;            /**< 4؂BVH̃m[h                     */
+    uint64_t num_wide_leaves = 0;           /**< 4؂BVH̗t̐                       */
+    uint64_t num_quads = 0;                 /**< Op`̑g̐                           */
+    BVHStats stats;                         /**< BVH̍\zv                            */
+};
+
+/**
+* @brief t@CƓǂݍݐݒ肩LbṼwb_̏ƍp̒lݒ肷֐
+* @param[in]  source_path   :.objt@C̃pX
+* @param[in]  is_smooth     :X[YVF[fBOKp邩
+* @param[in]  max_leaf_size :BVH̗tɊi[Op`̍ő吔
+* @param[in]  crease_angle  :ő̐܂p[deg]
+* @param[in]  weighting     :_@̏dݕt
+* @param[out] header        :wb_
+* @return bool              :t@C̏擾łtrue
+*/
+static bool make_cache_header(const std::string& source_path, bool is_smooth, int max_leaf_size,
+    float crease_angle, NormalWeighting weighting, MeshCacheHeader& header) {
+    std::error_code ec;
+    auto size = std::filesystem::file_size(source_path, ec);
+    if (ec) return false;
+    auto time = std::filesystem::last_write_time(source_path, ec);
+    if (ec) return false;
+    header.source_size = size;
+    header.source_time = (int64_t)time.time_since_epoch().count();
+    header.is_smooth = is_smooth;
+    header.max_leaf_size = max_leaf_size;
+    // Ȃꍇ͖@̐ݒʂȂ
+    header.crease_angle = is_smooth ? std::min(crease_angle, 180.f) : 0.f;
+    header.weighting = is_smooth ? (uint32_t)weighting : 0u;
+    // \̂̑傫oCgقȂŏꂽt@Ce
+    header.layout = (uint32_t)(sizeof(MeshCacheHeader) << 16 | sizeof(BVHNode) << 8 | sizeof(Vec3));
+    header.layout ^= (uint32_t)(sizeof(WideBVHNode) << 24 | sizeof(TriangleQuad) << 4);
+    return true;
+}
+
+
+/**
+* @brief Moller-Trumbore@4̎Op`ƃČSIMDœɍs֐
+* @param[in]  r     :˃C
+* @param[in]  q     :Op`̑g
+* @param[in]  t_min :˃C̃p[^
+* @param[in]  t_max :˃C̃p[^
+* @param[out] t     :eOp`̌_̃C̃p[^
+* @param[out] u     :eOp`̒_V1̏dSW
+* @param[out] v     :eOp`̒_V2̏dSW
+* @return int       :Op`̃rbg}XN
+* @note intersect_triangleƓŉẐŌʂ͈v
+*/
+inline int intersect_triangle_quad(const Ray& r, const TriangleQuad& q, float t_min, float t_max,
+    __m128& t, __m128& u, __m128& v) {
+    const Vec3 O = r.get_origin();
+    const Vec3 Dir = r.get_dir();
+    const __m128 D[3] = { _mm_set1_ps(Dir[0]), _mm_set1_ps(Dir[1]), _mm_set1_ps(Dir[2]) };
+    __m128 T[3], E1[3], E2[3];
+    for (int a = 0; a < 3; a++) {
+        T[a] = _mm_sub_ps(_mm_set1_ps(O[a]), _mm_load_ps(q.v0[a]));
+        E1[a] = _mm_load_ps(q.e1[a]);
+        E2[a] = _mm_load_ps(q.e2[a]);
+    }
+    auto cross = [](const __m128 a[3], const __m128 b[3], __m128 c[3]) {
+        c[0] = _mm_sub_ps(_mm_mul_ps(a[1], b[2]), _mm_mul_ps(a[2], b[1]));
+        c[1] = _mm_sub_ps(_mm_mul_ps(a[2], b[0]), _mm_mul_ps(a[0], b[2]));
+        c[2] = _mm_sub_ps(_mm_mul_ps(a[0], b[1]), _mm_mul_ps(a[1], b[0]));
+    };
+    auto dot = [](const __m128 a[3], const __m128 b[3]) {
+        return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], b[0]), _mm_mul_ps(a[1], b[1])), _mm_mul_ps(a[2], b[2]));
+    };
+    __m128 P[3], Q[3];
+    cross(D, E2, P);
+    cross(T, E1, Q);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    __m128 det = dot(P, E1);
+    __m128 c = _mm_div_ps(one, det);
+    t = _mm_mul_ps(c, dot(Q, E2));
+    u = _mm_mul_ps(c, dot(P, T));
+    v = _mm_mul_ps(c, dot(Q, D));
+    // sȃC(󂫂̎Op`܂)CԊOCOp`̊OO
+    __m128 mask = _mm_cmpneq_ps(det, zero);
+    mask = _mm_and_ps(mask, _mm_cmpge_ps(t, _mm_set1_ps(t_min)));
+    mask = _mm_and_ps(mask, _mm_cmple_ps(t, _mm_set1_ps(t_max)));
+    mask = _mm_and_ps(mask, _mm_cmpge_ps(u, zero));
+    mask = _mm_and_ps(mask, _mm_cmpge_ps(v, zero));
+    mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(u, v), one));
+    return _mm_movemask_ps(mask);
+}
+
+
+/**
+* @brief Baldwin-Weber@̎Op`̕ϊvZ֐
+* @param[in]  V0, V1, V2 :Op`̒_
+* @param[out] T          :[hWOp`̍Wւ3x4̕ϊs(sD)
+* @note ϊ͎Op`(0,0,0), (1,0,0), (0,1,0)ƂȂCz=0Op`̕ʂɂȂ
+* @note Ql: [Baldwin and Weber 2016] "Fast Ray-Triangle Intersections by Coordinate Transformation"
+*/
+static void compute_baldwin_weber_transform(const Vec3& V0, const Vec3& V1, const Vec3& V2, float* T) {
+    Vec3 E1 = V1 - V0;
+    Vec3 E2 = V2 - V0;
+    Vec3 N = cross(E1, E2);
+    float ax = std::abs(N[0]), ay = std::abs(N[1]), az = std::abs(N[2]);
+    // @̍ő听̎Đl덷}
+    if (ax > ay && ax > az) {
+        float x1 = V1[1] * V0[2] - V1[2] * V0[1];
+        float x2 = V2[1] * V0[2] - V2[2] * V0[1];
+        const float c[12] = { 0.f, E2[2] / N[0], -E2[1] / N[0], x2 / N[0],
+                              0.f, -E1[2] / N[0], E1[1] / N[0], -x1 / N[0],
+                              1.f, N[1] / N[0], N[2] / N[0], -dot(N, V0) / N[0] };
+        std::copy(c, c + 12, T);
+    }
+    else if (ay > az) {
+        float x1 = V1[2] * V0[0] - V1[0] * V0[2];
+        float x2 = V2[2] * V0[0] - V2[0] * V0[2];
+        const float c[12] = { -E2[2] / N[1], 0.f, E2[0] / N[1], x2 / N[1],
+                              E1[2] / N[1], 0.f, -E1[0] / N[1], -x1 / N[1],
+                              N[0] / N[1], 1.f, N[2] / N[1], -dot(N, V0) / N[1] };
+        std::copy(c, c + 12, T);
+    }
+    else if (az > 0.f) {
+        float x1 = V1[0] * V0[1] - V1[1] * V0[0];
+        float x2 = V2[0] * V0[1] - V2[1] * V0[0];
+        const float c[12] = { E2[1] / N[2], -E2[0] / N[2], 0.f, x2 / N[2],
+                              -E1[1] / N[2], E1[0] / N[2], 0.f, -x1 / N[2],
+                              N[0] / N[2], N[1] / N[2], 1.f, -dot(N, V0) / N[2] };
+        std::copy(c, c + 12, T);
+    }
+    else {
+        // kނOp`͌Ȃ
+        std::fill(T, T + 12, 0.f);
+    }
+}
+
+/**
+* @brief Baldwin-Weber@ŃCƎOp`̌_̃p[^ƏdSWvZ֐
+* @param[in]  r     :˃C
+* @param[in]  T     :Op`̕ϊs
+* @param[in]  t_min :˃C̃p[^
+* @param[in]  t_max :˃C̃p[^
+* @param[out] t     :_̃C̃p[^
+* @param[out] u     :_V1̏dSW
+* @param[out] v     :_V2̏dSW
+* @return bool      :̌
+*/
+inline bool intersect_triangle_baldwin_weber(const Ray& r, const float* T,
+    float t_min, float t_max, float& t, float& u, float& v) {
+    const Vec3 O = r.get_origin();
+    const Vec3 D = r.get_dir();
+    // Op`̍Włz
+    float dz = T[8] * D[0] + T[9] * D[1] + T[10] * D[2];
+    float oz = T[8] * O[0] + T[9] * O[1] + T[10] * O[2] + T[11];
+    if (dz == 0.f) {
+        return false;
+    }
+    t = -oz / dz;
+    if (t < t_min || t > t_max) {
+        return false;
+    }
+    // ʏ̌_ϊďdSWvZ
+    Vec3 P = O + t * D;
+    u = T[0] * P[0] + T[1] * P[1] + T[2] * P[2] + T[3];
+    if (u < 0.f || u > 1.0f) {
+        return false;
+    }
+    v = T[4] * P[0] + T[5] * P[1] + T[6] * P[2] + T[7];
+    if (v < 0.f || u + v > 1.0f) {
+        return false;
+    }
+    return true;
+}
+
+
+/** Ȍ̂߂ɃCƂɑOvZl */
+struct WatertightRay {
+    Vec3 origin;       /**< C̎n_                        */
+    int kx, ky, kz;    /**< C̍̕ő听zƂ鎲̕ */
+    float Sx, Sy, Sz;  /**< C̕zɑ邹f̌W */
+
+    /**
+    * @brief COvZl
+    * @param[in] r :˃C
+    */
+    WatertightRay(const Ray& r) : origin(r.get_origin()) {
+        const Vec3 D = r.get_dir();
+        float ax = std::abs(D[0]), ay = std::abs(D[1]), az = std::abs(D[2]);
+        kz = (ax > ay) ? (ax > az ? 0 : 2) : (ay > az ? 1 : 2);
+        kx = (kz + 1) % 3;
+        ky = (kx + 1) % 3;
+        // Op`̊ۂ߂zȂx,yւ
+        if (D[kz] < 0.f) std::swap(kx, ky);
+        Sx = D[kx] / D[kz];
+        Sy = D[ky] / D[kz];
+        Sz = 1.0f / D[kz];
+    }
+};
+
+/**
+* @brief ȕ@ŃCƎOp`̌_̃p[^ƏdSWvZ֐
+* @param[in]  wr         :CƂɑOvZl
+* @param[in]  V0, V1, V2 :Op`̒_
+* @param[in]  t_min      :˃C̃p[^
+* @param[in]  t_max      :˃C̃p[^
+* @param[out] t          :_̃C̃p[^
+* @param[out] u          :_V1̏dSW
+* @param[out] v          :_V2̏dSW
+* @return bool           :̌
+* @note אڂOp`ŕӂ̔肪v̂ŁCӂⒸ_ʂ郌C̎Op`蔲Ȃ
+* @note Ql: [Woop et al. 2013] "Watertight Ray/Triangle Intersection"
+*/
+inline bool intersect_triangle_watertight(const WatertightRay& wr, const Vec3& V0, const Vec3& V1,
+    const Vec3& V2, float t_min, float t_max, float& t, float& u, float& v) {
+    // C̎n__CzƂWɒ_ϊ
+    const Vec3 A = V0 - wr.origin;
+    const Vec3 B = V1 - wr.origin;
+    const Vec3 C = V2 - wr.origin;
+    const float Ax = A[wr.kx] - wr.Sx * A[wr.kz];
+    const float Ay = A[wr.ky] - wr.Sy * A[wr.kz];
+    const float Bx = B[wr.kx] - wr.Sx * B[wr.kz];
+    const float By = B[wr.ky] - wr.Sy * B[wr.kz];
+    const float Cx = C[wr.kx] - wr.Sx * C[wr.kz];
+    const float Cy = C[wr.ky] - wr.Sy * C[wr.kz];
+    // ӊ֐(tʐ)
+    float U = Cx * By - Cy * Bx;
+    float V = Ax * Cy - Ay * Cx;
+    float W = Bx * Ay - By * Ax;
+    // ӏłfloat̊ۂ߂ŕ܂Ȃ̂doubleōČvZ
+    if (U == 0.f || V == 0.f || W == 0.f) {
+        U = (float)((double)Cx * By - (double)Cy * Bx);
+        V = (float)((double)Ax * Cy - (double)Ay * Cx);
+        W = (float)((double)Bx * Ay - (double)By * Ax);
+    }
+    if ((U < 0.f || V < 0.f || W < 0.f) && (U > 0.f || V > 0.f || W > 0.f)) {
+        return false;
+    }
+    float det = U + V + W;
+    if (det == 0.f) {
+        return false;
     }
+    // _̋
+    const float Az = wr.Sz * A[wr.kz];
+    const float Bz = wr.Sz * B[wr.kz];
+    const float Cz = wr.Sz * C[wr.kz];
+    float inv_det = 1.0f / det;
+    t = (U * Az + V * Bz + W * Cz) * inv_det;
+    if (t < t_min || t > t_max) {
+        return false;
+    }
+    u = V * inv_det;
+    v = W * inv_det;
+    return true;
+}
+
+
+/**
+* @brief Op`̓_lɃTvO֐
+* @param[in] V0, V1, V2 :Op`̒_
+* @param[in] N0, N1, N2 :_̖@
+* @param[in] uv         :[0, 1)^2̈lȃTv
+* @return intersection  :Tv_̍WƖ@
+*/
+inline intersection sample_triangle(const Vec3& V0, const Vec3& V1, const Vec3& V2,
+    const Vec3& N0, const Vec3& N1, const Vec3& N2, const Vec2& uv) {
+    auto barycenter = Random::uniform_triangle_sample(uv);
+    auto s = barycenter.get_x();
+    auto t = barycenter.get_y();
+    auto u = 1.0f - s - t;
+    intersection isect;
+    isect.pos = s * V0 + t * V1 + u * V2;
+    isect.normal = s * N0 + t * N1 + u * N2;
+    return isect;
 }
 
 
@@ -71,6 +512,15 @@ Shape::Shape(std::shared_ptr<Material> m)
     }
 }
 
+bool Shape::intersect(const Ray& r, float t_min, float t_max, intersection& p) const {
+    HitRecord hit;
+    if (!intersect_hit(r, t_min, t_max, hit)) {
+        return false;
+    }
+    get_intersection(r, hit, p);
+    return true;
+}
+
 float Shape::eval_pdf(const intersection& ref, const Vec3& w) const {
     auto r = Ray(ref.pos, unit_vector(w)); // refVFCv֌C
     intersection isect; // VFCv̌_
@@ -93,7 +543,7 @@ float Shape::eval_pdf(const intersection& ref, const Vec3& w) const {
 Sphere::Sphere(Vec3 c, float r, std::shared_ptr<Material> m)
     : Shape(m), center(c), radius(r) {};
 
-bool Sphere::intersect(const Ray& r, float t_min, float t_max, intersection& p) const {
+bool Sphere::intersect_hit(const Ray& r, float t_min, float t_max, HitRecord& hit) const {
     // 񎟕̔ʎD/4 = (b/2)^2 - a*c𗘗p(b͋)
     auto temp = r.get_origin() - center;
     auto a = r.get_dir().length2();
@@ -112,24 +562,50 @@ bool Sphere::intersect(const Ray& r, float t_min, float t_max, intersection& p)
             return false;
         }
     }
-    // _̍XV
-    p.t = t;
-    p.pos = r.at(t);
-    p.normal = unit_vector(p.pos - center);
-    p.is_front = is_front(r, p.normal);
-    p.mat = mat;
+    hit.t = t;
+    hit.prim_id = -1;
+    hit.shape = this;
     return true;
 };
 
+void Sphere::get_intersection(const Ray& r, const HitRecord& hit, intersection& p) const {
+    p.t = hit.t;
+    p.pos = r.at(hit.t);
+    p.normal = unit_vector(p.pos - center);
+    p.is_front = is_front(r, p.normal);
+    p.mat = mat.get();
+}
+
+bool Sphere::occluded(const Ray& r, float t_min, float t_max) const {
+    auto temp = r.get_origin() - center;
+    auto a = r.get_dir().length2();
+    auto b_half = dot(r.get_dir(), temp);
+    auto c = temp.length2() - radius * radius;
+    auto D = b_half * b_half - a * c;
+    if (D < 0) {
+        return false;
+    }
+    auto b = b_half * 2;
+    auto d = 2 * std::sqrt(D);
+    auto t0 = (-b - d) / (2 * a);
+    auto t1 = (-b + d) / (2 * a);
+    return (t0 >= t_min && t0 <= t_max) || (t1 >= t_min && t1 <= t_max);
+}
+
 float Sphere::area() const {
     return 4 * pi * radius * radius;
 }
 
-intersection Sphere::sample(const intersection& ref) const {
+AABB Sphere::get_bounds() const {
+    auto r = Vec3(radius, radius, radius);
+    return AABB(center - r, center + r);
+}
+
+intersection Sphere::sample(const intersection& ref, const Vec2& u) const {
     // ̉̈()lăTvO
     auto z = unit_vector(ref.pos - center);
     auto sampling_coord = ONB(z);
-    auto sampling_local_pos = Random::uniform_hemisphere_sample();
+    auto sampling_local_pos = Random::uniform_hemisphere_sample(u);
     intersection isect;
     isect.normal = sampling_coord.to_world(sampling_local_pos);
     isect.pos = radius * isect.normal + center;
@@ -158,138 +634,663 @@ Triangle::Triangle(Vec3 v0, Vec3 v1, Vec3 v2, std::shared_ptr<Material> m)
 Triangle::Triangle(Vec3 v0, Vec3 v1, Vec3 v2, Vec3 n0, Vec3 n1, Vec3 n2, std::shared_ptr<Material> m)
     : Shape(m), V0(v0), V1(v1), V2(v2), N0(n0), N1(n1), N2(n2) {};
 
-bool Triangle::intersect(const Ray& r, float t_min, float t_max, intersection& p) const {
-    // Ql: http://www.graphics.cornell.edu/pubs/1997/MT97.html
-    Vec3 T = r.get_origin() - V0;
-    Vec3 E1 = V1 - V0;
-    Vec3 E2 = V2 - V0;
-    Vec3 D = r.get_dir();
-    Vec3 P = cross(D, E2);
-    Vec3 Q = cross(T, E1);
-    float c = 1.0f / dot(P, E1);
-    float t = c * dot(Q, E2);
-    float u = c * dot(P, T);
-    float v = c * dot(Q, D);
-    if (t < t_min || t > t_max) {
-        return false;
-    }
-    if (u < 0.f || v < 0.f || u + v > 1.0f) {
+bool Triangle::intersect_hit(const Ray& r, float t_min, float t_max, HitRecord& hit) const {
+    float t, u, v;
+    if (!intersect_triangle(r, V0, V1, V2, t_min, t_max, t, u, v)) {
         return false;
     }
-    // _̍XV
-    p.t = t;
-    Vec3 N_lerp = (1.0f - u - v) * N0 + u * N1 + v * N2; // @
+    hit.t = t;
+    hit.b1 = u;
+    hit.b2 = v;
+    hit.prim_id = -1;
+    hit.shape = this;
+    return true;
+}
+
+void Triangle::get_intersection(const Ray& r, const HitRecord& hit, intersection& p) const {
+    p.t = hit.t;
+    Vec3 N_lerp = (1.0f - hit.b1 - hit.b2) * N0 + hit.b1 * N1 + hit.b2 * N2; // @
     p.normal = N_lerp;
     p.is_front = is_front(r, p.normal);
-    p.pos = r.at(t);
-    p.mat = mat;
-    return true;
+    p.pos = r.at(hit.t);
+    p.mat = mat.get();
+}
+
+bool Triangle::occluded(const Ray& r, float t_min, float t_max) const {
+    float t, u, v;
+    return intersect_triangle(r, V0, V1, V2, t_min, t_max, t, u, v);
 }
 
 float Triangle::area() const {
     return 0.5f * cross(V1 - V0, V2 - V0).length();
 }
 
-intersection Triangle::sample(const intersection& ref) const {
-    auto barycenter = Random::uniform_triangle_sample();
-    auto s = barycenter.get_x();
-    auto t = barycenter.get_y();
-    auto u = 1.0f - s - t;
-    intersection isect;
-    isect.pos = s * V0 + t * V1 + u * V2;
-    isect.normal = s * N0 + t * N1 + u * N2;
-    return isect;
+AABB Triangle::get_bounds() const {
+    auto bounds = AABB(V0, V1);
+    bounds.expand(V2);
+    return bounds;
+}
+
+DirectionCone Triangle::get_normal_cone() const {
+    // Ԃ@͒_@܂މ~Ɏ܂
+    return merge(merge(DirectionCone(N0), DirectionCone(N1)), DirectionCone(N2));
+}
+
+intersection Triangle::sample(const intersection& ref, const Vec2& uv) const {
+    return sample_triangle(V0, V1, V2, N0, N1, N2, uv);
 }
 
 
 // *** Op`bVNX ***
-TriangleMesh::TriangleMesh(std::vector<Vec3> Vertices, std::vector<Vec3> Indices, std::shared_ptr<Material> m)
+TriangleMesh::TriangleMesh(std::vector<Vec3> Vertices, std::vector<Vec3> Indices, std::shared_ptr<Material> m,
+    int max_leaf_size)
     : Shape(m) {
-    // _CfbNXOp`\
+    // _CfbNX𐮐ɕϊ
+    std::vector<uint32_t> tri_indices;
+    tri_indices.reserve(Indices.size() * 3);
     for (const auto& index : Indices) {
-        int x = std::max((int)index.get_x(), 0);
-        int y = std::max((int)index.get_y(), 0);
-        int z = std::max((int)index.get_z(), 0);
-        Vec3 V0 = Vertices[x];
-        Vec3 V1 = Vertices[y];
-        Vec3 V2 = Vertices[z];
-        Triangles.push_back(Triangle(V0, V1, V2, m));
+        tri_indices.push_back(std::max((int)index.get_x(), 0));
+        tri_indices.push_back(std::max((int)index.get_y(), 0));
+        tri_indices.push_back(std::max((int)index.get_z(), 0));
     }
+    build(Vertices, {}, std::move(tri_indices), max_leaf_size);
 };
 
-TriangleMesh::TriangleMesh(std::string filename, std::shared_ptr<Material> m, bool is_smooth)
+TriangleMesh::TriangleMesh(std::string filename, std::shared_ptr<Material> m, bool is_smooth,
+    int max_leaf_size, bool use_cache, float crease_angle, NormalWeighting weighting)
     : Shape(m) {
-    std::vector<Vec3> Vertices, Indices;
-    load_obj(Vertices, Indices, filename);
-    std::vector<Vec3> Normals(Vertices.size(), Vec3::zero); // _̖@z
+    if (!load_file(filename, is_smooth, max_leaf_size, use_cache, crease_angle, weighting)) {
+        std::cerr << "Failed to load " << filename << '\n';
+        exit(1);
+    }
+};
+
+std::shared_ptr<TriangleMesh> TriangleMesh::create(const std::string& filename, std::shared_ptr<Material> m,
+    bool is_smooth, int max_leaf_size, bool use_cache, float crease_angle, NormalWeighting weighting) {
+    std::shared_ptr<TriangleMesh> mesh(new TriangleMesh(m));
+    if (!mesh->load_file(filename, is_smooth, max_leaf_size, use_cache, crease_angle, weighting)) {
+        return nullptr;
+    }
+    return mesh;
+}
+
+bool TriangleMesh::load_file(const std::string& filename, bool is_smooth, int max_leaf_size,
+    bool use_cache, float crease_angle, NormalWeighting weighting) {
+    // LȃLbVΉ͂BVH̍\zȗ
+    const std::string cache_path = filename + ".cache";
+    if (use_cache && load_cache(cache_path, filename, is_smooth, max_leaf_size, crease_angle, weighting)) {
+        std::cout << cache_path << ": " << bvh.get_stats() << '\n';
+        return true;
+    }
+    ObjMesh obj;
+    if (!load_obj(filename, obj)) {
+        return false;
+    }
+    std::vector<Vec3> Vertices = std::move(obj.positions);
+    std::vector<uint32_t> tri_indices = std::move(obj.indices);
+    std::vector<Vec3> Normals; // _̖@z
     // X[YVF[fBO
-    if (is_smooth) {
-        for (int i = 0; i < (int)Vertices.size(); i++) {
-            // _i̖@אڂOp`̖@̏dݕtaŌvZ
-            for (const auto& index : Indices) {
-                int x = (int)index.get_x() - 1;
-                int y = (int)index.get_y() - 1;
-                int z = (int)index.get_z() - 1;
-                if (i == x || i == y || i == z) {
-                    // _擾
-                    Vec3 V0 = Vertices[x];
-                    Vec3 V1 = Vertices[y];
-                    Vec3 V2 = Vertices[z];
-                    // @vZ
+    if (is_smooth && !obj.normal_indices.empty()) {
+        // t@C̖@g(_WƖ@̑gƂɒ_𕪂)
+        std::unordered_map<uint64_t, uint32_t> vertex_map;
+        std::vector<Vec3> split_vertices;
+        for (size_t k = 0; k < tri_indices.size(); k++) {
+            uint64_t key = ((uint64_t)tri_indices[k] << 32) | obj.normal_indices[k];
+            auto [iter, is_new] = vertex_map.try_emplace(key, (uint32_t)split_vertices.size());
+            if (is_new) {
+                split_vertices.push_back(Vertices[tri_indices[k]]);
+                Normals.push_back(unit_vector(obj.normals[obj.normal_indices[k]]));
+            }
+            tri_indices[k] = iter->second;
+        }
+        Vertices = std::move(split_vertices);
+    }
+    else if (is_smooth) {
+        compute_smooth_normals(Vertices, tri_indices, Normals, crease_angle, weighting);
+    }
+    build(Vertices, std::move(Normals), std::move(tri_indices), max_leaf_size);
+    std::cout << filename << ": " << bvh.get_stats() << '\n';
+    if (use_cache && !save_cache(cache_path, filename, is_smooth, max_leaf_size, crease_angle, weighting)) {
+        std::cerr << "Failed to write " << cache_path << '\n';
+    }
+    return true;
+}
+
+void TriangleMesh::build(const std::vector<Vec3>& vertices, std::vector<Vec3>&& vertex_normals,
+    std::vector<uint32_t>&& tri_indices, int max_leaf_size) {
+    // _W𐬕Ƃ̔zɊi[
+    px.resize(vertices.size());
+    py.resize(vertices.size());
+    pz.resize(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++) {
+        px[i] = vertices[i].get_x();
+        py[i] = vertices[i].get_y();
+        pz[i] = vertices[i].get_z();
+    }
+    normals = std::move(vertex_normals);
+    indices = std::move(tri_indices);
+    // Op`̋E{bNXBVH\z
+    const int num_triangles = get_num_triangles();
+    std::vector<AABB> tri_bounds;
+    tri_bounds.reserve(num_triangles);
+    total_area = 0.f;
+    for (int i = 0; i < num_triangles; i++) {
+        Vec3 V0, V1, V2;
+        get_vertices(i, V0, V1, V2);
+        auto bounds = AABB(V0, V1);
+        bounds.expand(V2);
+        tri_bounds.push_back(bounds);
+        total_area += 0.5f * cross(V1 - V0, V2 - V0).length();
+    }
+    bvh = BVH(tri_bounds, max_leaf_size, BVHSplit::SAH);
+    // PꃌC̒T4؂SIMDɂ锻̕
+    set_wide_bvh(true);
+}
+
+bool TriangleMesh::save_cache(const std::string& cache_path, const std::string& source_path,
+    bool is_smooth, int max_leaf_size, float crease_angle, NormalWeighting weighting) const {
+    MeshCacheHeader header;
+    if (!make_cache_header(source_path, is_smooth, max_leaf_size, crease_angle, weighting, header)) {
+        return false;
+    }
+    header.num_vertices = px.size();
+    header.num_normals = normals.size();
+    header.num_indices = indices.size();
+    header.num_nodes = bvh.get_nodes().size();
+    header.num_prims = bvh.get_prim_indices().size();
+    header.num_wide_nodes = wbvh.get_nodes().size();
+    header.num_wide_leaves = wbvh.get_leaves().size();
+    header.num_quads = quads.size();
+    header.total_area = total_area;
+    header.stats = bvh.get_stats();
+    // ̃WuƏՓ˂Ȃꎞt@CɏĂu
+    std::random_device rd;
+    const std::string tmp_path = cache_path + ".tmp" + std::to_string(rd());
+    {
+        std::ofstream ofs(tmp_path, std::ios::binary);
+        if (!ofs) {
+            return false;
+        }
+        size_t offset = 0;
+        auto write = [&](const void* data, size_t size) {
+            // z̐擪𑵂
+            static const char padding[MESH_CACHE_ALIGNMENT] = { 0 };
+            size_t pad = (MESH_CACHE_ALIGNMENT - offset % MESH_CACHE_ALIGNMENT) % MESH_CACHE_ALIGNMENT;
+            ofs.write(padding, pad);
+            ofs.write((const char*)data, size);
+            offset += pad + size;
+        };
+        write(&header, sizeof(header));
+        write(px.data(), px.size() * sizeof(float));
+        write(py.data(), py.size() * sizeof(float));
+        write(pz.data(), pz.size() * sizeof(float));
+        write(normals.data(), normals.size() * sizeof(Vec3));
+        write(indices.data(), indices.size() * sizeof(uint32_t));
+        write(bvh.get_nodes().data(), bvh.get_nodes().size() * sizeof(BVHNode));
+        write(bvh.get_prim_indices().data(), bvh.get_prim_indices().size() * sizeof(int));
+        write(wbvh.get_nodes().data(), wbvh.get_nodes().size() * sizeof(WideBVHNode));
+        write(wbvh.get_leaves().data(), wbvh.get_leaves().size() * sizeof(WideBVHLeaf));
+        write(quads.data(), quads.size() * sizeof(TriangleQuad));
+        write(leaf_quads.data(), leaf_quads.size() * sizeof(int));
+        if (!ofs) {
+            ofs.close();
+            std::filesystem::remove(tmp_path);
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, cache_path, ec);
+    if (ec) {
+        std::filesystem::remove(tmp_path, ec);
+        return false;
+    }
+    return true;
+}
+
+bool TriangleMesh::load_cache(const std::string& cache_path, const std::string& source_path,
+    bool is_smooth, int max_leaf_size, float crease_angle, NormalWeighting weighting) {
+    MeshCacheHeader expected;
+    if (!make_cache_header(source_path, is_smooth, max_leaf_size, crease_angle, weighting, expected)) {
+        return false;
+    }
+    MappedFile file;
+    if (!file.open(cache_path) || file.get_size() < sizeof(MeshCacheHeader)) {
+        return false;
+    }
+    MeshCacheHeader header;
+    std::memcpy(&header, file.get_data(), sizeof(header));
+    // `ƌt@CCǂݍݐݒ肪v邩mF
+    if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 ||
+        header.version != expected.version || header.layout != expected.layout ||
+        header.source_size != expected.source_size || header.source_time != expected.source_time ||
+        header.is_smooth != expected.is_smooth || header.max_leaf_size != expected.max_leaf_size ||
+        header.crease_angle != expected.crease_angle || header.weighting != expected.weighting) {
+        return false;
+    }
+    // zɕ(t@CrŐ؂ĂΖ)
+    size_t offset = sizeof(header);
+    bool is_valid = true;
+    auto read = [&](auto& v, uint64_t count) {
+        using T = typename std::decay_t<decltype(v)>::value_type;
+        offset += (MESH_CACHE_ALIGNMENT - offset % MESH_CACHE_ALIGNMENT) % MESH_CACHE_ALIGNMENT;
+        if (!is_valid || count > (file.get_size() - std::min(offset, file.get_size())) / sizeof(T)) {
+            is_valid = false;
+            return;
+        }
+        v.resize(count);
+        std::memcpy(v.data(), file.get_data() + offset, count * sizeof(T));
+        offset += count * sizeof(T);
+    };
+    std::vector<BVHNode> nodes;
+    std::vector<int> prim_indices;
+    std::vector<WideBVHNode> wide_nodes;
+    std::vector<WideBVHLeaf> wide_leaves;
+    read(px, header.num_vertices);
+    read(py, header.num_vertices);
+    read(pz, header.num_vertices);
+    read(normals, header.num_normals);
+    read(indices, header.num_indices);
+    read(nodes, header.num_nodes);
+    read(prim_indices, header.num_prims);
+    read(wide_nodes, header.num_wide_nodes);
+    read(wide_leaves, header.num_wide_leaves);
+    read(quads, header.num_quads);
+    read(leaf_quads, header.num_wide_leaves > 0 ? header.num_wide_leaves + 1 : 0);
+    if (!is_valid) {
+        px.clear();
+        py.clear();
+        pz.clear();
+        normals.clear();
+        indices.clear();
+        quads.clear();
+        leaf_quads.clear();
+        return false;
+    }
+    total_area = header.total_area;
+    std::vector<int> wide_prim_indices;
+    if (!wide_nodes.empty()) {
+        wide_prim_indices = prim_indices; // 4؂͓񕪖؂Ɠt̏g
+    }
+    bvh = BVH(std::move(nodes), std::move(prim_indices), header.stats);
+    wbvh = WideBVH(std::move(wide_nodes), std::move(wide_leaves), std::move(wide_prim_indices));
+    return true;
+}
+
+void TriangleMesh::get_vertices(int i, Vec3& V0, Vec3& V1, Vec3& V2) const {
+    V0 = get_vertex(indices[3 * i]);
+    V1 = get_vertex(indices[3 * i + 1]);
+    V2 = get_vertex(indices[3 * i + 2]);
+}
+
+void TriangleMesh::get_normals(int i, Vec3& N0, Vec3& N1, Vec3& N2) const {
+    if (!normals.empty()) {
+        N0 = normals[indices[3 * i]];
+        N1 = normals[indices[3 * i + 1]];
+        N2 = normals[indices[3 * i + 2]];
+        return;
+    }
+    // ʖ@
+    Vec3 V0, V1, V2;
+    get_vertices(i, V0, V1, V2);
+    N0 = unit_vector(cross(V1 - V0, V2 - V0));
+    N1 = N0;
+    N2 = N0;
+}
+
+Triangle TriangleMesh::get_triangle(int i) const {
+    Vec3 V0, V1, V2, N0, N1, N2;
+    get_vertices(i, V0, V1, V2);
+    get_normals(i, N0, N1, N2);
+    return Triangle(V0, V1, V2, N0, N1, N2, mat);
+}
+
+float TriangleMesh::get_triangle_area(int i, const Transform& t) const {
+    Vec3 V0, V1, V2;
+    get_vertices(i, V0, V1, V2);
+    return 0.5f * cross(t.apply_vector(V1 - V0), t.apply_vector(V2 - V0)).length();
+}
+
+intersection TriangleMesh::sample_triangle_at(int i, const Vec2& u) const {
+    Vec3 V0, V1, V2, N0, N1, N2;
+    get_vertices(i, V0, V1, V2);
+    get_normals(i, N0, N1, N2);
+    return sample_triangle(V0, V1, V2, N0, N1, N2, u);
+}
+
+void TriangleMesh::set_intersector(TriangleIntersector type) {
+    intersector = type;
+    transforms.clear();
+    if (intersector == TriangleIntersector::BaldwinWeber) {
+        // Op`Ƃ̕ϊOvZ
+        transforms.resize(12 * get_num_triangles());
+        for (int i = 0; i < get_num_triangles(); i++) {
+            Vec3 V0, V1, V2;
+            get_vertices(i, V0, V1, V2);
+            compute_baldwin_weber_transform(V0, V1, V2, &transforms[12 * i]);
+        }
+    }
+    transforms.shrink_to_fit();
+}
+
+void TriangleMesh::set_wide_bvh(bool is_wide) {
+    wbvh = WideBVH();
+    quads.clear();
+    leaf_quads.clear();
+    if (is_wide) {
+        // tƂɎOp`4܂Ƃ߂([͋󂫂Ŗ߂)
+        wbvh = WideBVH(bvh);
+        leaf_quads.reserve(wbvh.get_num_leaves() + 1);
+        for (int l = 0; l < wbvh.get_num_leaves(); l++) {
+            leaf_quads.push_back((int)quads.size());
+            const auto& leaf = wbvh.get_leaf(l);
+            for (int k = 0; k < leaf.nprims; k += WIDE_BVH_WIDTH) {
+                TriangleQuad q = {};
+                for (int j = 0; j < WIDE_BVH_WIDTH; j++) {
+                    q.prim_id[j] = -1;
+                    if (k + j >= leaf.nprims) continue;
+                    int i = wbvh.get_prim_index(leaf.offset + k + j);
+                    Vec3 V0, V1, V2;
+                    get_vertices(i, V0, V1, V2);
                     Vec3 E1 = V1 - V0;
                     Vec3 E2 = V2 - V0;
-                    Vec3 N = cross(E1, E2);
-                    Normals[i] += N;
+                    for (int a = 0; a < 3; a++) {
+                        q.v0[a][j] = V0[a];
+                        q.e1[a][j] = E1[a];
+                        q.e2[a][j] = E2[a];
+                    }
+                    q.prim_id[j] = i;
                 }
+                quads.push_back(q);
             }
-            Normals[i] = unit_vector(Normals[i]); // K
         }
+        leaf_quads.push_back((int)quads.size());
     }
-    // _CfbNXOp`\
-    for (const auto& index : Indices) {
-        int x = std::max((int)index.get_x()-1, 0);
-        int y = std::max((int)index.get_y()-1, 0);
-        int z = std::max((int)index.get_z()-1, 0);
-        Vec3 V0 = Vertices[x];
-        Vec3 V1 = Vertices[y];
-        Vec3 V2 = Vertices[z];
-        // X[YVF[fBO
-        if (is_smooth) {
-            Vec3 N0 = Normals[x];
-            Vec3 N1 = Normals[y];
-            Vec3 N2 = Normals[z];
-            Triangles.push_back(Triangle(V0, V1, V2, N0, N1, N2, m));
-        }
-        else {
-            Triangles.push_back(Triangle(V0, V1, V2, m));
+    quads.shrink_to_fit();
+}
+
+template <typename F>
+bool TriangleMesh::intersect_triangles(const Ray& r, float t_min, float t_max, HitRecord& hit,
+    F intersect_tri) const {
+    // Op`ƌL^ĒTԂ߂
+    auto intersect_prim = [&](int i, float t_near, float& t_far) {
+        float t, u, v;
+        if (intersect_tri(i, t_near, t_far, t, u, v)) {
+            t_far = t;
+            hit.t = t;
+            hit.b1 = u;
+            hit.b2 = v;
+            hit.prim_id = i;
+            return true;
         }
+        return false;
+    };
+    // BVHTĎOp`̒ňԍŏɌ_T
+    bool is_isect = false;
+    if (!wbvh.is_empty()) {
+        is_isect = wbvh.intersect(r, t_min, t_max, [&](int l, float t_near, float& t_far) {
+            const auto& leaf = wbvh.get_leaf(l);
+            bool is_hit = false;
+            for (int k = 0; k < leaf.nprims; k++) {
+                is_hit |= intersect_prim(wbvh.get_prim_index(leaf.offset + k), t_near, t_far);
+            }
+            return is_hit;
+        });
     }
-};
+    else {
+        is_isect = bvh.intersect(r, t_min, t_max, intersect_prim);
+    }
+    if (is_isect) {
+        hit.shape = this;
+    }
+    return is_isect;
+}
 
-bool TriangleMesh::intersect(const Ray& r, float t_min, float t_max, intersection& p) const {
-    p.t = t_max;
-    bool is_isect = false;
-    intersection first_isect_temp;
-    // Opn̒ňԍŏɌ_T
-    for (const auto& tri : Triangles) {
-        if (tri.intersect(r, t_min, p.t, first_isect_temp)) {
-            p = first_isect_temp;
-            is_isect = true;
+template <typename F>
+bool TriangleMesh::occluded_triangles(const Ray& r, float t_min, float t_max, F occluded_tri) const {
+    // Op`łΑł؂
+    if (!wbvh.is_empty()) {
+        return wbvh.occluded(r, t_min, t_max, [&](int l) {
+            const auto& leaf = wbvh.get_leaf(l);
+            for (int k = 0; k < leaf.nprims; k++) {
+                if (occluded_tri(wbvh.get_prim_index(leaf.offset + k))) {
+                    return true;
+                }
+            }
+            return false;
+        });
+    }
+    return bvh.occluded(r, t_min, t_max, occluded_tri);
+}
+
+bool TriangleMesh::intersect_quads(const Ray& r, float t_min, float t_max, HitRecord& hit) const {
+    bool is_isect = wbvh.intersect(r, t_min, t_max, [&](int l, float t_near, float& t_far) {
+        bool is_hit = false;
+        for (int k = leaf_quads[l]; k < leaf_quads[l + 1]; k++) {
+            const auto& q = quads[k];
+            __m128 t4, u4, v4;
+            int mask = intersect_triangle_quad(r, q, t_near, t_far, t4, u4, v4);
+            if (mask == 0) continue;
+            alignas(16) float t[WIDE_BVH_WIDTH], u[WIDE_BVH_WIDTH], v[WIDE_BVH_WIDTH];
+            _mm_store_ps(t, t4);
+            _mm_store_ps(u, u4);
+            _mm_store_ps(v, v4);
+            // ɔ肵ꍇƓCΌ̎Op`I
+            for (int j = 0; j < WIDE_BVH_WIDTH; j++) {
+                if ((mask & (1 << j)) && t[j] <= t_far) {
+                    t_far = t[j];
+                    hit.t = t[j];
+                    hit.b1 = u[j];
+                    hit.b2 = v[j];
+                    hit.prim_id = q.prim_id[j];
+                    is_hit = true;
+                }
+            }
         }
+        return is_hit;
+    });
+    if (is_isect) {
+        hit.shape = this;
     }
     return is_isect;
 }
 
+bool TriangleMesh::occluded_quads(const Ray& r, float t_min, float t_max) const {
+    return wbvh.occluded(r, t_min, t_max, [&](int l) {
+        for (int k = leaf_quads[l]; k < leaf_quads[l + 1]; k++) {
+            __m128 t, u, v;
+            if (intersect_triangle_quad(r, quads[k], t_min, t_max, t, u, v)) {
+                return true;
+            }
+        }
+        return false;
+    });
+}
+
+bool TriangleMesh::intersect_hit(const Ray& r, float t_min, float t_max, HitRecord& hit) const {
+    // @ƂBVH̒Tꉻ
+    switch (intersector) {
+    case TriangleIntersector::BaldwinWeber:
+        return intersect_triangles(r, t_min, t_max, hit,
+            [&](int i, float t_near, float t_far, float& t, float& u, float& v) {
+                return intersect_triangle_baldwin_weber(r, &transforms[12 * i], t_near, t_far, t, u, v);
+            });
+    case TriangleIntersector::Watertight: {
+        const WatertightRay wr(r);
+        return intersect_triangles(r, t_min, t_max, hit,
+            [&](int i, float t_near, float t_far, float& t, float& u, float& v) {
+                Vec3 V0, V1, V2;
+                get_vertices(i, V0, V1, V2);
+                return intersect_triangle_watertight(wr, V0, V1, V2, t_near, t_far, t, u, v);
+            });
+    }
+    case TriangleIntersector::MollerTrumbore:
+    default:
+        if (!quads.empty()) {
+            return intersect_quads(r, t_min, t_max, hit);
+        }
+        return intersect_triangles(r, t_min, t_max, hit,
+            [&](int i, float t_near, float t_far, float& t, float& u, float& v) {
+                Vec3 V0, V1, V2;
+                get_vertices(i, V0, V1, V2);
+                return intersect_triangle(r, V0, V1, V2, t_near, t_far, t, u, v);
+            });
+    }
+}
+
+void TriangleMesh::get_intersection(const Ray& r, const HitRecord& hit, intersection& p) const {
+    Vec3 N0, N1, N2;
+    get_normals(hit.prim_id, N0, N1, N2);
+    p.t = hit.t;
+    Vec3 N_lerp = (1.0f - hit.b1 - hit.b2) * N0 + hit.b1 * N1 + hit.b2 * N2; // @
+    p.normal = N_lerp;
+    p.is_front = is_front(r, p.normal);
+    p.pos = r.at(hit.t);
+    p.mat = mat.get();
+}
+
+bool TriangleMesh::occluded(const Ray& r, float t_min, float t_max) const {
+    float t, u, v;
+    switch (intersector) {
+    case TriangleIntersector::BaldwinWeber:
+        return occluded_triangles(r, t_min, t_max, [&](int i) {
+            return intersect_triangle_baldwin_weber(r, &transforms[12 * i], t_min, t_max, t, u, v);
+        });
+    case TriangleIntersector::Watertight: {
+        const WatertightRay wr(r);
+        return occluded_triangles(r, t_min, t_max, [&](int i) {
+            Vec3 V0, V1, V2;
+            get_vertices(i, V0, V1, V2);
+            return intersect_triangle_watertight(wr, V0, V1, V2, t_min, t_max, t, u, v);
+        });
+    }
+    case TriangleIntersector::MollerTrumbore:
+    default:
+        if (!quads.empty()) {
+            return occluded_quads(r, t_min, t_max);
+        }
+        return occluded_triangles(r, t_min, t_max, [&](int i) {
+            Vec3 V0, V1, V2;
+            get_vertices(i, V0, V1, V2);
+            return intersect_triangle(r, V0, V1, V2, t_min, t_max, t, u, v);
+        });
+    }
+}
+
 float TriangleMesh::area() const {
-    float a = 0.f;
-    for (const auto& tri : Triangles) {
-        a += tri.area();
+    return total_area;
+}
+
+AABB TriangleMesh::get_bounds() const {
+    return bvh.get_bounds();
+}
+
+DirectionCone TriangleMesh::get_normal_cone() const {
+    DirectionCone cone;
+    for (int i = 0; i < get_num_triangles(); i++) {
+        // Ԃ@͒_@܂މ~Ɏ܂
+        Vec3 N0, N1, N2;
+        get_normals(i, N0, N1, N2);
+        cone = merge(cone, merge(merge(DirectionCone(N0), DirectionCone(N1)), DirectionCone(N2)));
     }
-    return a;
+    return cone;
 }
 
-intersection TriangleMesh::sample(const intersection& p) const {
+intersection TriangleMesh::sample(const intersection& p, const Vec2& u) const {
     // ʐςɖ֌WɈ̎OpVFCvTvO
-    auto index = Random::uniform_int(0, Triangles.size() - 1);
-    return Triangles[index].sample(p);
+    // u[0]ŎOp`IсCc̒[[0, 1)ɈL΂ĎOp`̃TvOɍėp
+    int n = get_num_triangles();
+    int index = std::min((int)(u[0] * n), n - 1);
+    float u_remapped = std::min(u[0] * n - index, one_minus_epsilon);
+    Vec3 V0, V1, V2, N0, N1, N2;
+    get_vertices(index, V0, V1, V2);
+    get_normals(index, N0, N1, N2);
+    return sample_triangle(V0, V1, V2, N0, N1, N2, Vec2(u_remapped, u[1]));
+}
+
+
+// *** CX^X ***
+
+Instance::Instance(std::shared_ptr<const Shape> _prototype, const Transform& _to_world,
+                   std::shared_ptr<Material> m)
+    : Shape(m ? m : _prototype->get_mat()), prototype(_prototype),
+      to_world(_to_world), to_object(_to_world.inverse())
+{
+    bounds = to_world.apply(prototype->get_bounds());
+    // ϊł͖ʐς͈lȊg嗦s2{ŁCTvO̕zςȂ
+    world_area = prototype->area() * std::pow(std::abs(to_world.determinant()), 2.0f / 3.0f);
+    auto mesh = dynamic_cast<const TriangleMesh*>(prototype.get());
+    if (mesh && !to_world.is_similarity()) {
+        // Op`Ƃɖʐς̊g嗦قȂ̂ŁCϊ̖ʐς𑫂킹ĖʐςɔႵđI
+        std::vector<float> areas(mesh->get_num_triangles());
+        double sum = 0.0;
+        for (int i = 0; i < (int)areas.size(); i++) {
+            areas[i] = mesh->get_triangle_area(i, to_world);
+            sum += areas[i];
+        }
+        world_area = (float)sum;
+        triangle_table = AliasTable(areas);
+    }
+}
+
+bool Instance::intersect_hit(const Ray& r, float t_min, float t_max, HitRecord& hit) const {
+    // 𐳋Kɕϊ̂ŕ̍Wnłt̋Ԃ͂̂܂܎g
+    if (!prototype->intersect_hit(to_object.apply(r), t_min, t_max, hit)) {
+        return false;
+    }
+    // Op`̔ԍƏdSW̓vg^Cv̂̂c
+    hit.shape = this;
+    return true;
+}
+
+void Instance::get_intersection(const Ray& r, const HitRecord& hit, intersection& p) const {
+    HitRecord local_hit = hit;
+    local_hit.shape = prototype.get();
+    prototype->get_intersection(to_object.apply(r), local_hit, p);
+    // @͋ts̓]uŕϊ̂ŕϊ̑OŃCƂ̓ς̕(\)͕ςȂ
+    p.pos = to_world.apply_point(p.pos);
+    p.normal = unit_vector(to_world.apply_normal(p.normal));
+    p.mat = mat.get();
+}
+
+bool Instance::occluded(const Ray& r, float t_min, float t_max) const {
+    return prototype->occluded(to_object.apply(r), t_min, t_max);
+}
+
+float Instance::area() const {
+    return world_area;
+}
+
+AABB Instance::get_bounds() const {
+    return bounds;
+}
+
+DirectionCone Instance::get_normal_cone() const {
+    auto cone = prototype->get_normal_cone();
+    if (cone.is_empty() || cone.cos_theta <= -1.0f) {
+        return cone;
+    }
+    // ϊȊOł͖@Ԃ̊pxς
+    if (!to_world.is_similarity()) {
+        return DirectionCone::entire_sphere();
+    }
+    return DirectionCone(to_world.apply_normal(cone.w), cone.cos_theta);
+}
+
+intersection Instance::sample(const intersection& ref, const Vec2& u) const {
+    intersection local_ref = ref;
+    local_ref.pos = to_object.apply_point(ref.pos);
+    local_ref.normal = unit_vector(to_object.apply_normal(ref.normal));
+    intersection isect;
+    if (triangle_table.is_empty()) {
+        isect = prototype->sample(local_ref, u);
+    }
+    else {
+        // AtBϊ͎Op`̈lzۂ̂ŁCOp`̑Iϊ̖ʐςɍ킹
+        float pmf, u_remapped;
+        int index = triangle_table.sample(u[0], pmf, u_remapped);
+        isect = static_cast<const TriangleMesh*>(prototype.get())->sample_triangle_at(index, Vec2(u_remapped, u[1]));
+    }
+    isect.pos = to_world.apply_point(isect.pos);
+    isect.normal = unit_vector(to_world.apply_normal(isect.normal));
+    return isect;
 }
\ No newline at end of file
@@ -5,12 +5,19 @@
 
 #pragma once
 
+#include <cstdint>
 #include <vector>
+#include "AABB.h"
+#include "BVH.h"
 #include "Math.h"
+#include "Random.h"
+#include "Transform.h"
+#include "WideBVH.h"
 
 class Material;
 class Light;
 class Ray;
+class Shape;
 
 
 /** _̎ */
@@ -20,15 +27,55 @@ enum class IsectType {
     Light    = 1 << 2   /**<      */
 };
 
-/** _ */
+/** Op`bV̌̎@ */
+enum class TriangleIntersector {
+    MollerTrumbore = 1 << 0,  /**< Moller-Trumbore@(ӂ𖈉vZ)              */
+    BaldwinWeber   = 1 << 1,  /**< Baldwin-Weber@(Op`Ƃ̃AtBϊOvZ) */
+    Watertight     = 1 << 2   /**< Woop̐Ȍ(ӏ̎肱ڂȂ) */
+};
+
+
+/** X[YVF[fBO̒_@̏dݕt */
+enum class NormalWeighting {
+    Area  = 1 << 0,  /**< אڂʂ̖ʐςŏdݕt     */
+    Angle = 1 << 1   /**< _ł̖ʂ̓pŏdݕt     */
+};
+
+
+/** SIMD4Ɍ肷Op`̑g(SoA) */
+struct alignas(16) TriangleQuad {
+    float v0[3][WIDE_BVH_WIDTH]; /**< _V0[][Op`]                  */
+    float e1[3][WIDE_BVH_WIDTH]; /**< V1-V0[][Op`]                 */
+    float e2[3][WIDE_BVH_WIDTH]; /**< V2-V0[][Op`]                 */
+    int prim_id[WIDE_BVH_WIDTH]; /**< Op`̔ԍ(󂫂-1)              */
+};
+
+
+/**
+* @brief _
+* @note }eAƌ̓V[L̂ŎQƃJEgȂ|C^ŕێ
+*/
 struct intersection {
     Vec3 pos;                              /**< W             */
     Vec3 normal;                           /**< @             */
     float t=0.f;                           /**< C̃p[^ */
     bool is_front=true;                    /**< _̗\     */
     IsectType type=IsectType::None;        /**< _̎     */
-    std::shared_ptr<Material> mat=nullptr; /**< ގ̎       */
-    std::shared_ptr<Light> light=nullptr;  /**< ̎       */
+    const Material* mat=nullptr;           /**< ގ̎       */
+    const Light* light=nullptr;            /**< ̎       */
+};
+
+
+/**
+* @brief ł߂_̒TɍXV̋L^
+* @note W@Ȃǂ̃VF[fBO͍ŏIIȌ_ɂĂ̂Shape::get_intersectionŌvZ
+*/
+struct HitRecord {
+    float t=inf;               /**< C̃p[^             */
+    float b1=0.f;              /**< Op`̒_V1̏dSW     */
+    float b2=0.f;              /**< Op`̒_V2̏dSW     */
+    int prim_id=-1;            /**< bV̎Op`̔ԍ     */
+    const Shape* shape=nullptr; /**< VFCv            */
 };
 
 
@@ -45,15 +92,48 @@ public:
 
     void set_mat(const std::shared_ptr<Material> m) { mat = m; }
 
+    std::shared_ptr<Material> get_mat() const { return mat; }
+
     /**
-    * @brief CƃVFCv̌s֐
+    * @brief CƃVFCv̌s_vZ֐
     * @param[in]  r     :˃C
     * @param[in]  t_min :˃C̃p[^
     * @param[in]  t_max :˃C̃p[^
     * @param[out] p     :_
     * @return bool      :̌
     */
-    virtual bool intersect(const Ray& r, float t_min, float t_max, intersection& p) const = 0;
+    bool intersect(const Ray& r, float t_min, float t_max, intersection& p) const;
+
+    /**
+    * @brief CƃVFCv̌s֐
+    * @param[in]  r     :˃C
+    * @param[in]  t_min :˃C̃p[^
+    * @param[in]  t_max :˃C̃p[^
+    * @param[out] hit   :̋L^(Ȃꍇ͕ύXȂ)
+    * @return bool      :̌
+    */
+    virtual bool intersect_hit(const Ray& r, float t_min, float t_max, HitRecord& hit) const = 0;
+
+    /**
+    * @brief ̋L^_vZ֐
+    * @param[in]  r   :˃C
+    * @param[in]  hit :intersect_hitœ̋L^
+    * @param[out] p   :_
+    */
+    virtual void get_intersection(const Ray& r, const HitRecord& hit, intersection& p) const = 0;
+
+    /**
+    * @brief CԓŃVFCvƌ邩肷֐
+    * @param[in]  r     :˃C
+    * @param[in]  t_min :˃C̃p[^
+    * @param[in]  t_max :˃C̃p[^
+    * @return bool      :true
+    * @note VhECpɌ_𐶐Cŏ̌őł؂
+    */
+    virtual bool occluded(const Ray& r, float t_min, float t_max) const {
+        HitRecord hit;
+        return intersect_hit(r, t_min, t_max, hit);
+    }
 
     /**
     * @brief VFCv̕\ʐςvZ֐
@@ -61,6 +141,18 @@ public:
     */
     virtual float area() const = 0;
 
+    /**
+    * @brief VFCṽ[hWnł̋E{bNX擾֐
+    * @return AABB :E{bNX
+    */
+    virtual AABB get_bounds() const = 0;
+
+    /**
+    * @brief VFCv̕\ʂ̖@SĊ܂މ~擾֐
+    * @return DirectionCone :@̉~
+    */
+    virtual DirectionCone get_normal_cone() const { return DirectionCone::entire_sphere(); }
+
     /**
     * @brief VFCv̓_TvOꍇ̗̊pɊւmx]֐
     * @param[in] ref :TvǑ_
@@ -73,9 +165,10 @@ public:
     /**
     * @brief VFCv̓_TvO֐
     * @param[in] ref       :TvǑ_
+    * @param[in] u         :[0, 1)^2̈lȃTv
     * @return intersection :Tv_
     */
-    virtual intersection sample(const intersection& ref) const = 0;
+    virtual intersection sample(const intersection& ref, const Vec2& u) const = 0;
 
 protected:
     std::shared_ptr<Material> mat; /**< }eA */
@@ -93,11 +186,17 @@ public:
     */
     Sphere(Vec3 c, float r, std::shared_ptr<Material> m);
 
-    bool intersect(const Ray& r, float t_min, float t_max, intersection& p) const override;
+    bool intersect_hit(const Ray& r, float t_min, float t_max, HitRecord& hit) const override;
+
+    void get_intersection(const Ray& r, const HitRecord& hit, intersection& p) const override;
+
+    bool occluded(const Ray& r, float t_min, float t_max) const override;
 
     float area() const override;
 
-    intersection sample(const intersection& ref) const override;
+    AABB get_bounds() const override;
+
+    intersection sample(const intersection& ref, const Vec2& u) const override;
 
 private:
     Vec3 center;                   /**< SW   */
@@ -129,11 +228,19 @@ public:
     */
     Triangle(Vec3 v0, Vec3 v1, Vec3 v2, Vec3 n0, Vec3 n1, Vec3 n2, std::shared_ptr<Material> m);
 
-    bool intersect(const Ray& r, float t_min, float t_max, intersection& p) const override;
+    bool intersect_hit(const Ray& r, float t_min, float t_max, HitRecord& hit) const override;
+
+    void get_intersection(const Ray& r, const HitRecord& hit, intersection& p) const override;
+
+    bool occluded(const Ray& r, float t_min, float t_max) const override;
 
     float area() const override;
 
-    intersection sample(const intersection& ref) const override;
+    AABB get_bounds() const override;
+
+    DirectionCone get_normal_cone() const override;
+
+    intersection sample(const intersection& ref, const Vec2& u) const override;
 
 private:
     Vec3 V0, V1, V2;               /**< _       */
@@ -149,24 +256,271 @@ public:
     * @param[in] vertices :Op`̒_z
     * @param[in] indices  :Op`̃CfbNXz
     * @param[in] m        :}eA
+    * @param[in] max_leaf_size :BVH̗tɊi[Op`̍ő吔
     */
     TriangleMesh(std::vector<Vec3> vertices, std::vector<Vec3> indices, 
-                 std::shared_ptr<Material> m);
+                 std::shared_ptr<Material> m, int max_leaf_size=4);
 
     /**
     * @brief .objt@COp`bVVFCv
     * @param[in] filename  :.objt@C̃pX
     * @param[in] m         :}eA
     * @param[in] is_smooth :trueȂX[YVF[fBOKp
+    * @param[in] max_leaf_size :BVH̗tɊi[Op`̍ő吔
+    * @param[in] use_cache :trueȂ"<filename>.cache"̃LbVt@Cǂݏ
+    * @param[in] crease_angle :̊px[deg]傫܂ꂽӂł͖@𕽊Ȃ(180ȏȂSĕ)
+    * @param[in] weighting :_@̏dݕt
+    * @note LbV.objt@C̍XVƃTCYCǂݍݐݒ肪vꍇ̂ݎg
+    * @note .objt@CSĂ̖ʂɖ@(vn)ꍇ̖͂@g
     */
-    TriangleMesh(std::string filename, std::shared_ptr<Material> m, bool is_smooth=true);
+    TriangleMesh(std::string filename, std::shared_ptr<Material> m, bool is_smooth=true,
+                 int max_leaf_size=4, bool use_cache=true, float crease_angle=180.f,
+                 NormalWeighting weighting=NormalWeighting::Area);
+
+    /**
+    * @brief .objt@COp`bVVFCv𐶐֐
+    * @return std::shared_ptr<TriangleMesh> :Op`bV(ǂݍ߂Ȃnullptr)
+    * @note ̓t@C珉RXgN^ƓDǂݍ݂ɎsĂvOIȂ
+    */
+    static std::shared_ptr<TriangleMesh> create(const std::string& filename, std::shared_ptr<Material> m,
+                                                bool is_smooth=true, int max_leaf_size=4, bool use_cache=true,
+                                                float crease_angle=180.f,
+                                                NormalWeighting weighting=NormalWeighting::Area);
+
+    bool intersect_hit(const Ray& r, float t_min, float t_max, HitRecord& hit) const override;
 
-    bool intersect(const Ray& r, float t_min, float t_max, intersection& p) const override;
+    void get_intersection(const Ray& r, const HitRecord& hit, intersection& p) const override;
+
+    bool occluded(const Ray& r, float t_min, float t_max) const override;
 
     float area() const override;
 
-    intersection sample(const intersection& ref) const override;
+    AABB get_bounds() const override;
+
+    DirectionCone get_normal_cone() const override;
+
+    intersection sample(const intersection& ref, const Vec2& u) const override;
+
+    /**
+    * @brief Op`BVH̍\zv擾֐
+    * @return BVHStats :\zv
+    */
+    const BVHStats& get_bvh_stats() const { return bvh.get_stats(); }
+
+    int get_num_triangles() const { return (int)indices.size() / 3; }
+
+    /**
+    * @brief iԖڂ̎Op`PƂ̎Op`VFCvƂĎ擾֐
+    * @param[in] i     :Op`̔ԍ
+    * @return Triangle :Op`VFCv
+    */
+    Triangle get_triangle(int i) const;
+
+    /**
+    * @brief iԖڂ̎Op`̕ϊ̖ʐςvZ֐
+    * @param[in] i  :Op`̔ԍ
+    * @param[in] t  :̍Wn烏[hWnւ̕ϊ
+    * @return float :ϊ̎Op`̖ʐ
+    */
+    float get_triangle_area(int i, const Transform& t) const;
+
+    /**
+    * @brief iԖڂ̎Op`̓_lɃTvO֐
+    * @param[in] i         :Op`̔ԍ
+    * @param[in] u         :[0, 1)^2̈lȃTv
+    * @return intersection :Tv_̍WƖ@
+    */
+    intersection sample_triangle_at(int i, const Vec2& u) const;
+
+    /**
+    * @brief Op`̌̎@ݒ肷֐
+    * @param[in] type :̎@
+    * @note BaldwinWeber͎Op`Ƃ12floatǉŕێ
+    */
+    void set_intersector(TriangleIntersector type);
+
+    TriangleIntersector get_intersector() const { return intersector; }
+
+    /**
+    * @brief 4؂BVHSIMDɂgݒ肷֐
+    * @param[in] is_wide :trueȂ4؂BVH\zĒTɎg
+    * @note Moller-Trumbore@ł͗t̎Op`4܂Ƃ߂SIMDŔ肷
+    */
+    void set_wide_bvh(bool is_wide);
+
+    bool is_wide_bvh() const { return !wbvh.is_empty(); }
+
+private:
+    /**
+    * @brief _ȂOp`bV(createœǂݍޑȌ)
+    * @param[in] m :}eA
+    */
+    TriangleMesh(std::shared_ptr<Material> m) : Shape(m) {}
+
+    /**
+    * @brief .objt@C̃LbV璸_E@ECfbNXBVHݒ肷֐
+    * @return bool :ǂݍ߂true
+    * @note ̓t@C珉RXgN^Ɠ
+    */
+    bool load_file(const std::string& filename, bool is_smooth, int max_leaf_size, bool use_cache,
+                   float crease_angle, NormalWeighting weighting);
+
+    /**
+    * @brief _ƒ_CfbNXݒ肵BVH\z֐
+    * @param[in] vertices      :_z
+    * @param[in] vertex_normals :_̖@z(Ȃʖ@g)
+    * @param[in] tri_indices   :Op`Ƃ3ׂ_CfbNX
+    * @param[in] max_leaf_size :BVH̗tɊi[Op`̍ő吔
+    */
+    void build(const std::vector<Vec3>& vertices, std::vector<Vec3>&& vertex_normals,
+               std::vector<uint32_t>&& tri_indices, int max_leaf_size);
+
+    /**
+    * @brief _E@ECfbNXBVH(4؂ƎOp`̑g܂)LbVt@Cɏo֐
+    * @param[in] cache_path    :LbVt@C̃pX
+    * @param[in] source_path   :.objt@C̃pX
+    * @param[in] is_smooth     :X[YVF[fBOKp
+    * @param[in] max_leaf_size :BVH̗tɊi[Op`̍ő吔
+    * @param[in] crease_angle  :ő̐܂p[deg]
+    * @param[in] weighting     :_@̏dݕt
+    * @return bool             :otrue
+    * @note ꎞt@CɏĂûŁCsWũt@CǂނƂ͂Ȃ
+    */
+    bool save_cache(const std::string& cache_path, const std::string& source_path,
+                    bool is_smooth, int max_leaf_size, float crease_angle, NormalWeighting weighting) const;
+
+    /**
+    * @brief LbVt@C}bvĒ_E@ECfbNXBVH𕜌֐
+    * @param[in] cache_path    :LbVt@C̃pX
+    * @param[in] source_path   :.objt@C̃pX
+    * @param[in] is_smooth     :X[YVF[fBOKp邩
+    * @param[in] max_leaf_size :BVH̗tɊi[Op`̍ő吔
+    * @param[in] crease_angle  :ő̐܂p[deg]
+    * @param[in] weighting     :_@̏dݕt
+    * @return bool             :LbVLŕłtrue
+    */
+    bool load_cache(const std::string& cache_path, const std::string& source_path,
+                    bool is_smooth, int max_leaf_size, float crease_angle, NormalWeighting weighting);
+
+    Vec3 get_vertex(uint32_t v) const { return Vec3(px[v], py[v], pz[v]); }
+
+    /**
+    * @brief Op`̒_擾֐
+    * @param[in]  i  :Op`̔ԍ
+    * @param[out] V0 :Op`̒_
+    * @param[out] V1 :Op`̒_
+    * @param[out] V2 :Op`̒_
+    */
+    void get_vertices(int i, Vec3& V0, Vec3& V1, Vec3& V2) const;
+
+    /**
+    * @brief Op`̒_̖@擾֐
+    * @param[in]  i  :Op`̔ԍ
+    * @param[out] N0 :_V0̖@
+    * @param[out] N1 :_V1̖@
+    * @param[out] N2 :_V2̖@
+    * @note _̖@ȂΖʖ@Ԃ
+    */
+    void get_normals(int i, Vec3& N0, Vec3& N1, Vec3& N2) const;
+
+    /**
+    * @brief BVHTčł߂Op`Ƃ̌߂֐
+    * @param[in]  r              :˃C
+    * @param[in]  t_min          :˃C̃p[^
+    * @param[in]  t_max          :˃C̃p[^
+    * @param[out] hit            :̋L^
+    * @param[in]  intersect_tri  :Op`̌֐ bool(int i, float t_min, float t_max, float& t, float& u, float& v)
+    * @return bool               :̌
+    */
+    template <typename F>
+    bool intersect_triangles(const Ray& r, float t_min, float t_max, HitRecord& hit, F intersect_tri) const;
+
+    /**
+    * @brief BVHTĂꂩ̎Op`ƌ邩肷֐
+    * @param[in] r             :˃C
+    * @param[in] t_min         :˃C̃p[^
+    * @param[in] t_max         :˃C̃p[^
+    * @param[in] occluded_tri  :Op`̎Օ֐ bool(int i)
+    * @return bool             :ՕĂtrue
+    */
+    template <typename F>
+    bool occluded_triangles(const Ray& r, float t_min, float t_max, F occluded_tri) const;
+
+    /**
+    * @brief 4؂BVHTĎOp`̑gSIMDŌ肷֐
+    * @param[in]  r     :˃C
+    * @param[in]  t_min :˃C̃p[^
+    * @param[in]  t_max :˃C̃p[^
+    * @param[out] hit   :̋L^
+    * @return bool      :̌
+    */
+    bool intersect_quads(const Ray& r, float t_min, float t_max, HitRecord& hit) const;
+
+    /**
+    * @brief 4؂BVHTĎOp`̑gSIMDŎՕ肷֐
+    * @param[in] r     :˃C
+    * @param[in] t_min :˃C̃p[^
+    * @param[in] t_max :˃C̃p[^
+    * @return bool     :ՕĂtrue
+    */
+    bool occluded_quads(const Ray& r, float t_min, float t_max) const;
+
+    std::vector<float> px, py, pz;  /**< _W(SoA)                      */
+    std::vector<Vec3> normals;      /**< _̖@(Ȃʖ@)           */
+    std::vector<uint32_t> indices;  /**< Op`Ƃ3ׂ_CfbNX */
+    float total_area = 0.f;         /**< \ʐ                             */
+    BVH bvh;                        /**< Op`BVH                        */
+    TriangleIntersector intersector = TriangleIntersector::MollerTrumbore; /**< ̎@ */
+    std::vector<float> transforms;  /**< Op`ƂBaldwin-Weberϊ(3x4s) */
+    WideBVH wbvh;                   /**< Op`4؂BVH(Ȃ񕪖؂g) */
+    std::vector<TriangleQuad> quads; /**< 4؂̗t̏ɕׂOp`̑g   */
+    std::vector<int> leaf_quads;    /**< tƂ̍ŏ̎Op`̑g̈ʒu     */
+};
+
+
+/**
+* @brief CX^XNX
+* @note vg^CṽVFCv(Op`bVƂBVHȂ)LCϊŝ݂ʂɎ
+* @note V[BVHʂ̉\ƂȂCC𕨑̍Wnɕϊăvg^Cv̉\T
+*/
+class Instance : public Shape {
+public:
+    /**
+    * @brief vg^CvƕϊCX^X
+    * @param[in] _prototype :LVFCv
+    * @param[in] _to_world  :̍Wn烏[hWnւ̕ϊ
+    * @param[in] m          :}eA(nullptrȂvg^Cṽ}eA)
+    */
+    Instance(std::shared_ptr<const Shape> _prototype, const Transform& _to_world,
+             std::shared_ptr<Material> m=nullptr);
+
+    bool intersect_hit(const Ray& r, float t_min, float t_max, HitRecord& hit) const override;
+
+    void get_intersection(const Ray& r, const HitRecord& hit, intersection& p) const override;
+
+    bool occluded(const Ray& r, float t_min, float t_max) const override;
+
+    /**
+    * @note Op`bV͕ϊ̎Op`̖ʐς̘aC̑̃VFCv͑ϊł̂ݐm
+    */
+    float area() const override;
+
+    AABB get_bounds() const override;
+
+    DirectionCone get_normal_cone() const override;
+
+    /**
+    * @note ϊłȂOp`bV͕ϊ̖ʐςɔႵĎOp`I
+    */
+    intersection sample(const intersection& ref, const Vec2& u) const override;
+
+    const Shape* get_prototype() const { return prototype.get(); }
 
 private:
-    std::vector<Triangle> Triangles; /**< Op`z     */
+    std::shared_ptr<const Shape> prototype; /**< LVFCv                 */
+    Transform to_world;                     /**< ̍Wn烏[hWnւ̕ϊ */
+    Transform to_object;                    /**< [hWn畨̍Wnւ̕ϊ */
+    AABB bounds;                            /**< [hWnł̋E{bNX   */
+    float world_area;                       /**< [hWnł̕\ʐ         */
+    AliasTable triangle_table;              /**< ϊ̖ʐςŎOp`Iԃe[u(ϊȂ) */
 };
\ No newline at end of file
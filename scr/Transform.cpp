@@ -0,0 +1,187 @@
+#include "Transform.h"
+#include <cstring>
+
+
+/**
+* @brief 3x4̃AtBϊs̋tsvZ֐
+* @param[in]  m     :ϊs
+* @param[out] m_inv :ts
+* @note 3x3]qŋtsɂāCsړ-A^-1 tƂ
+*/
+static void invert_affine(const float m[3][4], float m_inv[3][4]) {
+    double a[3][3];
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            a[i][j] = m[i][j];
+        }
+    }
+    double c[3][3]; // ]qs̓]u
+    c[0][0] = a[1][1] * a[2][2] - a[1][2] * a[2][1];
+    c[0][1] = a[0][2] * a[2][1] - a[0][1] * a[2][2];
+    c[0][2] = a[0][1] * a[1][2] - a[0][2] * a[1][1];
+    c[1][0] = a[1][2] * a[2][0] - a[1][0] * a[2][2];
+    c[1][1] = a[0][0] * a[2][2] - a[0][2] * a[2][0];
+    c[1][2] = a[0][2] * a[1][0] - a[0][0] * a[1][2];
+    c[2][0] = a[1][0] * a[2][1] - a[1][1] * a[2][0];
+    c[2][1] = a[0][1] * a[2][0] - a[0][0] * a[2][1];
+    c[2][2] = a[0][0] * a[1][1] - a[0][1] * a[1][0];
+    double det = a[0][0] * c[0][0] + a[0][1] * c[1][0] + a[0][2] * c[2][0];
+    double inv_det = 1.0 / det;
+    for (int i = 0; i < 3; i++) {
+        double t = 0.0;
+        for (int j = 0; j < 3; j++) {
+            m_inv[i][j] = (float)(c[i][j] * inv_det);
+            t -= c[i][j] * inv_det * m[j][3];
+        }
+        m_inv[i][3] = (float)t;
+    }
+}
+
+
+Transform::Transform() {
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 4; j++) {
+            m[i][j] = (i == j) ? 1.0f : 0.f;
+            m_inv[i][j] = m[i][j];
+        }
+    }
+}
+
+Transform::Transform(const float _m[3][4]) {
+    std::memcpy(m, _m, sizeof(m));
+    invert_affine(m, m_inv);
+}
+
+Transform::Transform(const float _m[3][4], const float _m_inv[3][4]) {
+    std::memcpy(m, _m, sizeof(m));
+    std::memcpy(m_inv, _m_inv, sizeof(m_inv));
+}
+
+Transform Transform::translate(const Vec3& t) {
+    const float mat[3][4] = {
+        { 1.0f, 0.f, 0.f, t[0] },
+        { 0.f, 1.0f, 0.f, t[1] },
+        { 0.f, 0.f, 1.0f, t[2] }
+    };
+    const float mat_inv[3][4] = {
+        { 1.0f, 0.f, 0.f, -t[0] },
+        { 0.f, 1.0f, 0.f, -t[1] },
+        { 0.f, 0.f, 1.0f, -t[2] }
+    };
+    return Transform(mat, mat_inv);
+}
+
+Transform Transform::scale(const Vec3& s) {
+    const float mat[3][4] = {
+        { s[0], 0.f, 0.f, 0.f },
+        { 0.f, s[1], 0.f, 0.f },
+        { 0.f, 0.f, s[2], 0.f }
+    };
+    const float mat_inv[3][4] = {
+        { 1.0f / s[0], 0.f, 0.f, 0.f },
+        { 0.f, 1.0f / s[1], 0.f, 0.f },
+        { 0.f, 0.f, 1.0f / s[2], 0.f }
+    };
+    return Transform(mat, mat_inv);
+}
+
+Transform Transform::rotate(const Vec3& axis, float degree) {
+    // hQX̉](]s̋ts͓]u)
+    auto a = unit_vector(axis);
+    float s = std::sin(to_radian(degree));
+    float c = std::cos(to_radian(degree));
+    float mat[3][4] = {};
+    mat[0][0] = a[0] * a[0] + (1 - a[0] * a[0]) * c;
+    mat[0][1] = a[0] * a[1] * (1 - c) - a[2] * s;
+    mat[0][2] = a[0] * a[2] * (1 - c) + a[1] * s;
+    mat[1][0] = a[0] * a[1] * (1 - c) + a[2] * s;
+    mat[1][1] = a[1] * a[1] + (1 - a[1] * a[1]) * c;
+    mat[1][2] = a[1] * a[2] * (1 - c) - a[0] * s;
+    mat[2][0] = a[0] * a[2] * (1 - c) - a[1] * s;
+    mat[2][1] = a[1] * a[2] * (1 - c) + a[0] * s;
+    mat[2][2] = a[2] * a[2] + (1 - a[2] * a[2]) * c;
+    float mat_inv[3][4] = {};
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            mat_inv[i][j] = mat[j][i];
+        }
+    }
+    return Transform(mat, mat_inv);
+}
+
+Transform Transform::operator*(const Transform& t) const {
+    // (A1, t1) * (A2, t2) = (A1 A2, A1 t2 + t1)
+    float mat[3][4];
+    float mat_inv[3][4];
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 4; j++) {
+            mat[i][j] = (j == 3) ? m[i][3] : 0.f;
+            mat_inv[i][j] = (j == 3) ? t.m_inv[i][3] : 0.f;
+            for (int k = 0; k < 3; k++) {
+                mat[i][j] += m[i][k] * t.m[k][j];
+                mat_inv[i][j] += t.m_inv[i][k] * m_inv[k][j];
+            }
+        }
+    }
+    return Transform(mat, mat_inv);
+}
+
+Transform Transform::inverse() const {
+    return Transform(m_inv, m);
+}
+
+Vec3 Transform::apply_point(const Vec3& p) const {
+    return Vec3(m[0][0] * p[0] + m[0][1] * p[1] + m[0][2] * p[2] + m[0][3],
+                m[1][0] * p[0] + m[1][1] * p[1] + m[1][2] * p[2] + m[1][3],
+                m[2][0] * p[0] + m[2][1] * p[1] + m[2][2] * p[2] + m[2][3]);
+}
+
+Vec3 Transform::apply_vector(const Vec3& v) const {
+    return Vec3(m[0][0] * v[0] + m[0][1] * v[1] + m[0][2] * v[2],
+                m[1][0] * v[0] + m[1][1] * v[1] + m[1][2] * v[2],
+                m[2][0] * v[0] + m[2][1] * v[1] + m[2][2] * v[2]);
+}
+
+Vec3 Transform::apply_normal(const Vec3& n) const {
+    return Vec3(m_inv[0][0] * n[0] + m_inv[1][0] * n[1] + m_inv[2][0] * n[2],
+                m_inv[0][1] * n[0] + m_inv[1][1] * n[1] + m_inv[2][1] * n[2],
+                m_inv[0][2] * n[0] + m_inv[1][2] * n[1] + m_inv[2][2] * n[2]);
+}
+
+Ray Transform::apply(const Ray& r) const {
+    return Ray(apply_point(r.get_origin()), apply_vector(r.get_dir()));
+}
+
+AABB Transform::apply(const AABB& b) const {
+    if (b.is_empty()) {
+        return b;
+    }
+    AABB ret;
+    auto pmin = b.get_min();
+    auto pmax = b.get_max();
+    for (int i = 0; i < 8; i++) {
+        ret.expand(apply_point(Vec3((i & 1) ? pmax[0] : pmin[0],
+                                    (i & 2) ? pmax[1] : pmin[1],
+                                    (i & 4) ? pmax[2] : pmin[2])));
+    }
+    return ret;
+}
+
+float Transform::determinant() const {
+    return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+         - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+         + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+}
+
+bool Transform::is_similarity() const {
+    // 3x3̗xNgē
+    Vec3 c[3];
+    for (int j = 0; j < 3; j++) {
+        c[j] = Vec3(m[0][j], m[1][j], m[2][j]);
+    }
+    float s2 = c[0].length2();
+    const float tol = 1e-4f * s2;
+    return std::abs(c[1].length2() - s2) <= tol && std::abs(c[2].length2() - s2) <= tol
+        && std::abs(dot(c[0], c[1])) <= tol && std::abs(dot(c[1], c[2])) <= tol
+        && std::abs(dot(c[2], c[0])) <= tol;
+}
@@ -0,0 +1,121 @@
+/**
+* @file  Transform.h
+* @brief AtBϊ
+* @note  3x4s(]EgkEfƕsړ)Ƃ̋tsێ
+*/
+
+#pragma once
+
+#include "AABB.h"
+#include "Math.h"
+#include "Ray.h"
+
+/** AtBϊNX */
+class Transform {
+public:
+    /**
+    * @brief Pϊŏ
+    */
+    Transform();
+
+    /**
+    * @brief 3x4sŃAtBϊ
+    * @param[in] _m :ϊs(ŏI񂪕sړ)
+    * @note tsvẐœقȍs͗^Ȃ
+    */
+    Transform(const float _m[3][4]);
+
+    /**
+    * @brief sړ𐶐֐
+    * @param[in] t      :ړ
+    * @return Transform :sړ
+    */
+    static Transform translate(const Vec3& t);
+
+    /**
+    * @brief gk𐶐֐
+    * @param[in] s      :e̊g嗦
+    * @return Transform :gk
+    */
+    static Transform scale(const Vec3& s);
+
+    /**
+    * @brief Cӎ̉]𐶐֐
+    * @param[in] axis   :]
+    * @param[in] degree :]p[deg]
+    * @return Transform :]
+    */
+    static Transform rotate(const Vec3& axis, float degree);
+
+    /**
+    * @brief ϊ֐
+    * @param[in] t      :ɓKpϊ
+    * @return Transform :ťɂ̕ϊKpϊ
+    */
+    Transform operator*(const Transform& t) const;
+
+    /**
+    * @brief tϊ擾֐
+    * @return Transform :tϊ
+    */
+    Transform inverse() const;
+
+    /**
+    * @brief _ϊ֐
+    * @param[in] p :_
+    * @return Vec3 :ϊ̓_
+    */
+    Vec3 apply_point(const Vec3& p) const;
+
+    /**
+    * @brief xNgϊ֐(sړȂ)
+    * @param[in] v :xNg
+    * @return Vec3 :ϊ̕xNg(KȂ)
+    */
+    Vec3 apply_vector(const Vec3& v) const;
+
+    /**
+    * @brief @ϊ֐(ts̓]u|)
+    * @param[in] n :@
+    * @return Vec3 :ϊ̖@(KȂ)
+    */
+    Vec3 apply_normal(const Vec3& n) const;
+
+    /**
+    * @brief Cϊ֐
+    * @param[in] r :C
+    * @return Ray  :ϊ̃C
+    * @note xNg͐KȂ̂ŁCϊOŃC̃p[^t͓_w
+    */
+    Ray apply(const Ray& r) const;
+
+    /**
+    * @brief E{bNXϊ֐
+    * @param[in] b :E{bNX
+    * @return AABB :ϊ8_܂ދE{bNX
+    */
+    AABB apply(const AABB& b) const;
+
+    /**
+    * @brief ϊ̍s񎮂vZ֐
+    * @return float :3x3̍s(̐ς̊g嗦)
+    */
+    float determinant() const;
+
+    /**
+    * @brief ϊ(]E]ElȊgkƕsړ)肷֐
+    * @return bool :pxۂϊȂtrue
+    */
+    bool is_similarity() const;
+
+private:
+    /**
+    * @brief ϊsƋts񂩂珉
+    * @param[in] _m     :ϊs
+    * @param[in] _m_inv :ts
+    */
+    Transform(const float _m[3][4], const float _m_inv[3][4]);
+
+    float m[3][4];     /**< ϊs */
+    float m_inv[3][4]; /**< ts   */
+};
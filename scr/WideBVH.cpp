@@ -0,0 +1,82 @@
+#include "WideBVH.h"
+
+
+WideBVH::WideBVH(const BVH& bvh) {
+    if (bvh.is_empty()) {
+        return;
+    }
+    const auto& bnodes = bvh.get_nodes();
+    prim_indices.resize(bvh.get_stats().num_prims);
+    for (int i = 0; i < (int)prim_indices.size(); i++) {
+        prim_indices[i] = bvh.get_prim_index(i);
+    }
+    nodes.reserve(bvh.get_num_nodes() / 2 + 1);
+    // t̏ꍇ߂ĎqɎ
+    if (bnodes[0].nprims > 0) {
+        nodes.push_back(WideBVHNode());
+        int child = make_child(bvh, 0);
+        auto& node = nodes[0];
+        for (int a = 0; a < 3; a++) {
+            for (int i = 0; i < WIDE_BVH_WIDTH; i++) {
+                node.bounds[0][a][i] = i == 0 ? bnodes[0].bounds.get_min()[a] : inf;
+                node.bounds[1][a][i] = i == 0 ? bnodes[0].bounds.get_max()[a] : -inf;
+                node.child[i] = i == 0 ? child : WideBVHNode::EMPTY;
+            }
+        }
+    }
+    else {
+        collapse(bvh, 0);
+    }
+}
+
+int WideBVH::make_child(const BVH& bvh, int node_index) {
+    const auto& bnode = bvh.get_nodes()[node_index];
+    if (bnode.nprims > 0) {
+        WideBVHLeaf leaf;
+        leaf.offset = bnode.offset;
+        leaf.nprims = bnode.nprims;
+        leaves.push_back(leaf);
+        return ~((int)leaves.size() - 1);
+    }
+    return collapse(bvh, node_index);
+}
+
+int WideBVH::collapse(const BVH& bvh, int node_index) {
+    const auto& bnodes = bvh.get_nodes();
+    // \ʐςő̐߂qɒu邱ƂJԂĎq4܂ŏW߂
+    int children[WIDE_BVH_WIDTH] = { node_index + 1, bnodes[node_index].offset };
+    int num_children = 2;
+    while (num_children < WIDE_BVH_WIDTH) {
+        int best = -1;
+        float best_area = -inf;
+        for (int i = 0; i < num_children; i++) {
+            const auto& c = bnodes[children[i]];
+            if (c.nprims == 0 && c.bounds.surface_area() > best_area) {
+                best = i;
+                best_area = c.bounds.surface_area();
+            }
+        }
+        if (best < 0) break;
+        int expand = children[best];
+        children[best] = expand + 1;
+        children[num_children++] = bnodes[expand].offset;
+    }
+    int index = (int)nodes.size();
+    nodes.push_back(WideBVHNode());
+    // q[D揇ō\z(\znodesĊmۂ̂ŎQƂێȂ)
+    int child_values[WIDE_BVH_WIDTH];
+    for (int i = 0; i < WIDE_BVH_WIDTH; i++) {
+        child_values[i] = i < num_children ? make_child(bvh, children[i]) : WideBVHNode::EMPTY;
+    }
+    auto& node = nodes[index];
+    for (int i = 0; i < WIDE_BVH_WIDTH; i++) {
+        node.child[i] = child_values[i];
+        // 󂫂̎q͌Ȃ悤ɋ̋E{bNXƂ
+        AABB b = i < num_children ? bnodes[children[i]].bounds : AABB();
+        for (int a = 0; a < 3; a++) {
+            node.bounds[0][a][i] = b.get_min()[a];
+            node.bounds[1][a][i] = b.get_max()[a];
+        }
+    }
+    return index;
+}
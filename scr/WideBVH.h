@@ -0,0 +1,246 @@
+/**
+* @file  WideBVH.h
+* @brief 4؂̋E{[Kw(QBVH)
+* @note  񕪖؂BVHݍō\zC4̎q̋E{bNXSIMD(SSE)œɔ肷
+* @note  Ql: [Wald et al. 2008] "Getting Rid of Packets: Efficient SIMD Single-Ray Traversal using Multi-branching BVHs"
+*/
+
+#pragma once
+
+#include <immintrin.h>
+#include "BVH.h"
+
+// m[h̎q̐(SSẼ[)
+constexpr int WIDE_BVH_WIDTH = 4;
+
+/** 4؂BVH̃m[h(q̋E{bNXSoAŊi[) */
+struct alignas(16) WideBVHNode {
+    float bounds[2][3][WIDE_BVH_WIDTH]; /**< q̋E{bNX[ŏ/ő][][q]                */
+    int child[WIDE_BVH_WIDTH];          /**< q: 0ȏȂ߂̈ʒuCȂ~ẗʒu(󂫂EMPTY) */
+
+    static constexpr int EMPTY = -0x7fffffff - 1; /**< 󂫂̎q */
+};
+
+
+/** 4؂BVH̗t */
+struct WideBVHLeaf {
+    int offset=0; /**< ŏ̃v~eBüʒu */
+    int nprims=0; /**< v~eBu           */
+};
+
+
+/** 4؂̋E{[KwNX */
+class WideBVH {
+public:
+    /**
+    * @brief BVH
+    */
+    WideBVH() {};
+
+    /**
+    * @brief 񕪖؂BVHݍ4؂BVH\z
+    * @param[in] bvh :񕪖؂BVH
+    * @note \ʐςő̐߂̎qWJ邱Ƃq4ɂȂ܂ŌJԂ
+    */
+    WideBVH(const BVH& bvh);
+
+    /**
+    * @brief \zς݂̃m[hzƗt̔z񂩂4؂BVH𕜌
+    * @param[in] _nodes        :m[hz
+    * @param[in] _leaves       :t̔z
+    * @param[in] _prim_indices :t̏ɕׂv~eBuԍ
+    * @note LbVt@CǂݍޏꍇɎgCe͌؂Ȃ
+    */
+    WideBVH(std::vector<WideBVHNode>&& _nodes, std::vector<WideBVHLeaf>&& _leaves,
+            std::vector<int>&& _prim_indices)
+        : nodes(std::move(_nodes)), leaves(std::move(_leaves)), prim_indices(std::move(_prim_indices)) {};
+
+    bool is_empty() const { return nodes.empty(); }
+
+    int get_num_nodes() const { return (int)nodes.size(); }
+
+    int get_num_leaves() const { return (int)leaves.size(); }
+
+    const WideBVHLeaf& get_leaf(int i) const { return leaves[i]; }
+
+    const std::vector<WideBVHNode>& get_nodes() const { return nodes; }
+
+    const std::vector<WideBVHLeaf>& get_leaves() const { return leaves; }
+
+    /**
+    * @brief t̏ɕׂiԖڂ̃v~eBuԍ擾
+    * @param[in] i :toffseẗʒu
+    * @return int  :v~eBuԍ
+    */
+    int get_prim_index(int i) const { return prim_indices[i]; }
+
+    /**
+    * @brief Cʉ߂tO珇ɗ񋓂Čs֐
+    * @param[in] r              :˃C
+    * @param[in] t_min          :˃C̃p[^
+    * @param[in] t_max          :˃C̃p[^
+    * @param[in] intersect_leaf :ť֐ bool(int leaf, float t_min, float& t_max)
+    * @return bool              :̌
+    * @note intersect_leaf͌ꍇt_max_̃p[^ɍXVtrueԂ
+    */
+    template <typename F>
+    bool intersect(const Ray& r, float t_min, float t_max, F intersect_leaf) const;
+
+    /**
+    * @brief Cԓłꂩ̃v~eBuƌ邩肷֐
+    * @param[in] r             :˃C
+    * @param[in] t_min         :˃C̃p[^
+    * @param[in] t_max         :˃C̃p[^
+    * @param[in] occluded_leaf :t̎Օ֐ bool(int leaf)
+    * @return bool             :ՕĂtrue
+    */
+    template <typename F>
+    bool occluded(const Ray& r, float t_min, float t_max, F occluded_leaf) const;
+
+private:
+    /**
+    * @brief 񕪖؂̕؂ċAIɏݍފ֐
+    * @param[in] bvh        :񕪖؂BVH
+    * @param[in] node_index :񕪖؂̐߂̈ʒu
+    * @return int           :\zm[ḧʒu
+    */
+    int collapse(const BVH& bvh, int node_index);
+
+    /**
+    * @brief 񕪖؂̃m[hqƂĎQƂlɕϊ֐
+    * @param[in] bvh        :񕪖؂BVH
+    * @param[in] node_index :񕪖؂̃m[ḧʒu
+    * @return int           :q̒l(߂Ȃݍ񂾃m[ḧʒuCtȂ~ẗʒu)
+    */
+    int make_child(const BVH& bvh, int node_index);
+
+    /**
+    * @brief Cƃm[h4̎q̋E{bNX̌s֐
+    * @param[in]  node   :m[h
+    * @param[in]  o      :Č_(evf4[ɕ)
+    * @param[in]  inv    :C̕xNg̋t(evf4[ɕ)
+    * @param[in]  is_neg :C̕xNg̊evf
+    * @param[in]  t_min  :C̃p[^
+    * @param[in]  t_max  :C̃p[^
+    * @param[out] t_near :qƂ̌Ԃ̉
+    * @return int        :q̃rbg}XN
+    * @note AABB::is_intersectƓKŔ肷(NaNł͋ԂXVȂ)
+    */
+    static int intersect_children(const WideBVHNode& node, const __m128 o[3], const __m128 inv[3],
+        const int is_neg[3], float t_min, float t_max, float t_near[WIDE_BVH_WIDTH]);
+
+    std::vector<WideBVHNode> nodes;    /**< m[hz                      */
+    std::vector<WideBVHLeaf> leaves;   /**< t̔z                        */
+    std::vector<int> prim_indices;     /**< t̏ɕׂv~eBuԍ */
+};
+
+
+inline int WideBVH::intersect_children(const WideBVHNode& node, const __m128 o[3], const __m128 inv[3],
+    const int is_neg[3], float t_min, float t_max, float t_near[WIDE_BVH_WIDTH]) {
+    const __m128 scale = _mm_set1_ps(1.0f + 4 * epsilon); // ۂߌ덷ɂ肱ڂh
+    __m128 t0 = _mm_set1_ps(t_min);
+    __m128 t1 = _mm_set1_ps(t_max);
+    for (int a = 0; a < 3; a++) {
+        // C̕ȂőWOɂȂ
+        __m128 tn = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.bounds[is_neg[a]][a]), o[a]), inv[a]);
+        __m128 tf = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.bounds[1 - is_neg[a]][a]), o[a]), inv[a]);
+        tf = _mm_mul_ps(tf, scale);
+        // max/minNaN̏ꍇ2Ԗڂ̈Ԃ̂ŋԂ͍XVȂ
+        t0 = _mm_max_ps(tn, t0);
+        t1 = _mm_min_ps(tf, t1);
+    }
+    _mm_storeu_ps(t_near, t0);
+    return _mm_movemask_ps(_mm_cmple_ps(t0, t1));
+}
+
+
+template <typename F>
+bool WideBVH::intersect(const Ray& r, float t_min, float t_max, F intersect_leaf) const {
+    if (nodes.empty()) {
+        return false;
+    }
+    const auto ro = r.get_origin();
+    const auto d = r.get_dir();
+    const __m128 o[3] = { _mm_set1_ps(ro[0]), _mm_set1_ps(ro[1]), _mm_set1_ps(ro[2]) };
+    const __m128 inv[3] = { _mm_set1_ps(1.0f / d[0]), _mm_set1_ps(1.0f / d[1]), _mm_set1_ps(1.0f / d[2]) };
+    const int is_neg[3] = { 1.0f / d[0] < 0, 1.0f / d[1] < 0, 1.0f / d[2] < 0 };
+    bool is_isect = false;
+    // K\̎qƌԂ̉
+    int stack[4 * 64];
+    float stack_t[4 * 64];
+    int stack_size = 0;
+    stack[stack_size] = 0;
+    stack_t[stack_size++] = t_min;
+    while (stack_size > 0) {
+        stack_size--;
+        int current = stack[stack_size];
+        // Ɍ_艜Ȃǂݔ΂
+        if (stack_t[stack_size] > t_max) {
+            continue;
+        }
+        // tȂv~eBuƌ
+        if (current < 0) {
+            if (intersect_leaf(~current, t_min, t_max)) {
+                is_isect = true;
+            }
+            continue;
+        }
+        // ߂Ȃq珇ɐςŎOK
+        const auto& node = nodes[current];
+        float t_near[WIDE_BVH_WIDTH];
+        int mask = intersect_children(node, o, inv, is_neg, t_min, t_max, t_near);
+        int order[WIDE_BVH_WIDTH];
+        int num_hit = 0;
+        for (int i = 0; i < WIDE_BVH_WIDTH; i++) {
+            if (!(mask & (1 << i))) continue;
+            // ̍~ɑ}
+            int j = num_hit++;
+            while (j > 0 && t_near[order[j - 1]] < t_near[i]) {
+                order[j] = order[j - 1];
+                j--;
+            }
+            order[j] = i;
+        }
+        for (int k = 0; k < num_hit; k++) {
+            stack[stack_size] = node.child[order[k]];
+            stack_t[stack_size++] = t_near[order[k]];
+        }
+    }
+    return is_isect;
+}
+
+
+template <typename F>
+bool WideBVH::occluded(const Ray& r, float t_min, float t_max, F occluded_leaf) const {
+    if (nodes.empty()) {
+        return false;
+    }
+    const auto ro = r.get_origin();
+    const auto d = r.get_dir();
+    const __m128 o[3] = { _mm_set1_ps(ro[0]), _mm_set1_ps(ro[1]), _mm_set1_ps(ro[2]) };
+    const __m128 inv[3] = { _mm_set1_ps(1.0f / d[0]), _mm_set1_ps(1.0f / d[1]), _mm_set1_ps(1.0f / d[2]) };
+    const int is_neg[3] = { 1.0f / d[0] < 0, 1.0f / d[1] < 0, 1.0f / d[2] < 0 };
+    int stack[4 * 64]; // K\̎q
+    int stack_size = 0;
+    stack[stack_size++] = 0;
+    while (stack_size > 0) {
+        int current = stack[--stack_size];
+        // tȂv~eBuƎՕ
+        if (current < 0) {
+            if (occluded_leaf(~current)) {
+                return true;
+            }
+            continue;
+        }
+        // ŏɌőł؂̂Ŏq̖K⏇͍lȂ
+        const auto& node = nodes[current];
+        float t_near[WIDE_BVH_WIDTH];
+        int mask = intersect_children(node, o, inv, is_neg, t_min, t_max, t_near);
+        for (int i = 0; i < WIDE_BVH_WIDTH; i++) {
+            if (mask & (1 << i)) {
+                stack[stack_size++] = node.child[i];
+            }
+        }
+    }
+    return false;
+}
@@ -21,23 +21,128 @@
 #include "Scene.h"
 #include "Camera.h"
 #include "MakeScene.h"
+#include "Benchmark.h"
+#include "Film.h"
+#include "SceneLoader.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+* @brief go͂֐
+*/
+static void print_usage() {
+    std::cerr <<
+        "usage: testpt [scene file] [options]\n"
+        "       testpt --merge <output> <partial images...>\n"
+        "options:\n"
+        "  --spp <n>                     samples per pixel\n"
+        "  --strategy <name>             uniform | bsdf | light | mis\n"
+        "  --sampler <name>              independent | stratified | halton | sobol\n"
+        "  --threads <n>                 number of threads (0: all hardware threads)\n"
+        "  --output <file>               output image (.png, .exr, .pfm, .hdr)\n"
+        "  --node <index> <count>        render every count-th tile and write a partial image\n"
+        "  --progressive <spp> <seconds> render in passes with a time budget and checkpoints\n";
+}
 
 /**
 * @brief main֐
+* @note testpt <V[Lqt@C> [IvV] ŃV[ǂݍŃ_O(ȗmake_scene_simple)
+* @note testpt --merge <o͉摜> <摜>... ŕU_O̕摜
 */
 int main(int argc, char** argv) {
-    Renderer renderer(128, Sampling::MIS);
+    std::vector<std::string> args(argv + 1, argv + argc);
+    if (args.size() >= 2 && args[0] == "--merge") {
+        auto film = merge_partial_films(std::vector<std::string>(args.begin() + 2, args.end()), args[1]);
+        if (!film || !film->write()) {
+            std::cerr << "Failed to merge partial images into " << args[1] << '\n';
+            return 1;
+        }
+        return 0;
+    }
+    //benchmark_triangle_intersection(); // Op`̌̌v
+    //benchmark_piecewise_sampling(); // }bv̋Pxz̃TvǑv
+    //benchmark_environment_mapping(); // }bv̍Wϊ̌v
     // V[
     Scene world;
     Camera cam;
-    make_scene_simple(world, cam);
-    //make_scene_simple2(world, cam);
-    //make_scene_simple3(world, cam);
-    //make_scene_MIS(world, cam);
-    //make_scene_cornell_box(world, cam);
-    //make_scene_box_with_sphere(world, cam);
-    //make_scene_vase(world, cam);
-    //make_scene_thinfilm(world, cam);
+    RenderSettings settings;
+    std::string scene_path; // V[Lqt@C(Ȃgݍ݂̃V[)
+    size_t arg_index = 0;
+    if (!args.empty() && args[0].rfind("--", 0) != 0) {
+        scene_path = args[0];
+        if (!load_scene(scene_path, world, cam, settings)) {
+            return 1;
+        }
+        arg_index = 1;
+    }
+    else {
+        make_scene_simple(world, cam);
+        //make_scene_simple2(world, cam);
+        //make_scene_simple3(world, cam);
+        //make_scene_MIS(world, cam);
+        //make_scene_cornell_box(world, cam);
+        //make_scene_box_with_sphere(world, cam);
+        //make_scene_vase(world, cam);
+        //make_scene_thinfilm(world, cam);
+    }
+
+    // R}hCŃV[Lqt@C̐ݒ㏑
+    int node_index = 0, num_nodes = 1;
+    int pass_spp = 0;
+    float time_budget = 0.f;
+    for (; arg_index < args.size(); arg_index++) {
+        const auto& opt = args[arg_index];
+        const size_t num_values = (opt == "--node" || opt == "--progressive") ? 2 : 1;
+        if (arg_index + num_values >= args.size()) {
+            std::cerr << "missing value for " << opt << '\n';
+            print_usage();
+            return 1;
+        }
+        const auto& value = args[arg_index + 1];
+        bool is_valid = true;
+        if (opt == "--spp") settings.spp = std::atoi(value.c_str());
+        else if (opt == "--strategy") is_valid = parse_sampling(value, settings.strategy);
+        else if (opt == "--sampler") is_valid = parse_sampler_type(value, settings.sampler);
+        else if (opt == "--threads") settings.num_threads = std::atoi(value.c_str());
+        else if (opt == "--output") cam.get_film()->set_filename(value);
+        else if (opt == "--node") {
+            node_index = std::atoi(value.c_str());
+            num_nodes = std::atoi(args[arg_index + 2].c_str());
+        }
+        else if (opt == "--progressive") {
+            pass_spp = std::atoi(value.c_str());
+            time_budget = (float)std::atof(args[arg_index + 2].c_str());
+        }
+        else {
+            std::cerr << "unknown option " << opt << '\n';
+            print_usage();
+            return 1;
+        }
+        if (!is_valid) {
+            std::cerr << "invalid value for " << opt << ": " << value << '\n';
+            print_usage();
+            return 1;
+        }
+        arg_index += num_values;
+    }
+    if (pass_spp > 0 && num_nodes > 1) {
+        // S摜͓rĊJłȂ̂ŕpȂ
+        std::cerr << "--progressive cannot be combined with --node\n";
+        print_usage();
+        return 1;
+    }
+
+    Renderer renderer(settings.spp, settings.strategy, settings.num_threads, settings.sampler);
+    if (settings.error_threshold > 0) {
+        renderer.set_adaptive_sampling(settings.error_threshold, settings.max_spp);
+    }
+    renderer.set_wavefront(settings.is_wavefront);
+    renderer.set_distributed(node_index, num_nodes);
+    renderer.set_progressive(pass_spp, time_budget, scene_path); // fĂ<o͉摜>.ckptĊJ
+    world.build(); // \̍\z
     renderer.render(world, cam);
     return 0;
-}
\ No newline at end of file
+}
@@ -48,6 +48,11 @@ Vec3 exclude_invalid(const Vec3& color) {
 }
 
 
+float luminance(const Vec3& color) {
+    return 0.2126f * color.get_x() + 0.7152f * color.get_y() + 0.0722f * color.get_z();
+}
+
+
 std::vector<std::string> split_string(const std::string& line, char delimiter) {
     std::stringstream ss(line);
     std::string temp;
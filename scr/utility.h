@@ -31,6 +31,9 @@ constexpr float invpi = 1.0f / pi;
 // }VCvV
 constexpr float epsilon = std::numeric_limits<float>::epsilon();
 
+// 1ōőfloat([0, 1)̈lTv̏)
+constexpr float one_minus_epsilon = 0x1.fffffep-1f;
+
 // p}VCvV(ȌȂ悤ɌoIɌ)
 constexpr float eps_isect = 0.01f;
 
@@ -77,6 +80,14 @@ Vec3 inv_gamma_correction(const Vec3& color);
 Vec3 exclude_invalid(const Vec3& color);
 
 
+/**
+* @brief F̋Px(Y)vZ֐
+* @param[in]  color :`RGB̐F
+* @return float     :Px
+*/
+float luminance(const Vec3& color);
+
+
 /**
 * @brief w肵ŕ֐
 * @param[in]  line      :镶